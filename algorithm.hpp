@@ -1,46 +1,961 @@
 #ifndef SJTU_ALGORITHM_HPP
 #define SJTU_ALGORITHM_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef SJTU_PARALLEL
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
 
 namespace sjtu{
 
-template<typename T>
-void sort(T *begin, T *end, std::function<bool(const T&, const T&)> cmp){
-    int len = end - begin;
-    if (len <= 1) return ;
-    T *i = begin, *j = end - 1;
-    T pivot = *(begin + (len + 1) / 2 - 1);
-    while (j - i >= 0){
-        while (cmp(*i, pivot)) i++;
-        while (cmp(pivot, *j)) j--;
-        if (j - i >= 0){
-            std::swap(*i, *j);
-            i++, j--;
+/**
+ * the ordering sort uses when none is given
+ */
+struct less {
+    template<typename T>
+    bool operator()(const T &a, const T &b) const { return a < b; }
+};
+
+/**
+ * the engine behind sjtu::sort, a pattern-defeating quicksort:
+ * ninther / median-of-three pivots, insertion sort below a cutoff,
+ * heapsort once too many partitions come out unbalanced,
+ * and block-wise branchless partitioning for arithmetic types under the default ordering.
+ */
+namespace sort_detail {
+
+const std::ptrdiff_t insertion_threshold = 24;
+const std::ptrdiff_t ninther_threshold = 128;
+// partial_insertion_sort gives up once it has moved this many elements
+const std::ptrdiff_t partial_insertion_limit = 8;
+// offsets of one block fit in an unsigned char
+const std::ptrdiff_t block_size = 64;
+
+template<typename Iter, typename Compare>
+void insertion_sort(Iter begin, Iter end, Compare &cmp) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    if (begin == end) return;
+    for (Iter cur = begin + 1; cur != end; ++cur) {
+        Iter sift = cur, sift_1 = cur - 1;
+        if (cmp(*sift, *sift_1)) {
+            T tmp = std::move(*sift);
+            do { *sift-- = std::move(*sift_1); } while (sift != begin && cmp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+/**
+ * *(begin - 1) must not be greater than any element of [begin, end), so the scan needs no bound check
+ */
+template<typename Iter, typename Compare>
+void unguarded_insertion_sort(Iter begin, Iter end, Compare &cmp) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    if (begin == end) return;
+    for (Iter cur = begin + 1; cur != end; ++cur) {
+        Iter sift = cur, sift_1 = cur - 1;
+        if (cmp(*sift, *sift_1)) {
+            T tmp = std::move(*sift);
+            do { *sift-- = std::move(*sift_1); } while (cmp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+/**
+ * insertion sort that stops early on input far from sorted; returns whether it finished
+ */
+template<typename Iter, typename Compare>
+bool partial_insertion_sort(Iter begin, Iter end, Compare &cmp) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    if (begin == end) return true;
+    std::ptrdiff_t moved = 0;
+    for (Iter cur = begin + 1; cur != end; ++cur) {
+        Iter sift = cur, sift_1 = cur - 1;
+        if (cmp(*sift, *sift_1)) {
+            T tmp = std::move(*sift);
+            do { *sift-- = std::move(*sift_1); } while (sift != begin && cmp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+            moved += cur - sift;
+            if (moved > partial_insertion_limit) return false;
+        }
+    }
+    return true;
+}
+
+template<typename Iter, typename Compare>
+void sort2(Iter a, Iter b, Compare &cmp) {
+    if (cmp(*b, *a)) std::iter_swap(a, b);
+}
+
+template<typename Iter, typename Compare>
+void sort3(Iter a, Iter b, Iter c, Compare &cmp) {
+    sort2(a, b, cmp);
+    sort2(b, c, cmp);
+    sort2(a, b, cmp);
+}
+
+template<typename Iter, typename Compare>
+void sift_down(Iter first, std::ptrdiff_t len, std::ptrdiff_t hole,
+               typename std::iterator_traits<Iter>::value_type value, Compare &cmp) {
+    for (std::ptrdiff_t child; (child = 2 * hole + 1) < len; hole = child) {
+        if (child + 1 < len && cmp(first[child], first[child + 1])) ++child;
+        if (!cmp(value, first[child])) break;
+        first[hole] = std::move(first[child]);
+    }
+    first[hole] = std::move(value);
+}
+
+template<typename Iter, typename Compare>
+void heap_sort(Iter first, Iter last, Compare &cmp) {
+    std::ptrdiff_t len = last - first;
+    for (std::ptrdiff_t i = len / 2; i-- > 0; )
+        sift_down(first, len, i, std::move(first[i]), cmp);
+    for (std::ptrdiff_t n = len - 1; n > 0; --n) {
+        typename std::iterator_traits<Iter>::value_type value = std::move(first[n]);
+        first[n] = std::move(first[0]);
+        sift_down(first, n, 0, std::move(value), cmp);
+    }
+}
+
+/**
+ * partition [begin, end) around the pivot *begin: smaller elements to its left, the rest to its right.
+ * the pivot was picked as a median, so an element not less than it sits at end - 1 and the left scan needs no bound.
+ * returns the final position of the pivot and whether the range was already partitioned.
+ */
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> partition_right(Iter begin, Iter end, Compare &cmp) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    T pivot(std::move(*begin));
+    Iter first = begin, last = end;
+    while (cmp(*++first, pivot));
+    if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+    else while (!cmp(*--last, pivot));
+    bool already_partitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (cmp(*++first, pivot));
+        while (!cmp(*--last, pivot));
+    }
+    Iter pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return std::make_pair(pivot_pos, already_partitioned);
+}
+
+/**
+ * swap the misplaced elements found by one round of the block partition;
+ * with unequal counts a cyclic permutation does it in one move per element instead of three
+ */
+template<typename Iter>
+void swap_offsets(Iter first, Iter last, const unsigned char *offsets_l, const unsigned char *offsets_r,
+                  std::ptrdiff_t num, bool use_swaps) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    if (use_swaps) {
+        for (std::ptrdiff_t i = 0; i < num; ++i)
+            std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    } else if (num > 0) {
+        Iter l = first + offsets_l[0], r = last - offsets_r[0];
+        T tmp(std::move(*l));
+        *l = std::move(*r);
+        for (std::ptrdiff_t i = 1; i < num; ++i) {
+            l = first + offsets_l[i];
+            *r = std::move(*l);
+            r = last - offsets_r[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
+    }
+}
+
+/**
+ * partition_right without a data-dependent branch per element (BlockQuicksort):
+ * each block records the offsets of its misplaced elements with an unconditional store
+ * and a counter bumped by the comparison result, then the recorded elements are swapped in bulk.
+ */
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> partition_right_branchless(Iter begin, Iter end, Compare &cmp) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    T pivot(std::move(*begin));
+    Iter first = begin, last = end;
+    while (cmp(*++first, pivot));
+    if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+    else while (!cmp(*--last, pivot));
+    bool already_partitioned = first >= last;
+    if (!already_partitioned) {
+        std::iter_swap(first, last);
+        ++first;
+        alignas(64) unsigned char offsets_l[block_size], offsets_r[block_size];
+        Iter offsets_l_base = first, offsets_r_base = last;
+        std::ptrdiff_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+        while (first < last) {
+            // only fill the side whose offsets ran out; split the unknown part when both did
+            std::ptrdiff_t num_unknown = last - first;
+            std::ptrdiff_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+            std::ptrdiff_t right_split = num_r == 0 ? num_unknown - left_split : 0;
+            if (left_split > block_size) left_split = block_size;
+            if (right_split > block_size) right_split = block_size;
+            for (std::ptrdiff_t i = 0; i < left_split; ++i, ++first) {
+                offsets_l[num_l] = (unsigned char)i;
+                num_l += !cmp(*first, pivot);
+            }
+            for (std::ptrdiff_t i = 0; i < right_split; ) {
+                offsets_r[num_r] = (unsigned char)++i;
+                num_r += cmp(*--last, pivot);
+            }
+            std::ptrdiff_t num = num_l < num_r ? num_l : num_r;
+            swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+            num_l -= num, num_r -= num;
+            start_l += num, start_r += num;
+            if (num_l == 0) start_l = 0, offsets_l_base = first;
+            if (num_r == 0) start_r = 0, offsets_r_base = last;
+        }
+        // one side may still hold misplaced elements; move them next to the boundary
+        if (num_l) {
+            while (num_l--) std::iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+            first = last;
+        }
+        if (num_r) {
+            while (num_r--) std::iter_swap(offsets_r_base - offsets_r[start_r + num_r], first), ++first;
+            last = first;
+        }
+    }
+    Iter pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return std::make_pair(pivot_pos, already_partitioned);
+}
+
+/**
+ * the mirror of partition_right that keeps elements equal to the pivot on its left.
+ * used when the pivot equals the element just before the range, i.e. the previous pivot:
+ * nothing in the range is smaller, so the equal run is finished in one pass and never recursed into.
+ */
+template<typename Iter, typename Compare>
+Iter partition_left(Iter begin, Iter end, Compare &cmp) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    T pivot(std::move(*begin));
+    Iter first = begin, last = end;
+    while (cmp(pivot, *--last));
+    if (last + 1 == end) while (first < last && !cmp(pivot, *++first));
+    else while (!cmp(pivot, *++first));
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (cmp(pivot, *--last));
+        while (!cmp(pivot, *++first));
+    }
+    Iter pivot_pos = last;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return pivot_pos;
+}
+
+/**
+ * sort [begin, end); leftmost tells whether an element no greater than the range lies before it.
+ * the smaller side of every partition is recursed into and the larger one looped on,
+ * so the stack depth stays O(log n); bad_allowed unbalanced partitions are tolerated before heapsort.
+ */
+template<bool Branchless, typename Iter, typename Compare>
+void pdq_loop(Iter begin, Iter end, Compare &cmp, int bad_allowed, bool leftmost) {
+    while (true) {
+        std::ptrdiff_t size = end - begin;
+        if (size < insertion_threshold) {
+            if (leftmost) insertion_sort(begin, end, cmp);
+            else unguarded_insertion_sort(begin, end, cmp);
+            return;
+        }
+
+        std::ptrdiff_t s2 = size / 2;
+        if (size > ninther_threshold) {
+            sort3(begin, begin + s2, end - 1, cmp);
+            sort3(begin + 1, begin + (s2 - 1), end - 2, cmp);
+            sort3(begin + 2, begin + (s2 + 1), end - 3, cmp);
+            sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), cmp);
+            std::iter_swap(begin, begin + s2);
+        } else {
+            sort3(begin + s2, begin, end - 1, cmp);
+        }
+
+        if (!leftmost && !cmp(*(begin - 1), *begin)) {
+            begin = partition_left(begin, end, cmp) + 1;
+            continue;
+        }
+
+        std::pair<Iter, bool> part = Branchless ? partition_right_branchless(begin, end, cmp)
+                                                : partition_right(begin, end, cmp);
+        Iter pivot_pos = part.first;
+        std::ptrdiff_t l_size = pivot_pos - begin, r_size = end - (pivot_pos + 1);
+
+        if (l_size < size / 8 || r_size < size / 8) {
+            if (--bad_allowed == 0) {
+                heap_sort(begin, end, cmp);
+                return;
+            }
+            // break up the pattern that produced the bad pivot
+            if (l_size >= insertion_threshold) {
+                std::iter_swap(begin, begin + l_size / 4);
+                std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+                if (l_size > ninther_threshold) {
+                    std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+                    std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                    std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+                }
+            }
+            if (r_size >= insertion_threshold) {
+                std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+                std::iter_swap(end - 1, end - r_size / 4);
+                if (r_size > ninther_threshold) {
+                    std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                    std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                    std::iter_swap(end - 2, end - (1 + r_size / 4));
+                    std::iter_swap(end - 3, end - (2 + r_size / 4));
+                }
+            }
+        } else if (part.second && partial_insertion_sort(begin, pivot_pos, cmp)
+                   && partial_insertion_sort(pivot_pos + 1, end, cmp)) {
+            // a balanced partition that moved nothing: the input is probably sorted already
+            return;
+        }
+
+        if (l_size < r_size) {
+            pdq_loop<Branchless>(begin, pivot_pos, cmp, bad_allowed, leftmost);
+            begin = pivot_pos + 1;
+            leftmost = false;
+        } else {
+            pdq_loop<Branchless>(pivot_pos + 1, end, cmp, bad_allowed, false);
+            end = pivot_pos;
         }
     }
-    if (j - begin > 0) sort(begin, i, cmp);
-    if (end - i > 1) sort(i, end, cmp);
 }
 
-template<class T>
-T *upper_bound(const T *begin, const T *end, const T &num){
-    int l = -1, r = end - begin;
-    while (l + 1 < r){
-        int mid = (l + r) >> 1;
-        if (num < *(begin + mid)) r = mid; else l = mid;
+template<typename T, typename Compare>
+struct is_default_compare : std::integral_constant<bool,
+    std::is_same<Compare, sjtu::less>::value || std::is_same<Compare, std::less<T>>::value
+    || std::is_same<Compare, std::greater<T>>::value || std::is_same<Compare, std::less<>>::value
+    || std::is_same<Compare, std::greater<>>::value> {};
+
+inline int log2(std::ptrdiff_t n) {
+    int log = 0;
+    while (n >>= 1) ++log;
+    return log;
+}
+
+}
+
+/**
+ * sort [begin, end) of any random-access iterator, O(n log n) in the worst case and not stable.
+ * the comparator is a template parameter so that calls to it can be inlined,
+ * any callable with bool cmp(const T&, const T&) works, std::function included.
+ */
+template<typename Iter, typename Compare>
+void sort(Iter begin, Iter end, Compare cmp){
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    if (end - begin < 2) return;
+    const bool branchless = std::is_arithmetic<T>::value && sort_detail::is_default_compare<T, Compare>::value;
+    sort_detail::pdq_loop<branchless>(begin, end, cmp, sort_detail::log2(end - begin), true);
+}
+
+template<typename Iter>
+void sort(Iter begin, Iter end){
+    sjtu::sort(begin, end, less());
+}
+
+/**
+ * SJTU_PREFETCH(addr) hints that addr will be read soon; it never faults, whatever addr is
+ */
+#if defined(__GNUC__)
+#define SJTU_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define SJTU_PREFETCH(addr) ((void)0)
+#endif
+
+namespace search_detail {
+
+inline size_t floor_log2(size_t n) {
+#if defined(__GNUC__)
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(n);
+#else
+    size_t log = 0;
+    while (n >>= 1) ++log;
+    return log;
+#endif
+}
+
+inline size_t trailing_ones(size_t n) {
+#if defined(__GNUC__)
+    return ~n ? __builtin_ctzll(~n) : sizeof(size_t) * 8;
+#else
+    size_t ones = 0;
+    for (; n & 1; n >>= 1) ++ones;
+    return ones;
+#endif
+}
+
+/**
+ * prefetch the element at it, when an iterator of this kind has an address to prefetch
+ */
+template<typename Iter>
+inline void prefetch(Iter it) {
+    if constexpr (std::is_lvalue_reference<typename std::iterator_traits<Iter>::reference>::value)
+        SJTU_PREFETCH(std::addressof(*it));
+}
+
+/**
+ * one step of a branchless binary search over [base, base + n]: the probe picks the half
+ * with a conditional move instead of a jump, and the midpoints of both halves are
+ * fetched ahead because the next probe is one of them.
+ * Goes right while go_right(*probe) holds; every search of the same length takes the same steps.
+ */
+template<typename Iter, typename GoRight>
+inline Iter bisect(Iter base, std::ptrdiff_t n, GoRight go_right) {
+    while (n > 1) {
+        std::ptrdiff_t half = n / 2;
+        prefetch(base + half / 2);
+        prefetch(base + (half + half / 2));
+        base = go_right(base[half]) ? base + half : base;
+        n -= half;
     }
-    return const_cast<T *>(begin + r);
+    return base + go_right(*base);
 }
 
-template<class T>
-T *lower_bound(const T *begin, const T *end, const T &num){
-    int l = -1, r = end - begin;
-    while (l + 1 < r){
-        int mid = (l + r) >> 1;
-        if (num <= *(begin + mid)) r = mid; else l = mid;
+// searches one batch runs side by side, so their cache misses overlap
+const std::ptrdiff_t batch_size = 16;
+
+template<typename Iter, typename KeyIt, typename OutputIt, typename Select>
+OutputIt bisect_all(Iter first, Iter last, KeyIt keys_first, KeyIt keys_last, OutputIt out, Select select) {
+    std::ptrdiff_t len = last - first;
+    while (keys_first != keys_last) {
+        KeyIt keys[batch_size];
+        Iter base[batch_size];
+        std::ptrdiff_t count = 0;
+        for (; count < batch_size && keys_first != keys_last; ++count, ++keys_first) {
+            keys[count] = keys_first;
+            base[count] = first;
+        }
+        if (len == 0) {
+            for (std::ptrdiff_t i = 0; i < count; ++i) *out++ = first;
+            continue;
+        }
+        for (std::ptrdiff_t n = len; n > 1; ) {
+            std::ptrdiff_t half = n / 2;
+            for (std::ptrdiff_t i = 0; i < count; ++i) {
+                prefetch(base[i] + half / 2);
+                prefetch(base[i] + (half + half / 2));
+            }
+            for (std::ptrdiff_t i = 0; i < count; ++i)
+                base[i] = select(base[i][half], *keys[i]) ? base[i] + half : base[i];
+            n -= half;
+        }
+        for (std::ptrdiff_t i = 0; i < count; ++i) *out++ = base[i] + select(*base[i], *keys[i]);
     }
-    return const_cast<T *>(begin + r);
+    return out;
+}
+
+}
+
+/**
+ * the first position in the sorted range [first, last) whose element is not less than value.
+ * only cmp (operator< by default) is used, and lengths are ptrdiff_t; the search is branchless.
+ */
+template<typename Iter, typename T, typename Compare>
+Iter lower_bound(Iter first, Iter last, const T &value, Compare cmp){
+    if (first == last) return first;
+    return search_detail::bisect(first, last - first, [&](const auto &x) { return cmp(x, value); });
+}
+
+template<typename Iter, typename T>
+Iter lower_bound(Iter first, Iter last, const T &value){
+    return sjtu::lower_bound(first, last, value, less());
+}
+
+/**
+ * the first position in the sorted range [first, last) whose element is greater than value
+ */
+template<typename Iter, typename T, typename Compare>
+Iter upper_bound(Iter first, Iter last, const T &value, Compare cmp){
+    if (first == last) return first;
+    return search_detail::bisect(first, last - first, [&](const auto &x) { return !cmp(value, x); });
+}
+
+template<typename Iter, typename T>
+Iter upper_bound(Iter first, Iter last, const T &value){
+    return sjtu::upper_bound(first, last, value, less());
+}
+
+/**
+ * lower_bound of every key in [keys_first, keys_last), written to out in order.
+ * keys are searched sixteen at a time in lockstep, so the memory latency of one
+ * search hides behind the others; returns the end of the output.
+ */
+template<typename Iter, typename KeyIt, typename OutputIt, typename Compare>
+OutputIt lower_bounds(Iter first, Iter last, KeyIt keys_first, KeyIt keys_last, OutputIt out, Compare cmp){
+    return search_detail::bisect_all(first, last, keys_first, keys_last, out,
+        [&](const auto &x, const auto &key) { return cmp(x, key); });
+}
+
+template<typename Iter, typename KeyIt, typename OutputIt>
+OutputIt lower_bounds(Iter first, Iter last, KeyIt keys_first, KeyIt keys_last, OutputIt out){
+    return sjtu::lower_bounds(first, last, keys_first, keys_last, out, less());
+}
+
+template<typename Iter, typename KeyIt, typename OutputIt, typename Compare>
+OutputIt upper_bounds(Iter first, Iter last, KeyIt keys_first, KeyIt keys_last, OutputIt out, Compare cmp){
+    return search_detail::bisect_all(first, last, keys_first, keys_last, out,
+        [&](const auto &x, const auto &key) { return !cmp(key, x); });
+}
+
+template<typename Iter, typename KeyIt, typename OutputIt>
+OutputIt upper_bounds(Iter first, Iter last, KeyIt keys_first, KeyIt keys_last, OutputIt out){
+    return sjtu::upper_bounds(first, last, keys_first, keys_last, out, less());
+}
+
+/**
+ * a read-only copy of a sorted range in Eytzinger (BFS heap) order: node k has children
+ * 2k and 2k + 1, so a search walks down one path whose next four levels share a cache line
+ * that can be fetched ahead, instead of jumping across the whole array as a binary search does.
+ * lookups answer with ranks, i.e. positions in the sorted range the index was built from.
+ */
+template<typename T, typename Compare = less>
+class eytzinger_index {
+    // tree[1..n] are constructed; tree[0] is padding that puts node 16k on a cache line boundary
+    T *tree;
+    size_t n;
+    Compare cmp;
+    static constexpr size_t line = 64;
+    static constexpr size_t per_line = sizeof(T) < line ? line / sizeof(T) : 1;
+    static constexpr size_t align = alignof(T) > line ? alignof(T) : line;
+
+    /**
+     * in-order walk over the nodes: the leftmost node, and the successor of k (0 past the last)
+     */
+    size_t first_in_order() const {
+        size_t k = n ? 1 : 0;
+        while (k && 2 * k <= n) k *= 2;
+        return k;
+    }
+    size_t next_in_order(size_t k) const {
+        if (2 * k + 1 <= n) {
+            for (k = 2 * k + 1; 2 * k <= n; k *= 2);
+            return k;
+        }
+        while (k & 1) k >>= 1;
+        return k >> 1;
+    }
+    /**
+     * the in-order position of node k. In the perfect tree as deep as this one, node k at
+     * depth d sits at p = (2 (k - 2^d) + 1) 2^(H - d) - 1; the deepest level holds its
+     * m present nodes at the even positions 0, 2, ..., 2m - 2, so the absent ones
+     * before p are the evens from 2m up to p.
+     */
+    size_t rank(size_t k) const {
+        size_t height = search_detail::floor_log2(n), d = search_detail::floor_log2(k);
+        size_t p = ((2 * (k - ((size_t)1 << d)) + 1) << (height - d)) - 1;
+        size_t present = n - ((size_t)1 << height) + 1, before = (p + 1) / 2;
+        return p - (before > present ? before - present : 0);
+    }
+    /**
+     * the path taken ends in a run of right turns after the last left turn, whose node is the answer;
+     * no left turn at all means every element compared less, and the answer is past the end
+     */
+    size_t answer(size_t k) const {
+        k >>= search_detail::trailing_ones(k) + 1;
+        return k ? rank(k) : n;
+    }
+    /**
+     * every level above the deepest is full, so those steps run a fixed number of times;
+     * an absent node on the deepest level counts as a right turn, which answer() ignores
+     */
+    template<typename GoRight>
+    size_t descend(GoRight go_right) const {
+        if (!n) return 0;
+        size_t k = 1;
+        for (size_t level = search_detail::floor_log2(n); level; --level) {
+            SJTU_PREFETCH(reinterpret_cast<const void *>(reinterpret_cast<std::uintptr_t>(tree) + k * per_line * sizeof(T)));
+            k = 2 * k + go_right(tree[k]);
+        }
+        k = 2 * k + ((k > n) | go_right(tree[k <= n ? k : n]));
+        return answer(k);
+    }
+    void release() {
+        if (!tree) return;
+        for (size_t k = first_in_order(); k; k = next_in_order(k)) tree[k].~T();
+        ::operator delete(tree, std::align_val_t(align));
+        tree = nullptr;
+    }
+
+public:
+    /**
+     * build from the sorted range [first, last), ordered by cmp
+     */
+    template<typename Iter>
+    eytzinger_index(Iter first, Iter last, Compare cmp = Compare())
+        : tree(nullptr), n((size_t)std::distance(first, last)), cmp(cmp) {
+        tree = static_cast<T *>(::operator new((n + 1) * sizeof(T), std::align_val_t(align)));
+        size_t k = first_in_order();
+        try {
+            for (; k; k = next_in_order(k), ++first) ::new (static_cast<void *>(tree + k)) T(*first);
+        } catch (...) {
+            for (size_t j = first_in_order(); j != k; j = next_in_order(j)) tree[j].~T();
+            ::operator delete(tree, std::align_val_t(align));
+            throw;
+        }
+    }
+    eytzinger_index(const eytzinger_index &) = delete;
+    eytzinger_index &operator=(const eytzinger_index &) = delete;
+    eytzinger_index(eytzinger_index &&other) noexcept : tree(other.tree), n(other.n), cmp(other.cmp) {
+        other.tree = nullptr;
+        other.n = 0;
+    }
+    eytzinger_index &operator=(eytzinger_index &&other) noexcept {
+        if (this != &other) {
+            release();
+            tree = other.tree, n = other.n, cmp = other.cmp;
+            other.tree = nullptr;
+            other.n = 0;
+        }
+        return *this;
+    }
+    ~eytzinger_index() { release(); }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+
+    /**
+     * rank of the first element not less than value, size() if there is none
+     */
+    size_t lower_bound(const T &value) const {
+        return descend([&](const T &x) { return cmp(x, value); });
+    }
+    /**
+     * rank of the first element greater than value, size() if there is none
+     */
+    size_t upper_bound(const T &value) const {
+        return descend([&](const T &x) { return !cmp(value, x); });
+    }
+};
+
+/**
+ * how a parallel algorithm splits its work
+ * threads: workers including the calling thread, 0 for one per hardware thread
+ * grain: ranges at most this long are handled by a single task
+ * without SJTU_PARALLEL defined, every parallel algorithm runs on the calling thread.
+ */
+struct parallel_policy {
+    unsigned threads;
+    std::ptrdiff_t grain;
+    parallel_policy(unsigned threads = 0, std::ptrdiff_t grain = 1 << 16) : threads(threads), grain(grain) {}
+};
+
+namespace parallel_detail {
+
+#ifdef SJTU_PARALLEL
+/**
+ * fork-join pool with work stealing: each thread pushes the tasks it spawns onto the back
+ * of its own deque and pops from there, idle threads steal the oldest, i.e. largest, task
+ * from the front of another deque. A thread waiting for its group keeps running tasks
+ * meanwhile, so nested fork-join cannot deadlock.
+ * an exception thrown by a task is kept, the first one is rethrown by rethrow().
+ */
+class task_pool {
+public:
+    /**
+     * the tasks spawned for one join point that have not finished yet
+     */
+    struct group {
+        std::atomic<std::ptrdiff_t> pending;
+        group() : pending(0) {}
+    };
+
+    explicit task_pool(unsigned threads) : queues(threads ? threads : 1), stop(false), queued(0) {
+        for (unsigned i = 1; i < queues.size(); ++i)
+            workers.emplace_back([this, i] { work(i); });
+    }
+    ~task_pool() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::thread &t : workers) t.join();
+    }
+
+    unsigned size() const { return (unsigned)queues.size(); }
+
+    template<typename F>
+    void spawn(group &g, F f) {
+        g.pending.fetch_add(1, std::memory_order_relaxed);
+        queue &q = queues[self() < queues.size() ? self() : 0];
+        {
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.tasks.push_back(task{std::function<void()>(std::move(f)), &g});
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        { std::lock_guard<std::mutex> guard(sleep_lock); }
+        wake.notify_one();
+    }
+    void wait(group &g) {
+        while (g.pending.load(std::memory_order_acquire) != 0)
+            if (!run_one()) std::this_thread::yield();
+    }
+    void rethrow() {
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    struct task {
+        std::function<void()> run;
+        group *owner;
+    };
+    struct queue {
+        std::mutex lock;
+        std::deque<task> tasks;
+    };
+    std::vector<queue> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleep_lock, error_lock;
+    std::condition_variable wake;
+    bool stop;
+    std::atomic<std::ptrdiff_t> queued;
+    std::exception_ptr error;
+
+    static unsigned &self() {
+        static thread_local unsigned index = 0;
+        return index;
+    }
+    bool take(queue &q, bool back, task &t) {
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.tasks.empty()) return false;
+        if (back) t = std::move(q.tasks.back()), q.tasks.pop_back();
+        else t = std::move(q.tasks.front()), q.tasks.pop_front();
+        return true;
+    }
+    bool run_one() {
+        if (queued.load(std::memory_order_acquire) == 0) return false;
+        unsigned me = self() < queues.size() ? self() : 0;
+        task t;
+        bool found = take(queues[me], true, t);
+        for (unsigned i = 1; !found && i < queues.size(); ++i)
+            found = take(queues[(me + i) % queues.size()], false, t);
+        if (!found) return false;
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        try {
+            t.run();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(error_lock);
+            if (!error) error = std::current_exception();
+        }
+        t.owner->pending.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    void work(unsigned index) {
+        self() = index;
+        while (true) {
+            if (run_one()) continue;
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard, [this] { return stop || queued.load(std::memory_order_acquire) != 0; });
+            if (stop) return;
+        }
+    }
+};
+#else
+/**
+ * stand-in for the pool when SJTU_PARALLEL is not defined: a spawned task runs right away
+ */
+class task_pool {
+public:
+    struct group {};
+    explicit task_pool(unsigned) {}
+    unsigned size() const { return 1; }
+    template<typename F>
+    void spawn(group &, F f) { f(); }
+    void wait(group &) {}
+    void rethrow() {}
+};
+#endif
+
+inline unsigned thread_count(const parallel_policy &policy) {
+#ifdef SJTU_PARALLEL
+    if (policy.threads) return policy.threads;
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware ? hardware : 1;
+#else
+    (void)policy;
+    return 1;
+#endif
+}
+
+/**
+ * run left on another thread if one is free while right runs here, and join;
+ * left is always waited for, even when right throws, since it refers to this frame
+ */
+template<typename Left, typename Right>
+void fork_join(task_pool &pool, Left left, Right right) {
+    task_pool::group g;
+    pool.spawn(g, left);
+    try {
+        right();
+    } catch (...) {
+        pool.wait(g);
+        throw;
+    }
+    pool.wait(g);
+}
+
+template<bool Move, typename Iter>
+decltype(auto) take(Iter it) {
+    if constexpr (Move) return std::move(*it);
+    else return *it;
+}
+
+/**
+ * stable merge of [first1, last1) and [first2, last2) into out, ties taken from the first range
+ */
+template<bool Move, typename In1, typename In2, typename Out, typename Compare>
+Out merge(In1 first1, In1 last1, In2 first2, In2 last2, Out out, Compare &cmp) {
+    while (first1 != last1 && first2 != last2) {
+        if (cmp(*first2, *first1)) *out = take<Move>(first2), ++first2;
+        else *out = take<Move>(first1), ++first1;
+        ++out;
+    }
+    for (; first1 != last1; ++first1, ++out) *out = take<Move>(first1);
+    for (; first2 != last2; ++first2, ++out) *out = take<Move>(first2);
+    return out;
+}
+
+/**
+ * merge split at the middle of the longer input and at the matching bound in the other,
+ * so both halves can be merged independently; still stable
+ */
+template<bool Move, typename In1, typename In2, typename Out, typename Compare>
+void merge(task_pool &pool, In1 first1, In1 last1, In2 first2, In2 last2, Out out, Compare &cmp,
+           std::ptrdiff_t grain) {
+    std::ptrdiff_t len1 = last1 - first1, len2 = last2 - first2;
+    if (pool.size() == 1 || len1 + len2 <= grain) {
+        merge<Move>(first1, last1, first2, last2, out, cmp);
+        return;
+    }
+    In1 mid1;
+    In2 mid2;
+    if (len1 >= len2) {
+        mid1 = first1 + len1 / 2;
+        mid2 = sjtu::lower_bound(first2, last2, *mid1, cmp);
+    } else {
+        mid2 = first2 + len2 / 2;
+        mid1 = sjtu::upper_bound(first1, last1, *mid2, cmp);
+    }
+    Out out_mid = out + ((mid1 - first1) + (mid2 - first2));
+    fork_join(pool,
+        [&] { merge<Move>(pool, first1, mid1, first2, mid2, out, cmp, grain); },
+        [&] { merge<Move>(pool, mid1, last1, mid2, last2, out_mid, cmp, grain); });
+}
+
+/**
+ * merge sort of [a, a + n) through the scratch buffer b of the same length, swapping the two
+ * roles on every level; the result ends in b when into_b is set, in a otherwise.
+ * runs up to leaf long go to the sequential sort: insertion sort when Stable, pdqsort otherwise.
+ */
+template<bool Stable, typename Iter, typename Buffer, typename Compare>
+void sort(task_pool &pool, Iter a, Buffer b, std::ptrdiff_t n, bool into_b, Compare &cmp,
+          std::ptrdiff_t grain) {
+    std::ptrdiff_t leaf = Stable ? sort_detail::insertion_threshold : grain;
+    if (n <= leaf) {
+        if (Stable) sort_detail::insertion_sort(a, a + n, cmp);
+        else sjtu::sort(a, a + n, cmp);
+        if (into_b)
+            for (std::ptrdiff_t i = 0; i < n; ++i) b[i] = std::move(a[i]);
+        return;
+    }
+    std::ptrdiff_t half = n / 2;
+    if (n > grain && pool.size() > 1) {
+        fork_join(pool,
+            [&] { sort<Stable>(pool, a, b, half, !into_b, cmp, grain); },
+            [&] { sort<Stable>(pool, a + half, b + half, n - half, !into_b, cmp, grain); });
+    } else {
+        sort<Stable>(pool, a, b, half, !into_b, cmp, grain);
+        sort<Stable>(pool, a + half, b + half, n - half, !into_b, cmp, grain);
+    }
+    if (into_b) merge<true>(pool, a, a + half, a + half, a + n, b, cmp, grain);
+    else merge<true>(pool, b, b + half, b + half, b + n, a, cmp, grain);
+}
+
+template<bool Stable, typename Iter, typename Compare>
+void sort(Iter first, Iter last, Compare &cmp, const parallel_policy &policy) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    std::ptrdiff_t n = last - first, grain = policy.grain > 1 ? policy.grain : 2;
+    unsigned threads = thread_count(policy);
+    if (!Stable && (threads == 1 || n <= grain)) {
+        sjtu::sort(first, last, cmp);
+        return;
+    }
+    std::unique_ptr<T[]> buffer(new T[n]);
+    task_pool pool(threads);
+    sort<Stable>(pool, first, buffer.get(), n, false, cmp, grain);
+    pool.rethrow();
+}
+
+}
+
+/**
+ * sort [first, last) on several threads: the range is cut into grain-sized pieces that are
+ * sorted with sjtu::sort, then merged pairwise, every merge split among threads as well.
+ * needs O(n) extra memory, and T must be default constructible and move assignable.
+ * if cmp throws, the exception reaches the caller and the order of the range is unspecified.
+ */
+template<typename Iter, typename Compare>
+void parallel_sort(Iter first, Iter last, Compare cmp, parallel_policy policy = parallel_policy()){
+    parallel_detail::sort<false>(first, last, cmp, policy);
+}
+
+template<typename Iter>
+void parallel_sort(Iter first, Iter last){
+    sjtu::parallel_sort(first, last, less());
+}
+
+/**
+ * parallel_sort that keeps equal elements in their original order, built on insertion-sorted runs
+ */
+template<typename Iter, typename Compare>
+void parallel_stable_sort(Iter first, Iter last, Compare cmp, parallel_policy policy = parallel_policy()){
+    parallel_detail::sort<true>(first, last, cmp, policy);
+}
+
+template<typename Iter>
+void parallel_stable_sort(Iter first, Iter last){
+    sjtu::parallel_stable_sort(first, last, less());
+}
+
+/**
+ * copy the stable merge of the sorted ranges [first1, last1) and [first2, last2) to out,
+ * split among threads; returns the end of the output
+ */
+template<typename In1, typename In2, typename Out, typename Compare>
+Out parallel_merge(In1 first1, In1 last1, In2 first2, In2 last2, Out out, Compare cmp,
+                   parallel_policy policy = parallel_policy()){
+    parallel_detail::task_pool pool(parallel_detail::thread_count(policy));
+    parallel_detail::merge<false>(pool, first1, last1, first2, last2, out, cmp, policy.grain > 1 ? policy.grain : 2);
+    pool.rethrow();
+    return out + ((last1 - first1) + (last2 - first2));
+}
+
+template<typename In1, typename In2, typename Out>
+Out parallel_merge(In1 first1, In1 last1, In2 first2, In2 last2, Out out){
+    return sjtu::parallel_merge(first1, last1, first2, last2, out, less());
 }
 
 };
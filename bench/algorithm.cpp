@@ -0,0 +1,176 @@
+/*
+ * sjtu::sort on random, sorted, reversed, organ-pipe and duplicate-heavy
+ * input: the pattern-defeating quicksort against the recursive Hoare
+ * quicksort it replaced (kept below as legacy_quick_sort) and std::sort,
+ * for int, double and std::string. The legacy sort is left out on
+ * organ-pipe input, where it overflows the stack.
+ * Then 1e6 random lookups into sorted int arrays from 1e3 to max_n:
+ * the old int-indexed lower_bound, the branchless one, the batched
+ * lower_bounds, eytzinger_index and std::lower_bound.
+ * Last, parallel_sort and parallel_stable_sort against sjtu::sort, and
+ * list::parallel_sort against list::sort; they only use several threads
+ * in list_algorithm_bench_threads, built with SJTU_PARALLEL.
+ *
+ * usage: list_algorithm_bench [n] [suite]
+ *     n      sort size and largest search array, default 1e6 (1e7 for search and parallel)
+ *     suite  run only sort, search or parallel
+ */
+#include "bench.hpp"
+#include "algorithm.hpp"
+#include "list.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * the Hoare quicksort sjtu::sort used before
+ */
+template<typename T, typename Compare>
+void legacy_quick_sort(T *begin, T *end, Compare &cmp) {
+    int len = end - begin;
+    if (len <= 1) return;
+    T *i = begin, *j = end - 1;
+    T pivot = *(begin + (len + 1) / 2 - 1);
+    while (j - i >= 0) {
+        while (cmp(*i, pivot)) i++;
+        while (cmp(pivot, *j)) j--;
+        if (j - i >= 0) {
+            std::swap(*i, *j);
+            i++, j--;
+        }
+    }
+    if (j - begin > 0) legacy_quick_sort(begin, i, cmp);
+    if (end - i > 1) legacy_quick_sort(i, end, cmp);
+}
+
+/**
+ * the int-indexed binary search sjtu::lower_bound used before
+ */
+template<class T>
+T *legacy_lower_bound(const T *begin, const T *end, const T &num) {
+    int l = -1, r = end - begin;
+    while (l + 1 < r) {
+        int mid = (l + r) >> 1;
+        if (num <= *(begin + mid)) r = mid; else l = mid;
+    }
+    return const_cast<T *>(begin + r);
+}
+
+std::vector<int> make_keys(const char *shape, size_t n) {
+    std::vector<int> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        switch (shape[0]) {
+            case 'r': v[i] = shape[2] == 'n' ? rand() : (int)(n - i); break; // random / reversed
+            case 's': v[i] = (int)i; break;                                  // sorted
+            case 'o': v[i] = (int)(i < n / 2 ? i : n - i); break;            // organ pipe
+            default: v[i] = rand() % 16; break;                              // duplicates
+        }
+    }
+    return v;
+}
+
+template<typename T> T convert(int key) { return (T)key; }
+template<> std::string convert<std::string>(int key) { return std::to_string(key); }
+
+template<typename T, typename Sort>
+double time_sort(const std::vector<T> &input, Sort sort) {
+    return bench::best_of([&] {
+        std::vector<T> v = input;
+        auto begin = std::chrono::steady_clock::now();
+        sort(v);
+        double ms = bench::since(begin);
+        bench::keep(v.front());
+        return ms;
+    });
+}
+
+template<typename T>
+void suite(const char *type, size_t n) {
+    const char *shapes[] = {"random", "sorted", "reversed", "organ_pipe", "duplicates"};
+    for (const char *shape : shapes) {
+        std::vector<int> keys = make_keys(shape, n);
+        std::vector<T> input(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) input[i] = convert<T>(keys[i]);
+        auto less = [](const T &a, const T &b) { return a < b; };
+        bench::report(type, shape, "pdq", n, time_sort(input, [](std::vector<T> &v) {
+            sjtu::sort(v.begin(), v.end()); }));
+        // organ-pipe input drives the middle-element pivot quadratic, and its recursion off the stack
+        if (shape[0] != 'o')
+            bench::report(type, shape, "legacy_quick", n, time_sort(input, [&](std::vector<T> &v) {
+                legacy_quick_sort(v.data(), v.data() + v.size(), less); }));
+        bench::report(type, shape, "std", n, time_sort(input, [](std::vector<T> &v) {
+            std::sort(v.begin(), v.end()); }));
+    }
+}
+
+void search(size_t max_n) {
+    const size_t queries = 1000000;
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        std::vector<int> sorted(n), keys(queries);
+        for (size_t i = 0; i < n; ++i) sorted[i] = (int)(2 * i);
+        for (size_t i = 0; i < queries; ++i) keys[i] = rand() % (int)(2 * n);
+        std::vector<const int *> found(queries);
+        const int *begin = sorted.data(), *end = begin + n;
+        bench::report("search", "lower_bound", "legacy", n, bench::best_ms([&] {
+            for (size_t i = 0; i < queries; ++i) found[i] = legacy_lower_bound(begin, end, keys[i]);
+            bench::keep(found); }));
+        bench::report("search", "lower_bound", "branchless", n, bench::best_ms([&] {
+            for (size_t i = 0; i < queries; ++i) found[i] = sjtu::lower_bound(begin, end, keys[i]);
+            bench::keep(found); }));
+        bench::report("search", "lower_bound", "batched", n, bench::best_ms([&] {
+            sjtu::lower_bounds(begin, end, keys.begin(), keys.end(), found.begin());
+            bench::keep(found); }));
+        bench::report("search", "lower_bound", "std", n, bench::best_ms([&] {
+            for (size_t i = 0; i < queries; ++i) found[i] = std::lower_bound(begin, end, keys[i]);
+            bench::keep(found); }));
+        sjtu::eytzinger_index<int> index(begin, end);
+        std::vector<size_t> ranks(queries);
+        bench::report("search", "lower_bound", "eytzinger", n, bench::best_ms([&] {
+            for (size_t i = 0; i < queries; ++i) ranks[i] = index.lower_bound(keys[i]);
+            bench::keep(ranks); }));
+    }
+}
+
+void parallel(size_t n) {
+    std::vector<int> input = make_keys("random", n);
+    bench::report("parallel", "random", "sort", n, time_sort(input, [](std::vector<int> &v) {
+        sjtu::sort(v.begin(), v.end()); }));
+    bench::report("parallel", "random", "parallel_sort", n, time_sort(input, [](std::vector<int> &v) {
+        sjtu::parallel_sort(v.begin(), v.end()); }));
+    bench::report("parallel", "random", "parallel_stable_sort", n, time_sort(input, [](std::vector<int> &v) {
+        sjtu::parallel_stable_sort(v.begin(), v.end()); }));
+    size_t list_n = n / 10;
+    auto time_list = [&](bool threaded) {
+        return bench::best_of([&] {
+            sjtu::list<int> l(input.begin(), input.begin() + list_n);
+            auto begin = std::chrono::steady_clock::now();
+            if (threaded) l.parallel_sort();
+            else l.sort();
+            double ms = bench::since(begin);
+            bench::keep(l.front());
+            return ms;
+        });
+    };
+    bench::report("parallel", "list_random", "list::sort", list_n, time_list(false));
+    bench::report("parallel", "list_random", "list::parallel_sort", list_n, time_list(true));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 0;
+    std::string only = argc > 2 ? argv[2] : "";
+    srand(2022);
+    bench::header();
+    if (only.empty() || only == "sort") {
+        size_t sort_n = n ? n : 1000000;
+        suite<int>("int", sort_n);
+        suite<double>("double", sort_n);
+        suite<std::string>("string", sort_n / 4);
+    }
+    if (only.empty() || only == "search")
+        search(n ? n : 10000000);
+    if (only.empty() || only == "parallel")
+        parallel(n ? n : 10000000);
+    return 0;
+}
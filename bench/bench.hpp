@@ -0,0 +1,80 @@
+#ifndef SJTU_BENCH_HPP
+#define SJTU_BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+/*
+ * Minimal self-contained timing helpers shared by the benchmark targets.
+ * Every result is printed as one CSV line:
+ *     suite,case,impl,n,ms
+ * so runs can be diffed or collected over time.
+ */
+namespace bench {
+
+/**
+ * keep a value observable so the optimizer cannot drop the work producing it:
+ * the empty asm may read the object through its address, so the object must exist
+ * with its value at that point. elsewhere its bytes are read into a volatile sink
+ */
+template<typename T>
+inline void keep(const T &value) {
+#ifdef __GNUC__
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    const volatile unsigned char *bytes = reinterpret_cast<const volatile unsigned char *>(&value);
+    static volatile unsigned char sink;
+    for (size_t i = 0; i < sizeof(T); ++i) sink = bytes[i];
+#endif
+}
+
+/**
+ * run f reps times and return the best wall time in milliseconds
+ */
+template<typename F>
+double best_ms(F &&f, int reps = 3) {
+    double best = 0;
+    for (int r = 0; r < reps; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+/**
+ * run f reps times, where f times its own measured section and returns it in
+ * milliseconds, so untimed setup can live in the same call; return the best
+ */
+template<typename F>
+double best_of(F &&f, int reps = 3) {
+    double best = 0;
+    for (int r = 0; r < reps; ++r) {
+        double ms = f();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+/**
+ * milliseconds elapsed since begin
+ */
+inline double since(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+inline void header() {
+    printf("suite,case,impl,n,ms\n");
+}
+
+inline void report(const char *suite, const char *name, const char *impl, size_t n, double ms) {
+    printf("%s,%s,%s,%zu,%.6g\n", suite, name, impl, n, ms);
+    fflush(stdout);
+}
+
+}
+
+#endif //SJTU_BENCH_HPP
@@ -0,0 +1,63 @@
+/*
+ * Util::Bint arithmetic and conversion across operand sizes, from ten
+ * decimal digits up to a hundred thousand: addition, subtraction,
+ * accumulation in place, chained sums of temporaries, multiplication of
+ * equal and of unbalanced operands, parsing and printing.
+ * The ms column is the time of a single operation, best of three batches.
+ *
+ * usage: list_bint_bench [max_digits]
+ */
+#include "bench.hpp"
+#include "class-bint.hpp"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+std::string digits(size_t n) {
+    std::string s(n, '0');
+    s[0] = (char)('1' + rand() % 9);
+    for (size_t i = 1; i < n; ++i) s[i] = (char)('0' + rand() % 10);
+    return s;
+}
+
+/**
+ * time iters calls of f, per call
+ */
+template<typename F>
+double per_op(F &&f, size_t iters) {
+    return bench::best_ms([&] { for (size_t i = 0; i < iters; ++i) f(); }) / iters;
+}
+
+void run(size_t n) {
+    using Util::Bint;
+    std::string sa = digits(n), sb = digits(n), sc = digits(n / 10 + 1);
+    Bint a(sa), b(sb), c(sc), neg = Bint(0) - b;
+    // about 2e7 limb operations per batch for the linear cases, and the
+    // same budget measured in n^1.6 for multiplication
+    size_t linear = 20000000 / n + 1, quadratic = (size_t)(2e9 / (n * 40.0 + (double)n * n / 10)) + 1;
+
+    bench::report("bint", "add", "bint", n, per_op([&] { bench::keep(a + b); }, linear));
+    bench::report("bint", "sub", "bint", n, per_op([&] { bench::keep(a - b); }, linear));
+    bench::report("bint", "add_mixed_sign", "bint", n, per_op([&] { bench::keep(a + neg); }, linear));
+    Bint acc(a);
+    bench::report("bint", "accumulate", "bint", n, per_op([&] { acc += b; }, linear));
+    bench::keep(acc);
+    bench::report("bint", "sum_chain", "bint", n, per_op([&] { bench::keep(a + b + a + b); }, linear / 3 + 1));
+    bench::report("bint", "mul", "bint", n, per_op([&] { bench::keep(a * b); }, quadratic));
+    bench::report("bint", "mul_unbalanced", "bint", n, per_op([&] { bench::keep(a * c); }, 10 * quadratic));
+    bench::report("bint", "parse", "bint", n, per_op([&] { bench::keep(Bint(sa)); }, linear / 10 + 1));
+    bench::report("bint", "print", "bint", n, per_op([&] {
+        std::ostringstream os;
+        os << a;
+        bench::keep(os.str().size());
+    }, linear / 10 + 1));
+}
+
+int main(int argc, char **argv) {
+    size_t max_digits = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    bench::header();
+    srand(1);
+    for (size_t n = 10; n <= max_digits; n *= 10) run(n);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * the node layout of sjtu::compact_list (32-bit index links in a slot pool)
+ * against that of sjtu::list (pointer links, one heap block per node):
+ * heap bytes per element, allocator overhead included, and the time to build,
+ * walk and sort a list of small elements.
+ * footprint rows give bytes per element in the last column instead of milliseconds.
+ *
+ * usage: list_compact_bench [n]
+ *     n  elements per list, default 1e7
+ */
+#include "bench.hpp"
+#include "list.hpp"
+#include "compact_list.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/**
+ * bytes in use by the heap, as glibc reports them; 0 elsewhere
+ */
+static size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 m = mallinfo2();
+    return m.uordblks + m.hblkhd; // hblkhd: the large chunks served by mmap
+#else
+    return 0;
+#endif
+}
+
+template<typename List, typename T>
+void run(const char *suite, const char *impl, size_t n) {
+    size_t before = heap_in_use();
+    {
+        List l;
+        for (size_t i = 0; i < n; ++i) l.push_back((T)(uint32_t)(i * 2654435761u));
+        bench::report(suite, "footprint", impl, n, (double)(heap_in_use() - before) / n);
+    }
+    bench::report(suite, "push_back", impl, n, bench::best_ms([&] {
+        List l;
+        for (size_t i = 0; i < n; ++i) l.push_back((T)i);
+        bench::keep(l.size());
+    }));
+    List l;
+    for (size_t i = 0; i < n; ++i) l.push_back((T)(uint32_t)(i * 2654435761u));
+    bench::report(suite, "traverse", impl, n, bench::best_ms([&] {
+        T sum = 0;
+        for (auto it = l.cbegin(); it != l.cend(); ++it) sum += *it;
+        bench::keep(sum);
+    }));
+    bench::report(suite, "sort", impl, n, bench::best_ms([&] {
+        l.sort();
+        l.reverse();
+    }, 1));
+    bench::report(suite, "traverse_sorted", impl, n, bench::best_ms([&] {
+        T sum = 0;
+        for (auto it = l.cbegin(); it != l.cend(); ++it) sum += *it;
+        bench::keep(sum);
+    }));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    bench::header();
+    run<sjtu::list<int>, int>("int", "sjtu", n);
+    run<sjtu::compact_list<int>, int>("int", "compact", n);
+    run<sjtu::list<int64_t>, int64_t>("int64", "sjtu", n);
+    run<sjtu::compact_list<int64_t>, int64_t>("int64", "compact", n);
+    return 0;
+}
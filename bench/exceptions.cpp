@@ -0,0 +1,82 @@
+/*
+ * the cost of a failed check: throwing and catching the old exception (two
+ * std::string members, copied on throw) against the current one (a code and a
+ * fixed context, nothing allocated), and pop_front on an empty list caught as
+ * an exception against try_pop_front returning the code.
+ *
+ * usage: list_exceptions_bench [n]
+ *     n  failed operations per row, default 1e6
+ */
+#include "bench.hpp"
+#include "list.hpp"
+
+#include <cstdlib>
+#include <string>
+
+/**
+ * the exception as it was: a variant name and a detail, what() builds their concatenation
+ */
+class legacy_exception {
+protected:
+    const std::string variant = "";
+    std::string detail = "";
+public:
+    legacy_exception() {}
+    legacy_exception(const legacy_exception &ec) : variant(ec.variant), detail(ec.detail) {}
+    virtual std::string what() { return variant + " " + detail; }
+};
+
+class legacy_container_is_empty : public legacy_exception {};
+
+__attribute__((noinline)) void fail_legacy(int k) {
+    if (k >= 0) throw legacy_container_is_empty();
+}
+
+__attribute__((noinline)) void fail_current(int k) {
+    if (k >= 0) throw sjtu::container_is_empty(__func__);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    bench::header();
+    bench::report("throw", "catch_what", "legacy", n, bench::best_ms([&] {
+        size_t len = 0;
+        for (size_t i = 0; i < n; ++i) {
+            try {
+                fail_legacy((int)i);
+            } catch (legacy_exception &e) {
+                len += e.what().size();
+            }
+        }
+        bench::keep(len);
+    }));
+    bench::report("throw", "catch_what", "sjtu", n, bench::best_ms([&] {
+        size_t len = 0;
+        for (size_t i = 0; i < n; ++i) {
+            try {
+                fail_current((int)i);
+            } catch (sjtu::exception &e) {
+                len += e.what()[0];
+            }
+        }
+        bench::keep(len);
+    }));
+    sjtu::list<int> empty;
+    bench::report("list", "pop_front_empty", "catch", n, bench::best_ms([&] {
+        size_t failed = 0;
+        for (size_t i = 0; i < n; ++i) {
+            try {
+                empty.pop_front();
+            } catch (sjtu::container_is_empty &) {
+                ++failed;
+            }
+        }
+        bench::keep(failed);
+    }));
+    bench::report("list", "pop_front_empty", "try", n, bench::best_ms([&] {
+        size_t failed = 0;
+        for (size_t i = 0; i < n; ++i) failed += empty.try_pop_front() != sjtu::errc::ok;
+        bench::keep(failed);
+    }));
+    return 0;
+}
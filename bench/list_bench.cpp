@@ -0,0 +1,281 @@
+/*
+ * Throughput of every list operation (push, pop, insert, erase, traverse,
+ * seek, sort, merge, unique, reverse) for sjtu::list, sjtu::unrolled_list,
+ * sjtu::indexed_list and sjtu::compact_list against std::list, on the element types the testers use: int, the data/three Int, Util::Bint and
+ * Diamond::Matrix<double>. Sizes go from 1e3 up to 1e7 in powers of ten,
+ * capped per type so that one run stays within memory and a few minutes.
+ * Only the operation itself is timed; building the input list is not.
+ *
+ * usage: list_bench [max_n] [suite]
+ *     max_n  largest size to run (default 10000000)
+ *     suite  run only one of int, Int, Bint, Matrix
+ */
+#include "bench.hpp"
+#include "list.hpp"
+#include "unrolled_list.hpp"
+#include "indexed_list.hpp"
+#include "compact_list.hpp"
+#include "class-bint.hpp"
+#include "class-matrix.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <vector>
+
+class Int {
+public:
+    static int born;
+    static int dead;
+    int val;
+    Int(int val) : val(val) { born++; }
+    Int(const Int &rhs) : val(rhs.val) { born++; }
+    Int &operator=(const Int &rhs) { born++; dead++; val = rhs.val; return *this; }
+    bool operator==(const Int &rhs) const { return val == rhs.val; }
+    bool operator!=(const Int &rhs) const { return val != rhs.val; }
+    friend bool operator<(const Int &lhs, const Int &rhs) { return lhs.val > rhs.val; }
+    ~Int() { dead++; }
+};
+
+int Int::born = 0;
+int Int::dead = 0;
+
+using Matrix = Diamond::Matrix<double>;
+
+/**
+ * build an element of each payload type from a key
+ */
+template<typename T> T make(int key);
+template<> int make<int>(int key) { return key; }
+template<> Int make<Int>(int key) { return Int(key); }
+template<> Util::Bint make<Util::Bint>(int key) { return Util::Bint(key); }
+template<> Matrix make<Matrix>(int key) { return Matrix(2, 2, (double)key); }
+
+/**
+ * the ordering used by sort and merge; Matrix has no operator<, so compare its first entry
+ */
+struct order {
+    template<typename T>
+    bool operator()(const T &a, const T &b) const { return a < b; }
+    bool operator()(const Matrix &a, const Matrix &b) const { return a[0][0] < b[0][0]; }
+};
+
+/**
+ * every case receives the same keys; a quarter of n distinct keys leaves unique() work to do
+ */
+template<typename T>
+std::vector<T> values(size_t n) {
+    std::vector<T> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) v.push_back(make<T>(rand() % (int)(n / 4 + 1)));
+    return v;
+}
+
+template<typename List, typename T>
+List build(const std::vector<T> &v) {
+    List l;
+    for (const T &x : v) l.push_back(x);
+    return l;
+}
+
+template<typename List, typename T>
+double push_back(const std::vector<T> &v) {
+    auto begin = std::chrono::steady_clock::now();
+    List l;
+    for (const T &x : v) l.push_back(x);
+    double ms = bench::since(begin);
+    bench::keep(l.size());
+    return ms;
+}
+
+template<typename List, typename T>
+double push_front(const std::vector<T> &v) {
+    auto begin = std::chrono::steady_clock::now();
+    List l;
+    for (const T &x : v) l.push_front(x);
+    double ms = bench::since(begin);
+    bench::keep(l.size());
+    return ms;
+}
+
+/**
+ * drain from both ends alternately
+ */
+template<typename List, typename T>
+double pop(const std::vector<T> &v) {
+    List l = build<List>(v);
+    auto begin = std::chrono::steady_clock::now();
+    while (!l.empty()) {
+        l.pop_back();
+        if (!l.empty()) l.pop_front();
+    }
+    return bench::since(begin);
+}
+
+/**
+ * insert a copy before every element while walking the list
+ */
+template<typename List, typename T>
+double insert(const std::vector<T> &v) {
+    List l = build<List>(v);
+    auto begin = std::chrono::steady_clock::now();
+    size_t i = 0;
+    for (auto it = l.begin(); it != l.end(); ++it) {
+        it = l.insert(it, v[i++]);
+        ++it;
+    }
+    double ms = bench::since(begin);
+    bench::keep(l.size());
+    return ms;
+}
+
+/**
+ * erase every other element while walking the list
+ */
+template<typename List, typename T>
+double erase(const std::vector<T> &v) {
+    List l = build<List>(v);
+    auto begin = std::chrono::steady_clock::now();
+    for (auto it = l.begin(); it != l.end();) {
+        it = l.erase(it);
+        if (it != l.end()) ++it;
+    }
+    double ms = bench::since(begin);
+    bench::keep(l.size());
+    return ms;
+}
+
+/**
+ * walk forwards and backwards, touching every element
+ */
+template<typename List, typename T>
+double traverse(const std::vector<T> &v) {
+    List l = build<List>(v);
+    const T *last = nullptr;
+    auto begin = std::chrono::steady_clock::now();
+    for (auto it = l.cbegin(); it != l.cend(); ++it) last = &*it;
+    for (auto it = l.cend(); it != l.cbegin();) last = &*--it;
+    double ms = bench::since(begin);
+    bench::keep(last);
+    return ms;
+}
+
+/**
+ * the element at position k: a walk from the front, or the tree of indexed_list
+ */
+template<typename List>
+auto position(const List &l, size_t k) {
+    auto it = l.cbegin();
+    while (k--) ++it;
+    return it;
+}
+template<typename T>
+auto position(const sjtu::indexed_list<T> &l, size_t k) { return l.nth(k); }
+
+/**
+ * reach the elements at 200 random positions
+ */
+template<typename List, typename T>
+double seek(const std::vector<T> &v) {
+    List l = build<List>(v);
+    std::vector<size_t> at;
+    for (int i = 0; i < 200; ++i) at.push_back((size_t)rand() % v.size());
+    const T *last = nullptr;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t k : at) last = &*position(l, k);
+    double ms = bench::since(begin);
+    bench::keep(last);
+    return ms;
+}
+
+template<typename List, typename T>
+double sort(const std::vector<T> &v) {
+    List l = build<List>(v);
+    auto begin = std::chrono::steady_clock::now();
+    l.sort(order());
+    return bench::since(begin);
+}
+
+/**
+ * merge two sorted halves
+ */
+template<typename List, typename T>
+double merge(const std::vector<T> &v) {
+    List a, b;
+    for (size_t i = 0; i < v.size(); ++i) (i % 2 ? a : b).push_back(v[i]);
+    a.sort(order()), b.sort(order());
+    auto begin = std::chrono::steady_clock::now();
+    a.merge(b, order());
+    double ms = bench::since(begin);
+    bench::keep(a.size());
+    return ms;
+}
+
+/**
+ * unique on sorted input, so every duplicate is removed
+ */
+template<typename List, typename T>
+double unique(const std::vector<T> &v) {
+    List l = build<List>(v);
+    l.sort(order());
+    auto begin = std::chrono::steady_clock::now();
+    l.unique();
+    double ms = bench::since(begin);
+    bench::keep(l.size());
+    return ms;
+}
+
+template<typename List, typename T>
+double reverse(const std::vector<T> &v) {
+    List l = build<List>(v);
+    auto begin = std::chrono::steady_clock::now();
+    l.reverse();
+    return bench::since(begin);
+}
+
+template<typename List, typename T>
+void run(const char *suite, const char *impl, const std::vector<T> &v) {
+    // the largest sizes take seconds per case, one repetition is enough to rank them
+    int reps = v.size() >= 1000000 ? 1 : 3;
+    size_t n = v.size();
+    bench::report(suite, "push_back", impl, n, bench::best_of([&] { return push_back<List>(v); }, reps));
+    bench::report(suite, "push_front", impl, n, bench::best_of([&] { return push_front<List>(v); }, reps));
+    bench::report(suite, "pop", impl, n, bench::best_of([&] { return pop<List>(v); }, reps));
+    bench::report(suite, "insert", impl, n, bench::best_of([&] { return insert<List>(v); }, reps));
+    bench::report(suite, "erase", impl, n, bench::best_of([&] { return erase<List>(v); }, reps));
+    bench::report(suite, "traverse", impl, n, bench::best_of([&] { return traverse<List>(v); }, reps));
+    bench::report(suite, "seek", impl, n, bench::best_of([&] { return seek<List>(v); }, reps));
+    bench::report(suite, "sort", impl, n, bench::best_of([&] { return sort<List>(v); }, reps));
+    bench::report(suite, "merge", impl, n, bench::best_of([&] { return merge<List>(v); }, reps));
+    bench::report(suite, "unique", impl, n, bench::best_of([&] { return unique<List>(v); }, reps));
+    bench::report(suite, "reverse", impl, n, bench::best_of([&] { return reverse<List>(v); }, reps));
+}
+
+/**
+ * every size from 1e3 up to min(cap, max_n), sjtu, unrolled, indexed, compact then std on identical input
+ */
+template<typename T>
+void suite(const char *name, size_t cap, size_t max_n, const char *only) {
+    if (only && strcmp(only, name)) return;
+    for (size_t n = 1000; n <= cap && n <= max_n; n *= 10) {
+        srand(n);
+        std::vector<T> v = values<T>(n);
+        run<sjtu::list<T>>(name, "sjtu", v);
+        run<sjtu::unrolled_list<T>>(name, "unrolled", v);
+        run<sjtu::indexed_list<T>>(name, "indexed", v);
+        run<sjtu::compact_list<T>>(name, "compact", v);
+        run<std::list<T>>(name, "std", v);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t max_n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    const char *only = argc > 2 ? argv[2] : nullptr;
+    bench::header();
+    suite<int>("int", 10000000, max_n, only);
+    suite<Int>("Int", 10000000, max_n, only);
+    // a Bint and a 2x2 Matrix each own a heap buffer, so their suites stop at 1e6
+    suite<Util::Bint>("Bint", 1000000, max_n, only);
+    suite<Matrix>("Matrix", 1000000, max_n, only);
+    return 0;
+}
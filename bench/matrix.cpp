@@ -0,0 +1,110 @@
+/*
+ * Diamond::Matrix operator* and Transpose across sizes: the packed,
+ * register-tiled kernel against the i-j-k loop it replaced (kept below
+ * as legacy_mul), for double and float; the recursive Transpose against
+ * the plain double loop. The legacy multiply stops at 512, where one
+ * call already takes about a second. Element-wise expressions are timed
+ * fused, as the lazy operators evaluate them, and eagerly, one temporary
+ * per operator as before.
+ *
+ * usage: list_matrix_bench [max_n]
+ */
+#include "bench.hpp"
+#include "class-matrix.hpp"
+
+#include <cstdlib>
+
+template<typename T>
+using Matrix = Diamond::Matrix<T>;
+
+template<typename T>
+Matrix<T> legacy_mul(const Matrix<T> &a, const Matrix<T> &b) {
+    Matrix<T> c(a.RowSize(), b.ColSize(), 0);
+    for (size_t i = 0; i < a.RowSize(); ++i)
+        for (size_t j = 0; j < b.ColSize(); ++j)
+            for (size_t k = 0; k < a.ColSize(); ++k)
+                c[i][j] += a[i][k] * b[k][j];
+    return c;
+}
+
+template<typename T>
+Matrix<T> legacy_transpose(const Matrix<T> &a) {
+    Matrix<T> res(a.ColSize(), a.RowSize());
+    for (size_t i = 0; i < a.ColSize(); ++i)
+        for (size_t j = 0; j < a.RowSize(); ++j)
+            res[i][j] = a[j][i];
+    return res;
+}
+
+// the eager element-wise operators the expression layer replaced
+template<typename T, typename F>
+Matrix<T> legacy_zip(const Matrix<T> &a, const Matrix<T> &b, F f) {
+    Matrix<T> c(a.RowSize(), a.ColSize());
+    for (size_t i = 0; i < a.RowSize(); ++i)
+        for (size_t j = 0; j < a.ColSize(); ++j) c[i][j] = f(a[i][j], b[i][j]);
+    return c;
+}
+
+template<typename T>
+Matrix<T> legacy_scale(const Matrix<T> &a, T s) {
+    Matrix<T> c(a.RowSize(), a.ColSize());
+    for (size_t i = 0; i < a.RowSize(); ++i)
+        for (size_t j = 0; j < a.ColSize(); ++j) c[i][j] = a[i][j] * s;
+    return c;
+}
+
+template<typename T>
+Matrix<T> random_matrix(size_t n) {
+    Matrix<T> m(n, n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j) m[i][j] = (T)(rand() % 1000) / 100;
+    return m;
+}
+
+template<typename T>
+void mul(const char *suite, size_t max_n) {
+    for (size_t n = 16; n <= max_n; n *= 2) {
+        Matrix<T> a = random_matrix<T>(n), b = random_matrix<T>(n);
+        int reps = n >= 512 ? 1 : 3;
+        bench::report(suite, "mul", "gemm", n, bench::best_ms([&] { bench::keep(a * b); }, reps));
+        if (n <= 512)
+            bench::report(suite, "mul", "legacy", n, bench::best_ms([&] { bench::keep(legacy_mul(a, b)); }, reps));
+    }
+}
+
+void transpose(size_t max_n) {
+    for (size_t n = 256; n <= 4 * max_n; n *= 2) {
+        Matrix<double> a = random_matrix<double>(n);
+        bench::report("double", "transpose", "recursive", n, bench::best_ms([&] { bench::keep(Matrix<double>(Diamond::Transpose(a))); }));
+        bench::report("double", "transpose", "legacy", n, bench::best_ms([&] { bench::keep(legacy_transpose(a)); }));
+    }
+}
+
+void elementwise(size_t max_n) {
+    auto plus = [](double x, double y) { return x + y; };
+    auto minus = [](double x, double y) { return x - y; };
+    for (size_t n = 256; n <= 4 * max_n; n *= 2) {
+        Matrix<double> a = random_matrix<double>(n), b = random_matrix<double>(n), c = random_matrix<double>(n);
+        bench::report("double", "a*2+b-c", "fused", n, bench::best_ms([&] {
+            bench::keep(Matrix<double>(a * 2.0 + b - c)); }));
+        bench::report("double", "a*2+b-c", "eager", n, bench::best_ms([&] {
+            bench::keep(legacy_zip(legacy_zip(legacy_scale(a, 2.0), b, plus), c, minus)); }));
+        Matrix<double> out(n, n);
+        bench::report("double", "a*2+b-c_assign", "fused", n, bench::best_ms([&] {
+            out = a * 2.0 + b - c; bench::keep(out); }));
+        bench::report("double", "T(a)+b", "fused", n, bench::best_ms([&] {
+            bench::keep(Matrix<double>(Diamond::Transpose(a) + b)); }));
+        bench::report("double", "T(a)+b", "eager", n, bench::best_ms([&] {
+            bench::keep(legacy_zip(legacy_transpose(a), b, plus)); }));
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t max_n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1024;
+    bench::header();
+    mul<double>("double", max_n);
+    mul<float>("float", max_n);
+    transpose(max_n);
+    elementwise(max_n);
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * combining k sorted shard lists into one: list::merge_all against merging
+ * the shards into the result one after the other, for k from 2 to 256.
+ * only the merging is timed; building and sorting the shards is not.
+ *
+ * usage: list_merge_all_bench [n]
+ *     n  elements over all shards, default 1e6
+ */
+#include "bench.hpp"
+#include "list.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+std::vector<sjtu::list<int>> shards(size_t n, size_t k) {
+    std::vector<sjtu::list<int>> s(k);
+    for (size_t i = 0; i < n; ++i) s[rand() % k].push_back(rand());
+    for (sjtu::list<int> &l : s) l.sort();
+    return s;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    bench::header();
+    for (size_t k = 2; k <= 256; k *= 4) {
+        srand(k);
+        bench::report("merge", "shards", "pairwise", k, bench::best_of([&] {
+            std::vector<sjtu::list<int>> s = shards(n, k);
+            sjtu::list<int> out;
+            auto begin = std::chrono::steady_clock::now();
+            for (sjtu::list<int> &l : s) out.merge(l);
+            double ms = bench::since(begin);
+            bench::keep(out.size());
+            return ms;
+        }));
+        bench::report("merge", "shards", "merge_all", k, bench::best_of([&] {
+            std::vector<sjtu::list<int>> s = shards(n, k);
+            sjtu::list<int> out;
+            auto begin = std::chrono::steady_clock::now();
+            out.merge_all(s.begin(), s.end());
+            double ms = bench::since(begin);
+            bench::keep(out.size());
+            return ms;
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * push/pop throughput on int: the hot path through insert/erase
+ * that push_back/pop_back and push_front/pop_front share.
+ *
+ * usage: list_push_pop_bench [n]
+ */
+#include "bench.hpp"
+#include "list.hpp"
+
+#include <cstdlib>
+#include <list>
+
+template<typename List>
+void back(size_t n) {
+    List l;
+    for (int round = 0; round < 4; ++round) {
+        for (size_t i = 0; i < n; ++i) l.push_back((int)i);
+        for (size_t i = 0; i < n; ++i) l.pop_back();
+    }
+    bench::keep(l.size());
+}
+
+template<typename List>
+void front(size_t n) {
+    List l;
+    for (int round = 0; round < 4; ++round) {
+        for (size_t i = 0; i < n; ++i) l.push_front((int)i);
+        for (size_t i = 0; i < n; ++i) l.pop_front();
+    }
+    bench::keep(l.size());
+}
+
+/**
+ * a queue that never grows past a few nodes: allocator and call overhead only
+ */
+template<typename List>
+void churn(size_t n) {
+    List l;
+    for (int i = 0; i < 8; ++i) l.push_back(i);
+    for (size_t i = 0; i < 4 * n; ++i) {
+        l.push_back((int)i);
+        l.pop_front();
+    }
+    bench::keep(l.size());
+}
+
+/**
+ * the list reaches the loop by reference from another translation unit's point of view,
+ * so the compiler cannot see its dynamic type
+ */
+template<typename List>
+__attribute__((noinline)) void fill_drain(List &l, size_t n) {
+    for (size_t i = 0; i < n; ++i) l.push_back((int)i);
+    for (size_t i = 0; i < n; ++i) l.pop_back();
+}
+
+template<typename List>
+void by_ref(size_t n) {
+    List l;
+    for (int round = 0; round < 4; ++round) fill_drain(l, n);
+    bench::keep(l.size());
+}
+
+template<typename List>
+void run(const char *impl, size_t n) {
+    bench::report("push_pop", "back", impl, 4 * n, bench::best_ms([n] { back<List>(n); }, 5));
+    bench::report("push_pop", "front", impl, 4 * n, bench::best_ms([n] { front<List>(n); }, 5));
+    bench::report("push_pop", "churn", impl, 4 * n, bench::best_ms([n] { churn<List>(n); }, 5));
+    bench::report("push_pop", "by_ref", impl, 4 * n, bench::best_ms([n] { by_ref<List>(n); }, 5));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    bench::header();
+    run<sjtu::list<int>>("sjtu", n);
+    run<std::list<int>>("std", n);
+    return 0;
+}
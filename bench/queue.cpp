@@ -0,0 +1,106 @@
+/*
+ * a work queue between producer and consumer threads: sjtu::list behind one
+ * global mutex, concurrent_queue popped one element at a time, and
+ * concurrent_queue drained into a local list in batches. Every producer
+ * pushes n / producers ints; the time is until every int was consumed.
+ *
+ * usage: list_queue_bench [n] [threads]
+ *     n        ints pushed in total, default 4e6
+ *     threads  largest number of producers, and of consumers, default 4
+ */
+#include "bench.hpp"
+#include "concurrent_queue.hpp"
+#include "list.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * the setup the queue replaces: every push_back and pop_front takes the same lock
+ */
+struct locked_list {
+    std::mutex lock;
+    sjtu::list<int> items;
+
+    void push(int x) {
+        std::lock_guard<std::mutex> guard(lock);
+        items.push_back(x);
+    }
+    size_t take(long long &sum) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (items.empty()) return 0;
+        sum += items.front();
+        items.pop_front();
+        return 1;
+    }
+};
+
+struct popping_queue {
+    sjtu::concurrent_queue<int> queue;
+
+    void push(int x) { queue.push(x); }
+    size_t take(long long &sum) {
+        int x;
+        if (!queue.try_pop(x)) return 0;
+        sum += x;
+        return 1;
+    }
+};
+
+struct draining_queue {
+    sjtu::concurrent_queue<int> queue;
+
+    void push(int x) { queue.push(x); }
+    size_t take(long long &sum) {
+        sjtu::list<int> batch;
+        size_t got = queue.drain_into(batch);
+        for (int x : batch) sum += x;
+        return got;
+    }
+};
+
+template<typename Queue>
+double run(size_t n, unsigned producers, unsigned consumers) {
+    Queue q;
+    std::atomic<size_t> done(0);
+    std::atomic<long long> total(0);
+    size_t each = n / producers;
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < producers; ++p)
+        threads.emplace_back([&q, each] {
+            for (size_t i = 0; i < each; ++i) q.push((int)i);
+        });
+    for (unsigned c = 0; c < consumers; ++c)
+        threads.emplace_back([&] {
+            long long sum = 0;
+            while (done.load(std::memory_order_relaxed) < each * producers) {
+                size_t got = q.take(sum);
+                if (got) done.fetch_add(got, std::memory_order_relaxed);
+                else std::this_thread::yield();
+            }
+            total += sum;
+        });
+    for (std::thread &t : threads) t.join();
+    double ms = bench::since(begin);
+    bench::keep(total.load());
+    return ms;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 4000000;
+    unsigned most = argc > 2 ? (unsigned)atoi(argv[2]) : 4;
+    bench::header();
+    for (unsigned threads = 1; threads <= most; threads *= 2) {
+        bench::report("queue", "producers_consumers", "sjtu_locked", threads,
+                      bench::best_of([&] { return run<locked_list>(n, threads, threads); }));
+        bench::report("queue", "producers_consumers", "try_pop", threads,
+                      bench::best_of([&] { return run<popping_queue>(n, threads, threads); }));
+        bench::report("queue", "producers_consumers", "drain_into", threads,
+                      bench::best_of([&] { return run<draining_queue>(n, threads, threads); }));
+    }
+    return 0;
+}
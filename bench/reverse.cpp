@@ -0,0 +1,84 @@
+/*
+ * the data/four tester4 workload: pushes at either end with a reverse() every
+ * ~20 pushes, then walks to random positions and pops from either end.
+ * built twice, as list_reverse_bench (reverse() relinks every node) and as
+ * list_reverse_bench_lazy (SJTU_LIST_LAZY_REVERSE, reverse() flips a bit),
+ * with std::list alongside; a final sort() pays for settling a flipped list.
+ *
+ * usage: list_reverse_bench [n]
+ *     n  elements pushed, default 1e5; the walks run on a tenth of that
+ */
+#include "bench.hpp"
+#include "list.hpp"
+
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+#ifdef SJTU_LIST_LAZY_REVERSE
+static const char *impl = "lazy";
+#else
+static const char *impl = "eager";
+#endif
+
+/**
+ * push every key at a random end, reversing the list after about one push in 20
+ */
+template<typename List>
+void fill(List &l, const std::vector<int> &keys, const std::vector<int> &coin) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (coin[i] & 1) l.push_front(keys[i]);
+        else l.push_back(keys[i]);
+        if (coin[i] % 40 < 2) l.reverse();
+    }
+}
+
+template<typename List>
+void run(const char *name, const std::vector<int> &keys, const std::vector<int> &coin) {
+    size_t n = keys.size();
+    bench::report("tester4", "push_reverse", name, n, bench::best_ms([&] {
+        List l;
+        fill(l, keys, coin);
+        bench::keep(l.size());
+    }));
+    size_t m = n / 10;
+    std::vector<int> few(keys.begin(), keys.begin() + m);
+    bench::report("tester4", "walk_pop", name, m, bench::best_of([&] {
+        List l;
+        fill(l, few, coin);
+        auto begin = std::chrono::steady_clock::now();
+        size_t k = 0;
+        long long sum = 0;
+        while (!l.empty()) {
+            auto it = l.begin();
+            for (size_t gap = coin[k++ % coin.size()] % l.size(); gap; --gap) ++it;
+            sum += *it;
+            if (coin[k % coin.size()] & 2) l.pop_front();
+            else l.pop_back();
+        }
+        double ms = bench::since(begin);
+        bench::keep(sum);
+        return ms;
+    }));
+    bench::report("tester4", "sort_flipped", name, n, bench::best_of([&] {
+        List l;
+        fill(l, keys, coin);
+        l.reverse();
+        auto begin = std::chrono::steady_clock::now();
+        l.sort();
+        double ms = bench::since(begin);
+        bench::keep(l.size());
+        return ms;
+    }));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    srand(4);
+    std::vector<int> keys, coin;
+    for (size_t i = 0; i < n; ++i) keys.push_back(rand()), coin.push_back(rand());
+    bench::header();
+    run<sjtu::list<int>>(impl, keys, coin);
+    run<std::list<int>>("std", keys, coin);
+    return 0;
+}
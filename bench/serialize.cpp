@@ -0,0 +1,78 @@
+/*
+ * restoring a checkpointed list: the elements read back one at a time and
+ * pushed back, list::load() from a stream, and list::load_file() from a
+ * mapped file, for trivially copyable records and for Util::Bint (text
+ * through operator>> against the limb dump of load_binary).
+ *
+ * usage: list_serialize_bench [n] [dir]
+ *     n    records restored, default 1e6; a tenth as many Bints
+ *     dir  where the checkpoint files go, default /tmp
+ */
+#include "bench.hpp"
+#include "class-bint.hpp"
+#include "list.hpp"
+#include "serialize.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+struct record {
+    long long id;
+    double value;
+};
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string dir = argc > 2 ? argv[2] : "/tmp";
+    bench::header();
+
+    sjtu::list<record> records;
+    for (size_t i = 0; i < n; ++i) records.push_back(record{(long long)i, i * 0.25});
+    std::string path = dir + "/sjtu_list_bench_records.bin";
+    records.save_file(path.c_str());
+    bench::report("restore", "records", "push_back", n, bench::best_ms([&] {
+        std::ifstream is(path, std::ios::binary);
+        is.seekg(sizeof(sjtu::list_file_header));
+        sjtu::list<record> out;
+        record r;
+        while (is.read(reinterpret_cast<char *>(&r), sizeof(r))) out.push_back(r);
+        bench::keep(out.size());
+    }));
+    bench::report("restore", "records", "load", n, bench::best_ms([&] {
+        std::ifstream is(path, std::ios::binary);
+        sjtu::list<record> out;
+        out.load(is);
+        bench::keep(out.size());
+    }));
+    bench::report("restore", "records", "load_file", n, bench::best_ms([&] {
+        sjtu::list<record> out;
+        out.load_file(path.c_str());
+        bench::keep(out.size());
+    }));
+    remove(path.c_str());
+
+    size_t m = n / 10 + 1;
+    sjtu::list<Util::Bint> bints;
+    Util::Bint large("123456789012345678901234567890123456789");
+    for (size_t i = 0; i < m; ++i) bints.push_back(Util::Bint((long long)i) * large);
+    std::stringstream text, dump;
+    for (const Util::Bint &b : bints) text << b << ' ';
+    bints.save(dump);
+    std::string text_bytes = text.str(), dump_bytes = dump.str();
+    bench::report("restore", "bints", "operator>>", m, bench::best_ms([&] {
+        std::istringstream is(text_bytes);
+        sjtu::list<Util::Bint> out;
+        Util::Bint b;
+        while (is >> b) out.push_back(b);
+        bench::keep(out.size());
+    }));
+    bench::report("restore", "bints", "load", m, bench::best_ms([&] {
+        std::istringstream is(dump_bytes);
+        sjtu::list<Util::Bint> out;
+        out.load(is);
+        bench::keep(out.size());
+    }));
+    return 0;
+}
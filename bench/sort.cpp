@@ -0,0 +1,86 @@
+/*
+ * list::sort on random, sorted, reversed and duplicate-heavy input:
+ * the bottom-up merge sort against the previous node-array quicksort
+ * (kept below as legacy_sort) and std::list::sort.
+ *
+ * usage: list_sort_bench [n]
+ */
+#include "bench.hpp"
+#include "list.hpp"
+
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+/**
+ * the node-array Hoare quicksort list::sort used before
+ */
+struct legacy_list : sjtu::list<int> {
+    void legacy_sort() {
+        if (sz <= 1) return;
+        node **a = new node*[sz];
+        size_t idx = 0;
+        for (node *cur = head->next; cur != head; cur = cur->next) a[idx++] = cur;
+        int *L = new int[sz], *R = new int[sz];
+        int top = 0; L[0] = 0; R[0] = (int)sz - 1;
+        while (top >= 0) {
+            int l = L[top], r = R[top];
+            --top;
+            int i = l, j = r;
+            node *pivot = a[(l + r) >> 1];
+            while (i <= j) {
+                while (*(a[i]->val()) < *(pivot->val())) ++i;
+                while (*(pivot->val()) < *(a[j]->val())) --j;
+                if (i <= j) { node *t = a[i]; a[i] = a[j]; a[j] = t; ++i; --j; }
+            }
+            if (l < j) { ++top; L[top] = l; R[top] = j; }
+            if (i < r) { ++top; L[top] = i; R[top] = r; }
+        }
+        head->next = a[0]; a[0]->prev = head;
+        for (size_t k = 1; k < sz; ++k) { a[k-1]->next = a[k]; a[k]->prev = a[k-1]; }
+        a[sz-1]->next = head; head->prev = a[sz-1];
+        delete [] L; delete [] R; delete [] a;
+    }
+};
+
+std::vector<int> make_input(const char *shape, size_t n) {
+    std::vector<int> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        switch (shape[0]) {
+            case 'r': v[i] = shape[2] == 'n' ? rand() : (int)(n - i); break; // random / reversed
+            case 's': v[i] = (int)i; break;                                  // sorted
+            default: v[i] = rand() % 16; break;                              // duplicates
+        }
+    }
+    return v;
+}
+
+template<typename List, typename Sort>
+double time_sort(const std::vector<int> &input, Sort sort) {
+    double total = 0;
+    for (int r = 0; r < 3; ++r) {
+        List l;
+        for (size_t i = 0; i < input.size(); ++i) l.push_back(input[i]);
+        double ms = bench::best_ms([&] { sort(l); }, 1);
+        if (r == 0 || ms < total) total = ms;
+        bench::keep(l.front());
+    }
+    return total;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    srand(2022);
+    const char *shapes[] = {"random", "sorted", "reversed", "duplicates"};
+    bench::header();
+    for (const char *shape : shapes) {
+        std::vector<int> input = make_input(shape, n);
+        bench::report("sort", shape, "merge", n,
+                      time_sort<sjtu::list<int>>(input, [](sjtu::list<int> &l) { l.sort(); }));
+        bench::report("sort", shape, "legacy_quick", n,
+                      time_sort<legacy_list>(input, [](legacy_list &l) { l.legacy_sort(); }));
+        bench::report("sort", shape, "std", n,
+                      time_sort<std::list<int>>(input, [](std::list<int> &l) { l.sort(); }));
+    }
+    return 0;
+}
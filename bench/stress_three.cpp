@@ -0,0 +1,143 @@
+/*
+ * Timing of the data/three stress workloads (push/pop, iterator walks,
+ * positional insert/erase, sort, unique, merge, reverse) on the testers'
+ * Int payload, for sjtu::list (global heap and shared arena) against std::list.
+ *
+ * usage: list_three_bench [n]
+ */
+#include "bench.hpp"
+#include "list.hpp"
+
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+class Int {
+public:
+    static int born;
+    static int dead;
+    int val;
+    Int(int val) : val(val) { born++; }
+    Int(const Int &rhs) : val(rhs.val) { born++; }
+    Int &operator=(const Int &rhs) { born++; dead++; val = rhs.val; return *this; }
+    bool operator==(const Int &rhs) const { return val == rhs.val; }
+    bool operator!=(const Int &rhs) const { return val != rhs.val; }
+    friend bool operator<(const Int &lhs, const Int &rhs) { return lhs.val > rhs.val; }
+    ~Int() { dead++; }
+};
+
+int Int::born = 0;
+int Int::dead = 0;
+
+static std::vector<int> raw;
+
+/**
+ * sjtu::list drawing every node from one arena shared by all instances
+ */
+struct arena_list : sjtu::list<Int> {
+    static arena_type &shared() {
+        static arena_type arena;
+        return arena;
+    }
+    arena_list() : sjtu::list<Int>(shared()) {}
+};
+
+template<typename List>
+void push_pop(size_t n) {
+    List l;
+    for (size_t i = 0; i < n; ++i) {
+        if (raw[i] & 1) l.push_back(Int(raw[i]));
+        else l.push_front(Int(raw[i]));
+    }
+    for (size_t i = 0; i < n / 2; ++i) {
+        if (raw[i] & 2) l.pop_back();
+        else l.pop_front();
+    }
+    bench::keep(l.size());
+}
+
+template<typename List>
+void walk(size_t n) {
+    List l;
+    for (size_t i = 0; i < n; ++i) l.push_back(Int(raw[i]));
+    long long sum = 0;
+    for (int round = 0; round < 10; ++round)
+        for (auto it = l.begin(); it != l.end(); ++it) sum += it->val;
+    bench::keep(sum);
+}
+
+/**
+ * equal()-style scan of a list small enough to stay in cache,
+ * so the cost per iterator step dominates
+ */
+template<typename List>
+void walk_hot(size_t n) {
+    List l;
+    for (size_t i = 0; i < 512; ++i) l.push_back(Int(raw[i % n]));
+    long long sum = 0;
+    for (size_t round = 0; round < n / 100; ++round)
+        for (auto it = l.begin(); it != l.end(); ++it) sum += (*it).val;
+    bench::keep(sum);
+}
+
+template<typename List>
+void insert_erase(size_t n) {
+    List l;
+    auto it = l.end();
+    for (size_t i = 0; i < n; ++i) {
+        it = l.insert(it, Int(raw[i]));
+        size_t gap = raw[i] % l.size();
+        it = l.begin();
+        for (size_t j = 0; j < gap; ++j) ++it;
+    }
+    for (size_t i = 0; i < n / 2; ++i) {
+        size_t gap = raw[i] % l.size();
+        it = l.begin();
+        for (size_t j = 0; j < gap; ++j) ++it;
+        l.erase(it);
+    }
+    bench::keep(l.size());
+}
+
+template<typename List>
+void sort_unique(size_t n) {
+    List l;
+    for (size_t i = 0; i < n; ++i) l.push_back(Int(raw[i] % (n / 4 + 1)));
+    l.sort();
+    l.unique();
+    bench::keep(l.size());
+}
+
+template<typename List>
+void merge_reverse(size_t n) {
+    List a, b;
+    for (size_t i = 0; i < n; ++i) {
+        if (raw[i] & 1) a.push_back(Int(n - i));
+        else b.push_back(Int(n - i));
+    }
+    a.merge(b);
+    for (int round = 0; round < 10; ++round) a.reverse();
+    bench::keep(a.size());
+}
+
+template<typename List>
+void run(const char *impl, size_t n) {
+    bench::report("three", "push_pop", impl, n, bench::best_ms([n] { push_pop<List>(n); }));
+    bench::report("three", "walk", impl, n, bench::best_ms([n] { walk<List>(n); }));
+    bench::report("three", "walk_hot", impl, n / 100 * 512, bench::best_ms([n] { walk_hot<List>(n); }));
+    bench::report("three", "insert_erase", impl, n / 20,
+                  bench::best_ms([n] { insert_erase<List>(n / 20); }));
+    bench::report("three", "sort_unique", impl, n, bench::best_ms([n] { sort_unique<List>(n); }));
+    bench::report("three", "merge_reverse", impl, n, bench::best_ms([n] { merge_reverse<List>(n); }));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+    srand(2022);
+    for (size_t i = 0; i < n; ++i) raw.push_back((rand() << 15) + rand());
+    bench::header();
+    run<sjtu::list<Int>>("sjtu", n);
+    run<arena_list>("sjtu_arena", n);
+    run<std::list<Int>>("std", n);
+    return 0;
+}
@@ -0,0 +1,307 @@
+#ifndef SJTU_CHAIN_HPP
+#define SJTU_CHAIN_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace sjtu {
+/**
+ * the relinking algorithms shared by list, indexed_list and intrusive_list.
+ * they work on a circular doubly linked chain through a sentinel head, over any Link type
+ * with next and prev members pointing to Link; value(link) is the element a link stands for.
+ * no element is ever copied or moved, only links are rewritten.
+ */
+namespace chain_detail {
+
+/**
+ * a detached chain of links from first to last, linked in both directions
+ */
+template<typename Link>
+struct run {
+    Link *first = nullptr, *last = nullptr;
+};
+
+/**
+ * link a chain ending with nullptr to the back of the chain of head
+ */
+template<typename Link>
+void append(Link *head, Link *cur) {
+    while (cur) {
+        Link *nxt = cur->next;
+        cur->prev = head->prev;
+        cur->next = head;
+        head->prev->next = cur;
+        head->prev = cur;
+        cur = nxt;
+    }
+}
+
+/**
+ * merge the sorted chains a..a_last and b..b_last (their last next is nullptr)
+ * behind tail, taking from a on ties; return the last link of the merged chain.
+ * if cmp throws, the rest of a and then of b are linked unmerged, ending with nullptr.
+ */
+template<typename Link, typename Value, typename Compare>
+Link *merge_chains(Link *tail, Link *a, Link *a_last, Link *b, Link *b_last, Value value, Compare &cmp) {
+    try {
+        while (a && b) {
+            if (cmp(value(b), value(a))) {
+                b->prev = tail; tail->next = b; tail = b; b = b->next;
+            } else {
+                a->prev = tail; tail->next = a; tail = a; a = a->next;
+            }
+        }
+    } catch (...) {
+        if (a) { a->prev = tail; tail->next = a; tail = a_last; }
+        if (b) { b->prev = tail; tail->next = b; tail = b_last; }
+        tail->next = nullptr;
+        throw;
+    }
+    if (a) { a->prev = tail; tail->next = a; return a_last; }
+    if (b) { b->prev = tail; tail->next = b; return b_last; }
+    tail->next = nullptr;
+    return tail;
+}
+
+/**
+ * stable bottom-up merge sort of the chain of head, which holds at least one link:
+ * O(n log n) comparisons and O(1) extra memory.
+ * head, out of the chain meanwhile, is the anchor every merge links behind, so that no
+ * Link (a whole node with its value for list) is made on the stack.
+ * if cmp throws, every link is back in the chain but their order is unspecified.
+ */
+template<typename Link, typename Value, typename Compare>
+void sort(Link *head, Value value, Compare &cmp) {
+    // pending[k] holds a sorted run of 2^k links, higher levels hold earlier elements
+    run<Link> pending[64];
+    size_t levels = 0;
+    run<Link> carry, acc;
+    Link *rest = head->next;
+    head->prev->next = nullptr;
+    head->next = head->prev = head;
+    try {
+        while (rest) {
+            carry.first = carry.last = rest;
+            rest = rest->next;
+            carry.first->next = nullptr;
+            size_t k = 0;
+            for (; k < levels && pending[k].first; ++k) {
+                run<Link> a = pending[k], b = carry;
+                pending[k].first = carry.first = nullptr;
+                carry.last = merge_chains(head, a.first, a.last, b.first, b.last, value, cmp);
+                carry.first = head->next;
+                head->next = head;
+            }
+            pending[k] = carry;
+            carry.first = nullptr;
+            if (k == levels) ++levels;
+        }
+        for (size_t k = 0; k < levels; ++k) {
+            if (!pending[k].first) continue;
+            if (!acc.first) {
+                acc = pending[k];
+            } else {
+                run<Link> a = pending[k], b = acc;
+                pending[k].first = acc.first = nullptr;
+                acc.last = merge_chains(head, a.first, a.last, b.first, b.last, value, cmp);
+                acc.first = head->next;
+                head->next = head;
+            }
+            pending[k].first = nullptr;
+        }
+    } catch (...) {
+        // put every link back, in whatever order they are now
+        Link *merging = head->next == head ? nullptr : head->next;
+        head->next = head->prev = head;
+        append(head, merging);
+        append(head, carry.first);
+        append(head, acc.first);
+        for (size_t k = 0; k < levels; ++k) append(head, pending[k].first);
+        append(head, rest);
+        throw;
+    }
+    head->next = acc.first;
+    acc.first->prev = head;
+    acc.last->next = head;
+    head->prev = acc.last;
+}
+
+/**
+ * merge the sorted chain of other, which holds at least one link, into the sorted chain
+ * of head; other is left empty. if cmp throws, every link is in the chain of head.
+ */
+template<typename Link, typename Value, typename Compare>
+void merge_into(Link *head, Link *other, Value value, Compare &cmp) {
+    Link *a = nullptr, *a_last = nullptr;
+    if (head->next != head) {
+        a = head->next, a_last = head->prev;
+        a_last->next = nullptr;
+    }
+    Link *b = other->next, *b_last = other->prev;
+    b_last->next = nullptr;
+    head->next = head->prev = head;
+    other->next = other->prev = other;
+    Link *tail;
+    try {
+        tail = merge_chains(head, a, a_last, b, b_last, value, cmp);
+    } catch (...) {
+        tail = head;
+        while (tail->next) tail = tail->next;
+        tail->next = head;
+        head->prev = tail;
+        throw;
+    }
+    tail->next = head;
+    head->prev = tail;
+}
+
+/**
+ * a k-way merge of sorted chains: a tournament (winner) tree over their fronts, where taking
+ * a link replays the matches on its path to the root, O(log k) comparisons per link.
+ * the memory is taken by the constructor, so add() cannot throw and merge_into() throws
+ * only what cmp throws.
+ */
+template<typename Link>
+class tournament {
+    std::vector<Link *> fronts, lasts;
+    // tree[1] is the winner, the leaves sit at [leaves, 2 leaves); index fronts.size() is a bye
+    std::vector<size_t> tree;
+    size_t leaves = 1;
+
+    template<typename Value, typename Compare>
+    size_t play(size_t a, size_t b, Value &value, Compare &cmp) const {
+        size_t bye = fronts.size();
+        if (a == bye) return b;
+        if (b == bye) return a;
+        return cmp(value(fronts[b]), value(fronts[a])) ? b : a;
+    }
+    /**
+     * link the untaken rest of every chain behind tail, in the order they were added
+     */
+    Link *link_rest(Link *tail) {
+        for (size_t i = 0; i < fronts.size(); ++i) {
+            if (!fronts[i]) continue;
+            fronts[i]->prev = tail;
+            tail->next = fronts[i];
+            tail = lasts[i];
+        }
+        return tail;
+    }
+
+public:
+    /**
+     * room for the chains of k sentinels
+     */
+    explicit tournament(size_t k) {
+        fronts.reserve(k);
+        lasts.reserve(k);
+        while (leaves < k) leaves <<= 1;
+        tree.resize(2 * leaves);
+    }
+    /**
+     * detach the sorted chain of head, leaving it empty; on ties, chains added earlier win
+     */
+    void add(Link *head) {
+        if (head->next == head) return;
+        fronts.push_back(head->next);
+        lasts.push_back(head->prev);
+        head->prev->next = nullptr;
+        head->next = head->prev = head;
+    }
+    /**
+     * merge every added chain into the empty chain of head.
+     * if cmp throws, every link is in the chain of head, in unspecified order.
+     */
+    template<typename Value, typename Compare>
+    void merge_into(Link *head, Value value, Compare &cmp) {
+        size_t k = fronts.size(), live = k;
+        Link *tail = head;
+        if (k == 2) {
+            // a single match: the two-way merge is cheaper than replaying the tree
+            try {
+                tail = merge_chains(head, fronts[0], lasts[0], fronts[1], lasts[1], value, cmp);
+            } catch (...) {
+                while (tail->next) tail = tail->next;
+                tail->next = head;
+                head->prev = tail;
+                throw;
+            }
+            tail->next = head;
+            head->prev = tail;
+            return;
+        }
+        try {
+            for (size_t i = 0; i < leaves; ++i) tree[leaves + i] = i < k ? i : k;
+            for (size_t i = leaves - 1; i; --i) tree[i] = play(tree[2 * i], tree[2 * i + 1], value, cmp);
+            // the last chain standing is linked whole
+            while (live > 1) {
+                size_t w = tree[1];
+                Link *cur = fronts[w];
+                cur->prev = tail;
+                tail->next = cur;
+                tail = cur;
+                fronts[w] = cur->next;
+                if (!fronts[w]) tree[leaves + w] = k, --live;
+                for (size_t i = (leaves + w) >> 1; i; i >>= 1)
+                    tree[i] = play(tree[2 * i], tree[2 * i + 1], value, cmp);
+            }
+        } catch (...) {
+            tail = link_rest(tail);
+            tail->next = head;
+            head->prev = tail;
+            throw;
+        }
+        tail = link_rest(tail);
+        tail->next = head;
+        head->prev = tail;
+    }
+};
+
+/**
+ * reverse the chain of head in place
+ */
+template<typename Link>
+void reverse(Link *head) {
+    Link *cur = head;
+    do {
+        Link *tmp = cur->next;
+        cur->next = cur->prev;
+        cur->prev = tmp;
+        cur = tmp;
+    } while (cur != head);
+}
+
+/**
+ * hand every link but the first of each group of consecutive links for which
+ * pred(value(first of the group), value(link)) holds to drop, which unlinks it
+ */
+template<typename Link, typename Value, typename BinaryPredicate, typename Drop>
+void unique(Link *head, Value value, BinaryPredicate &pred, Drop drop) {
+    Link *cur = head->next;
+    while (cur != head && cur->next != head) {
+        if (pred(value(cur), value(cur->next))) drop(cur->next);
+        else cur = cur->next;
+    }
+}
+
+/**
+ * hand every link for which pred(value(link)) holds to drop, which unlinks it;
+ * return how many there were
+ */
+template<typename Link, typename Value, typename Predicate, typename Drop>
+size_t remove_if(Link *head, Value value, Predicate &pred, Drop drop) {
+    size_t cnt = 0;
+    for (Link *cur = head->next, *nxt; cur != head; cur = nxt) {
+        nxt = cur->next;
+        if (!pred(value(cur))) continue;
+        drop(cur);
+        ++cnt;
+    }
+    return cnt;
+}
+
+}
+
+}
+
+#endif //SJTU_CHAIN_HPP
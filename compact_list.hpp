@@ -0,0 +1,928 @@
+#ifndef SJTU_COMPACT_LIST_HPP
+#define SJTU_COMPACT_LIST_HPP
+
+#include "exceptions.hpp"
+#include "algorithm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * same iterator checking policy as list.hpp: define SJTU_LIST_UNCHECKED to drop the checks
+ */
+#ifdef SJTU_LIST_UNCHECKED
+#define SJTU_COMPACT_CHECK(cond) ((void)0)
+#else
+#define SJTU_COMPACT_CHECK(cond) do { if (cond) throw invalid_iterator(__func__); } while (0)
+#endif
+
+namespace sjtu {
+/**
+ * the slots of compact_list: nodes linked by 32-bit indices instead of pointers.
+ * slots are carved from chunks whose size doubles, the first holding 16, and never move,
+ * so an index maps to its slot in O(1) and references to elements stay valid.
+ * freed slots go onto a free list chained through next and are reused before a new chunk
+ * is taken; memory goes back to the system when the pool is destroyed.
+ * a pool may be shared by several lists but is not thread-safe.
+ */
+template<typename T>
+class compact_pool {
+public:
+    typedef uint32_t index;
+    static constexpr index nil = 0xffffffffu;
+    /**
+     * the element lives in raw storage after the links: 12 bytes for an int
+     */
+    struct slot {
+        index next, prev;
+        alignas(T) unsigned char storage[sizeof(T)];
+        T *val() { return reinterpret_cast<T *>(storage); }
+        const T *val() const { return reinterpret_cast<const T *>(storage); }
+    };
+
+private:
+    static constexpr unsigned first_log = 4;
+    // 16 (2^28 - 1) slots in all, so that every index is below nil
+    static constexpr unsigned max_chunks = 28;
+
+    slot *chunks[max_chunks] = {};
+    unsigned chunk_cnt = 0;
+    size_t used = 0; // slots ever handed out, the free ones included
+    index free_list = nil;
+
+    void grow() {
+        if (chunk_cnt == max_chunks) throw runtime_error(__func__);
+        chunks[chunk_cnt] = new slot[(size_t)1 << (first_log + chunk_cnt)];
+        ++chunk_cnt;
+    }
+
+public:
+    compact_pool() = default;
+    compact_pool(const compact_pool &) = delete;
+    compact_pool &operator=(const compact_pool &) = delete;
+    ~compact_pool() {
+        for (unsigned k = 0; k < chunk_cnt; ++k) delete [] chunks[k];
+    }
+
+    /**
+     * the slot of index i: chunk k starts at index 16 (2^k - 1)
+     */
+    slot &operator[](index i) const {
+        size_t j = (size_t)i + ((size_t)1 << first_log);
+        size_t k = search_detail::floor_log2(j) - first_log;
+        return chunks[k][j - ((size_t)1 << (first_log + k))];
+    }
+    /**
+     * a slot with unspecified links and no value
+     * throw runtime_error once 2^32 - 16 slots are in use
+     */
+    index allocate() {
+        if (free_list != nil) {
+            index i = free_list;
+            free_list = (*this)[i].next;
+            return i;
+        }
+        if (used == capacity()) grow();
+        return (index)used++;
+    }
+    void deallocate(index i) {
+        (*this)[i].next = free_list;
+        free_list = i;
+    }
+    /**
+     * give back a whole chain of slots, linked from first to last through next, in O(1)
+     */
+    void deallocate_chain(index first, index last) {
+        (*this)[last].next = free_list;
+        free_list = first;
+    }
+    /**
+     * the number of slots in the chunks taken so far
+     */
+    size_t capacity() const { return ((size_t)1 << first_log) * (((size_t)1 << chunk_cnt) - 1); }
+};
+
+/**
+ * a data container with the interface of sjtu::list for small elements and tight memory:
+ * the nodes are slots of a compact_pool linked by 32-bit indices, so a node of ints costs
+ * 12 bytes where a list node costs 24 plus the heap's own overhead, and nodes allocated
+ * together sit next to each other. a list holds at most 2^32 - 17 elements.
+ * by default a list has a pool of its own. lists built on one shared arena relink their
+ * nodes between each other as list does; between lists with pools of their own, splice
+ * and merge move the elements into the pool of the receiving list instead (they are copied
+ * if their move may throw) and iterators to them are invalidated.
+ * an iterator is a pool pointer (its list when checked) and an index.
+ */
+template<typename T>
+class compact_list {
+public:
+    /**
+     * slots that several lists may share; the arena must outlive them
+     */
+    typedef compact_pool<T> arena_type;
+
+protected:
+    typedef typename arena_type::index index;
+    typedef typename arena_type::slot slot;
+    static constexpr index nil = arena_type::nil;
+
+    arena_type *pool = nullptr;
+    bool owns_pool = false; // the pool was made with the list and goes with it
+    index head = nil; // the sentinel, a slot whose value is never constructed
+    size_t sz = 0;
+
+    slot &at(index i) const { return (*pool)[i]; }
+    T *val(index i) const { return at(i).val(); }
+
+    index get_node() { return pool->allocate(); }
+    void put_node(index i) { pool->deallocate(i); }
+    template<typename... Args>
+    index new_node(Args &&... args) {
+        index cur = get_node();
+        try {
+            new (val(cur)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            put_node(cur);
+            throw;
+        }
+        return cur;
+    }
+    void delete_node(index cur) {
+        val(cur)->~T();
+        put_node(cur);
+    }
+
+    /**
+     * insert node cur before node pos, return cur
+     */
+    index insert(index pos, index cur) {
+        slot &p = at(pos), &c = at(cur);
+        c.prev = p.prev;
+        c.next = pos;
+        at(p.prev).next = cur;
+        p.prev = cur;
+        ++sz;
+        return cur;
+    }
+    /**
+     * remove node pos from the list (no need to delete the node), return pos
+     */
+    index erase(index pos) {
+        slot &p = at(pos);
+        at(p.prev).next = p.next;
+        at(p.next).prev = p.prev;
+        p.prev = p.next = nil;
+        --sz;
+        return pos;
+    }
+    /**
+     * insert the chain of n nodes from first to last (linked through next) before node pos
+     */
+    void insert(index pos, index first, index last, size_t n) {
+        slot &p = at(pos);
+        at(first).prev = p.prev;
+        at(last).next = pos;
+        at(p.prev).next = first;
+        p.prev = last;
+        sz += n;
+    }
+    /**
+     * remove the n nodes from first to last from the list, they stay linked to each other
+     */
+    void erase(index first, index last, size_t n) {
+        slot &f = at(first), &l = at(last);
+        at(f.prev).next = l.next;
+        at(l.next).prev = f.prev;
+        f.prev = l.next = nil;
+        sz -= n;
+    }
+
+    struct less {
+        bool operator()(const T &a, const T &b) const { return a < b; }
+    };
+    struct equal_to {
+        bool operator()(const T &a, const T &b) const { return a == b; }
+    };
+    /**
+     * a detached chain of nodes from first to last, linked in both directions, last->next is nil
+     */
+    struct run {
+        index first = nil, last = nil;
+    };
+    void chain_push(run &c, index cur) {
+        if (c.first != nil) {
+            at(c.last).next = cur;
+            at(cur).prev = c.last;
+        } else {
+            c.first = cur;
+        }
+        at(cur).next = nil;
+        c.last = cur;
+    }
+    /**
+     * link the detached chain from first to last behind c, first may be nil
+     */
+    void chain_append(run &c, index first, index last) {
+        if (first == nil) return;
+        if (c.first != nil) {
+            at(c.last).next = first;
+            at(first).prev = c.last;
+        } else {
+            c.first = first;
+        }
+        c.last = last;
+    }
+    /**
+     * link a chain ending with nil to the back of the list, its nodes are already counted in sz
+     */
+    void append_chain(index cur) {
+        while (cur != nil) {
+            index nxt = at(cur).next;
+            insert(head, cur);
+            --sz;
+            cur = nxt;
+        }
+    }
+    void release_chain(index cur) {
+        while (cur != nil) {
+            index nxt = at(cur).next;
+            delete_node(cur);
+            cur = nxt;
+        }
+    }
+    template<typename InputIt>
+    run build_chain(InputIt first, InputIt last, size_t &n) {
+        run c;
+        n = 0;
+        try {
+            for (; first != last; ++first, ++n) chain_push(c, new_node(*first));
+        } catch (...) {
+            release_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+    run build_chain(size_t n, const T &value) {
+        run c;
+        try {
+            for (size_t i = 0; i < n; ++i) chain_push(c, new_node(value));
+        } catch (...) {
+            release_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+    /**
+     * link a detached chain of n nodes before pos, return its first node or pos if it is empty
+     */
+    index link_chain(index pos, run c, size_t n) {
+        if (!n) return pos;
+        insert(pos, c.first, c.last, n);
+        return c.first;
+    }
+    /**
+     * release the nodes from cur to the back of the list
+     */
+    void erase_tail(index cur) {
+        if (cur == head) return;
+        index last = at(head).prev;
+        size_t n = 0;
+        for (index p = cur; p != head; p = at(p).next) ++n;
+        erase(cur, last, n);
+        release_chain(cur);
+    }
+    /**
+     * the sentinel of an empty list, and a pool of its own if it has none
+     */
+    void init() {
+        bool made = !pool;
+        if (made) {
+            pool = new arena_type();
+            owns_pool = true;
+        }
+        try {
+            head = get_node();
+        } catch (...) {
+            if (made) { delete pool; pool = nullptr; owns_pool = false; }
+            throw;
+        }
+        at(head).next = at(head).prev = head;
+        sz = 0;
+    }
+    template<typename... Args>
+    void init_from(Args &&... args) {
+        init();
+        try {
+            size_t n;
+            run c = make_chain(n, std::forward<Args>(args)...);
+            link_chain(head, c, n);
+        } catch (...) {
+            destroy();
+            throw;
+        }
+    }
+    template<typename InputIt>
+    run make_chain(size_t &n, InputIt first, InputIt last) { return build_chain(first, last, n); }
+    run make_chain(size_t &n, size_t count, const T &value) { n = count; return build_chain(count, value); }
+    /**
+     * release every node and the pool if it is ours; a private pool of trivially
+     * destructible elements is freed whole without walking the chain
+     */
+    void destroy() {
+        if (!owns_pool || !std::is_trivially_destructible<T>::value) clear();
+        if (owns_pool) delete pool;
+        else if (head != nil) put_node(head);
+        pool = nullptr;
+        owns_pool = false;
+        head = nil;
+        sz = 0;
+    }
+    /**
+     * read-only walk over the values of a node chain
+     */
+    struct value_walker {
+        const compact_list *l;
+        index p;
+        const T & operator*() const { return *(l->val(p)); }
+        value_walker & operator++() { p = l->at(p).next; return *this; }
+        bool operator!=(const value_walker &rhs) const { return p != rhs.p; }
+    };
+    template<typename InputIt>
+    void assign_range(InputIt first, InputIt last) {
+        if (head == nil) init();
+        index cur = at(head).next;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; cur != head && first != last; cur = at(cur).next, ++first) *(val(cur)) = *first;
+        }
+        erase_tail(cur);
+        size_t n;
+        run c = build_chain(first, last, n);
+        link_chain(head, c, n);
+    }
+    /**
+     * cut the n nodes from first to last out of other as a chain that can be linked into *this:
+     * the nodes themselves when both lists share a pool, otherwise new nodes of this pool
+     * holding the elements moved (copied if their move may throw) out of other's nodes.
+     * if a copy throws, other is unchanged
+     */
+    run take(compact_list &other, index first, index last, size_t n) {
+        if (pool != other.pool) {
+            run c;
+            try {
+                for (index cur = first;; cur = other.at(cur).next) {
+                    chain_push(c, new_node(std::move_if_noexcept(*(other.val(cur)))));
+                    if (cur == last) break;
+                }
+            } catch (...) {
+                release_chain(c.first);
+                throw;
+            }
+            other.erase(first, last, n);
+            other.release_chain(first);
+            return c;
+        }
+        other.erase(first, last, n);
+        return run{first, last};
+    }
+    /**
+     * merge the sorted detached chains a and b into out, taking from a on ties.
+     * if cmp throws, out holds every node, the rest of a and then of b unmerged
+     */
+    template<typename Compare>
+    void merge_runs(run &out, run a, run b, Compare &cmp) {
+        out = run();
+        index x = a.first, y = b.first;
+        try {
+            while (x != nil && y != nil) {
+                if (cmp(*(val(y)), *(val(x)))) {
+                    index nxt = at(y).next;
+                    chain_push(out, y);
+                    y = nxt;
+                } else {
+                    index nxt = at(x).next;
+                    chain_push(out, x);
+                    x = nxt;
+                }
+            }
+        } catch (...) {
+            chain_append(out, x, a.last);
+            chain_append(out, y, b.last);
+            throw;
+        }
+        chain_append(out, x, a.last);
+        chain_append(out, y, b.last);
+    }
+    template<typename InputIt>
+    using if_iterator = typename std::enable_if<!std::is_integral<InputIt>::value>::type;
+
+public:
+    class const_iterator;
+    class iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        compact_list *owner = nullptr;
+        slot &node() const { return owner->at(idx); }
+#else
+        arena_type *pool = nullptr;
+        slot &node() const { return (*pool)[idx]; }
+#endif
+        index idx = nil;
+        friend class const_iterator;
+        friend class compact_list;
+    public:
+        iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        iterator(compact_list *o, index i) : owner(o), idx(i) {}
+#else
+        iterator(compact_list *o, index i) : pool(o->pool), idx(i) {}
+#endif
+        iterator operator++(int) {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            iterator tmp = *this;
+            idx = node().next;
+            return tmp;
+        }
+        iterator & operator++() {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            idx = node().next;
+            return *this;
+        }
+        iterator operator--(int) {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || node().prev == owner->head);
+            iterator tmp = *this;
+            idx = node().prev;
+            return tmp;
+        }
+        iterator & operator--() {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || node().prev == owner->head);
+            idx = node().prev;
+            return *this;
+        }
+        T & operator *() const {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            return *(node().val());
+        }
+        T * operator ->() const {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            return node().val();
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && idx == rhs.idx; }
+#else
+        bool operator==(const iterator &rhs) const { return pool == rhs.pool && idx == rhs.idx; }
+#endif
+        bool operator==(const const_iterator &rhs) const { return rhs == *this; }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator &rhs) const { return !(rhs == *this); }
+    };
+    class const_iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        const compact_list *owner = nullptr;
+        const slot &node() const { return owner->at(idx); }
+#else
+        const arena_type *pool = nullptr;
+        const slot &node() const { return (*pool)[idx]; }
+#endif
+        index idx = nil;
+        friend class iterator;
+        friend class compact_list;
+    public:
+        const_iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        const_iterator(const compact_list *o, index i) : owner(o), idx(i) {}
+        const_iterator(const iterator &it) : owner(it.owner), idx(it.idx) {}
+#else
+        const_iterator(const compact_list *o, index i) : pool(o->pool), idx(i) {}
+        const_iterator(const iterator &it) : pool(it.pool), idx(it.idx) {}
+#endif
+        const_iterator operator++(int) {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            const_iterator tmp = *this;
+            idx = node().next;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            idx = node().next;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || node().prev == owner->head);
+            const_iterator tmp = *this;
+            idx = node().prev;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || node().prev == owner->head);
+            idx = node().prev;
+            return *this;
+        }
+        const T & operator *() const {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            return *(node().val());
+        }
+        const T * operator ->() const {
+            SJTU_COMPACT_CHECK(!owner || idx == nil || idx == owner->head);
+            return node().val();
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && idx == rhs.idx; }
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && idx == rhs.idx; }
+#else
+        bool operator==(const const_iterator &rhs) const { return pool == rhs.pool && idx == rhs.idx; }
+        bool operator==(const iterator &rhs) const { return pool == rhs.pool && idx == rhs.idx; }
+#endif
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+    };
+
+    compact_list() { init(); }
+    /**
+     * a list whose slots (sentinel included) are drawn from arena.
+     * the arena must outlive the list.
+     */
+    explicit compact_list(arena_type &arena) : pool(&arena) { init(); }
+    /**
+     * the copy shares the arena of other, or has a pool of its own
+     */
+    compact_list(const compact_list &other) : pool(other.owns_pool ? nullptr : other.pool) {
+        init_from(value_walker{&other, other.at(other.head).next}, value_walker{&other, other.head});
+    }
+    compact_list(size_t n, const T &value) { init_from(n, value); }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    compact_list(InputIt first, InputIt last) { init_from(first, last); }
+    compact_list(std::initializer_list<T> values) { init_from(values.begin(), values.end()); }
+    /**
+     * steal the pool and sentinel of other, no element is touched.
+     * other gets a fresh sentinel, from its arena or a new pool of its own, and stays a valid
+     * empty list; std::terminate is called should allocating them fail.
+     */
+    compact_list(compact_list &&other) noexcept
+        : pool(other.pool), owns_pool(other.owns_pool), head(other.head), sz(other.sz) {
+        if (other.owns_pool) other.pool = nullptr;
+        other.owns_pool = false;
+        other.init();
+    }
+    ~compact_list() { destroy(); }
+    compact_list &operator=(const compact_list &other) {
+        if (this == &other) return *this;
+        assign_range(value_walker{&other, other.at(other.head).next}, value_walker{&other, other.head});
+        return *this;
+    }
+    compact_list &operator=(compact_list &&other) noexcept {
+        if (this == &other) return *this;
+        std::swap(pool, other.pool);
+        std::swap(owns_pool, other.owns_pool);
+        std::swap(head, other.head);
+        std::swap(sz, other.sz);
+        return *this;
+    }
+    compact_list &operator=(std::initializer_list<T> values) {
+        assign_range(values.begin(), values.end());
+        return *this;
+    }
+    /**
+     * replace the contents, existing nodes are reused by assigning over their values
+     */
+    void assign(size_t n, const T &value) {
+        if (head == nil) init();
+        index cur = at(head).next;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; cur != head && n; cur = at(cur).next, --n) *(val(cur)) = value;
+        }
+        erase_tail(cur);
+        link_chain(head, build_chain(n, value), n);
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    void assign(InputIt first, InputIt last) { assign_range(first, last); }
+    void assign(std::initializer_list<T> values) { assign_range(values.begin(), values.end()); }
+    /**
+     * access the first / last element
+     * throw container_is_empty when the container is empty.
+     */
+    const T & front() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return *(val(at(head).next));
+    }
+    const T & back() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return *(val(at(head).prev));
+    }
+    iterator begin() { return iterator(this, at(head).next); }
+    const_iterator cbegin() const { return const_iterator(this, at(head).next); }
+    iterator end() { return iterator(this, head); }
+    const_iterator cend() const { return const_iterator(this, head); }
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+    /**
+     * the shared arena of the list, nullptr if its pool is its own
+     */
+    arena_type *arena() const { return owns_pool ? nullptr : pool; }
+
+    /**
+     * clears the contents; trivially destructible elements go back to the pool in O(1)
+     */
+    void clear() {
+        if (head == nil) return;
+        if (std::is_trivially_destructible<T>::value && sz) {
+            pool->deallocate_chain(at(head).next, at(head).prev);
+        } else {
+            index cur = at(head).next;
+            while (cur != head) {
+                index nxt = at(cur).next;
+                delete_node(cur);
+                cur = nxt;
+            }
+        }
+        at(head).next = at(head).prev = head;
+        sz = 0;
+    }
+    /**
+     * insert value before pos (pos may be the end() iterator)
+     * return an iterator pointing to the inserted value
+     * throw if the iterator is invalid
+     */
+    iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+    iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+    /**
+     * insert n copies of value, or [first, last), before pos as one chain linked at once;
+     * return an iterator to the first inserted element, or pos if none is
+     */
+    iterator insert(iterator pos, size_t n, const T &value) {
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil);
+        return iterator(this, link_chain(pos.idx, build_chain(n, value), n));
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    iterator insert(iterator pos, InputIt first, InputIt last) {
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil);
+        size_t n;
+        run c = build_chain(first, last, n);
+        return iterator(this, link_chain(pos.idx, c, n));
+    }
+    iterator insert(iterator pos, std::initializer_list<T> values) {
+        return insert(pos, values.begin(), values.end());
+    }
+    template<typename... Args>
+    iterator emplace(iterator pos, Args &&... args) {
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil);
+        index cur = new_node(std::forward<Args>(args)...);
+        insert(pos.idx, cur);
+        return iterator(this, cur);
+    }
+    /**
+     * remove the element at pos (the end() iterator is invalid)
+     * returns an iterator pointing to the following element, if pos pointing to the last element, end() will be returned.
+     * throw if the container is empty, the iterator is invalid
+     */
+    iterator erase(iterator pos) {
+        if (sz == 0) throw container_is_empty(__func__);
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil || pos.idx == head);
+        index nxt = at(pos.idx).next;
+        delete_node(erase(pos.idx));
+        return iterator(this, nxt);
+    }
+    void push_back(const T &value) { insert(end(), value); }
+    void push_back(T &&value) { insert(end(), std::move(value)); }
+    template<typename... Args>
+    T & emplace_back(Args &&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+    void pop_back() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, at(head).prev));
+    }
+    void push_front(const T &value) { insert(begin(), value); }
+    void push_front(T &&value) { insert(begin(), std::move(value)); }
+    template<typename... Args>
+    T & emplace_front(Args &&... args) { return *emplace(begin(), std::forward<Args>(args)...); }
+    void pop_front() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, at(head).next));
+    }
+    /**
+     * move all elements of other before pos, other becomes empty;
+     * O(1) on a shared arena, otherwise the elements move into this pool
+     * throw invalid_iterator if pos does not belong to *this,
+     * runtime_error if the two lists draw from different arenas
+     */
+    void splice(iterator pos, compact_list &other) {
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil);
+        if (this == &other || other.sz == 0) return;
+        if (arena() != other.arena()) throw runtime_error(__func__);
+        size_t n = other.sz;
+        run c = take(other, other.at(other.head).next, other.at(other.head).prev, n);
+        insert(pos.idx, c.first, c.last, n);
+    }
+    /**
+     * move the element at it from other before pos, other may be *this
+     */
+    void splice(iterator pos, compact_list &other, iterator it) {
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil);
+        SJTU_COMPACT_CHECK(it.owner != &other || it.idx == nil || it.idx == other.head);
+        if (arena() != other.arena()) throw runtime_error(__func__);
+        // indices of two pools may coincide: only within one list is pos == it a no-op
+        if (this == &other && (pos.idx == it.idx || pos.idx == at(it.idx).next)) return;
+        run c = take(other, it.idx, it.idx, 1);
+        insert(pos.idx, c.first, c.last, 1);
+    }
+    /**
+     * move the elements in [first, last) from other before pos, other may be *this
+     * (then pos shall not be inside the range)
+     * counting the moved elements is O(distance) unless other is *this
+     */
+    void splice(iterator pos, compact_list &other, iterator first, iterator last) {
+        SJTU_COMPACT_CHECK(pos.owner != this || pos.idx == nil);
+        SJTU_COMPACT_CHECK(first.owner != &other || last.owner != &other || first.idx == nil || last.idx == nil);
+        if (arena() != other.arena()) throw runtime_error(__func__);
+        if (first.idx == last.idx || (this == &other && (pos.idx == first.idx || pos.idx == last.idx))) return;
+        index tail = other.at(last.idx).prev;
+        size_t n = 0;
+        if (this != &other) {
+            for (index cur = first.idx; cur != last.idx; cur = other.at(cur).next) {
+                SJTU_COMPACT_CHECK(cur == other.head);
+                ++n;
+            }
+        }
+        run c = take(other, first.idx, tail, n);
+        insert(pos.idx, c.first, c.last, n);
+    }
+    /**
+     * sort the values in ascending order with operator< of T
+     */
+    void sort() { sort(less()); }
+    /**
+     * stable bottom-up merge sort relinking the indices, as list::sort:
+     * O(n log n) comparisons and O(1) extra memory.
+     * if cmp throws, every element is kept but their order is unspecified.
+     */
+    template<typename Compare>
+    void sort(Compare cmp) {
+        if (sz <= 1) return;
+        // pending[k] holds a sorted run of 2^k nodes, higher levels hold earlier elements
+        run pending[64];
+        size_t levels = 0;
+        run carry, acc;
+        index rest = at(head).next;
+        at(at(head).prev).next = nil;
+        at(head).next = at(head).prev = head;
+        try {
+            while (rest != nil) {
+                carry.first = carry.last = rest;
+                rest = at(rest).next;
+                at(carry.first).next = nil;
+                size_t k = 0;
+                for (; k < levels && pending[k].first != nil; ++k) {
+                    run a = pending[k], b = carry;
+                    pending[k] = run();
+                    merge_runs(carry, a, b, cmp);
+                }
+                pending[k] = carry;
+                carry = run();
+                if (k == levels) ++levels;
+            }
+            for (size_t k = 0; k < levels; ++k) {
+                if (pending[k].first == nil) continue;
+                run a = pending[k], b = acc;
+                pending[k] = run();
+                if (b.first == nil) acc = a;
+                else merge_runs(acc, a, b, cmp);
+            }
+        } catch (...) {
+            // put every node back, in whatever order they are now
+            append_chain(carry.first);
+            append_chain(acc.first);
+            for (size_t k = 0; k < levels; ++k) append_chain(pending[k].first);
+            append_chain(rest);
+            throw;
+        }
+        at(head).next = acc.first;
+        at(acc.first).prev = head;
+        at(acc.last).next = head;
+        at(head).prev = acc.last;
+    }
+    /**
+     * sort() on the threads of policy, as list::parallel_sort: the 32-bit indices
+     * are gathered into an array, sorted, and the list relinked from it.
+     * if cmp throws, the list is left as it was.
+     */
+    void parallel_sort(parallel_policy policy = parallel_policy()) { parallel_sort(less(), policy); }
+    template<typename Compare>
+    void parallel_sort(Compare cmp, parallel_policy policy = parallel_policy()) {
+        if (sz <= 1) return;
+        index *a = new index[sz];
+        size_t k = 0;
+        for (index cur = at(head).next; cur != head; cur = at(cur).next) a[k++] = cur;
+        try {
+            sjtu::parallel_stable_sort(a, a + sz, [this, &cmp](index x, index y) {
+                return cmp(*(val(x)), *(val(y)));
+            }, policy);
+        } catch (...) {
+            delete [] a;
+            throw;
+        }
+        index prev = head;
+        for (k = 0; k < sz; ++k) {
+            at(prev).next = a[k];
+            at(a[k]).prev = prev;
+            prev = a[k];
+        }
+        at(prev).next = head;
+        at(head).prev = prev;
+        delete [] a;
+    }
+    /**
+     * merge two sorted lists into one as list::merge, other becomes empty
+     * elements of *this precede equivalent elements of other
+     * throw runtime_error if the two lists draw from different arenas
+     */
+    void merge(compact_list &other) { merge(other, less()); }
+    template<typename Compare>
+    void merge(compact_list &other, Compare cmp) {
+        if (this == &other || other.sz == 0) return;
+        if (arena() != other.arena()) throw runtime_error(__func__);
+        size_t n = other.sz;
+        run b = take(other, other.at(other.head).next, other.at(other.head).prev, n);
+        run a;
+        if (sz) {
+            a.first = at(head).next, a.last = at(head).prev;
+            at(a.last).next = nil;
+        }
+        at(head).next = at(head).prev = head;
+        sz += n;
+        run out;
+        try {
+            merge_runs(out, a, b, cmp);
+        } catch (...) {
+            insert(head, out.first, out.last, 0);
+            throw;
+        }
+        insert(head, out.first, out.last, 0);
+    }
+    /**
+     * reverse the order of the elements, no elements are copied or moved
+     */
+    void reverse() {
+        if (sz <= 1) return;
+        index cur = head;
+        do {
+            slot &s = at(cur);
+            std::swap(s.next, s.prev);
+            cur = s.prev;
+        } while (cur != head);
+    }
+    void unique() { unique(equal_to()); }
+    /**
+     * same as unique(), an element is removed when pred(first of its group, element) holds
+     */
+    template<typename BinaryPredicate>
+    void unique(BinaryPredicate pred) {
+        if (sz <= 1) return;
+        index cur = at(head).next;
+        while (cur != head && at(cur).next != head) {
+            index nxt = at(cur).next;
+            if (pred(*(val(cur)), *(val(nxt)))) delete_node(erase(nxt));
+            else cur = nxt;
+        }
+    }
+    /**
+     * remove every element equal to value (operator== of T) in one pass
+     * value may refer to an element of the list itself
+     * return the number of removed elements
+     */
+    size_t remove(const T &value) {
+        index self = nil;
+        size_t cnt = 0;
+        for (index cur = at(head).next, nxt; cur != head; cur = nxt) {
+            nxt = at(cur).next;
+            if (!(*(val(cur)) == value)) continue;
+            if (val(cur) == &value) { self = cur; continue; }
+            delete_node(erase(cur));
+            ++cnt;
+        }
+        if (self != nil) {
+            delete_node(erase(self));
+            ++cnt;
+        }
+        return cnt;
+    }
+    template<typename Predicate>
+    size_t remove_if(Predicate pred) {
+        size_t cnt = 0;
+        for (index cur = at(head).next, nxt; cur != head; cur = nxt) {
+            nxt = at(cur).next;
+            if (!pred(*(val(cur)))) continue;
+            delete_node(erase(cur));
+            ++cnt;
+        }
+        return cnt;
+    }
+};
+
+}
+
+#undef SJTU_COMPACT_CHECK
+
+#endif //SJTU_COMPACT_LIST_HPP
@@ -0,0 +1,169 @@
+#ifndef SJTU_CONCURRENT_QUEUE_HPP
+#define SJTU_CONCURRENT_QUEUE_HPP
+
+#include "list.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+#error "concurrent_queue hands its nodes to the node-based sjtu::list, which SJTU_LIST_UNROLLED, SJTU_LIST_INDEXED and SJTU_LIST_COMPACT replace"
+#endif
+
+namespace sjtu {
+/**
+ * a FIFO queue that any number of threads may push to and pop from at once:
+ * the two-lock queue of Michael and Scott. producers only take the lock of the back
+ * and consumers only the lock of the front, so a producer never waits for a consumer.
+ * the front is a dummy node whose value is not constructed; a pop moves the value out
+ * of the node after it, and that node becomes the new dummy.
+ * the nodes are those of list<T>, linked both ways as they are pushed, so drain_into()
+ * and push_all() move any number of elements between a queue and a list by relinking.
+ * nodes come from the global heap: a list trading nodes with a queue must not use an arena.
+ */
+template<typename T>
+class concurrent_queue {
+    typedef typename list<T>::node node;
+
+    /**
+     * one end of the queue and its lock, on a cache line of its own,
+     * so that the two sides do not keep stealing one line from each other
+     */
+    struct alignas(64) end {
+        std::mutex lock;
+        node *ptr;
+    };
+    end front, back;
+    /**
+     * the number of elements, changed inside the lock of the end that is changed.
+     * a consumer reads it instead of the next link of the dummy, which a producer may be writing:
+     * a count above 0 published by a producer means the node after the dummy is linked.
+     */
+    std::atomic<size_t> count;
+
+    template<typename... Args>
+    static node *new_node(Args &&... args) {
+        node *cur = new node();
+        try {
+            new (cur->val()) T(std::forward<Args>(args)...);
+        } catch (...) {
+            delete cur;
+            throw;
+        }
+        return cur;
+    }
+    /**
+     * link the chain of n nodes from first to last (linked through next) at the back
+     */
+    void link_back(node *first, node *last, size_t n) {
+        std::lock_guard<std::mutex> guard(back.lock);
+        last->next = nullptr;
+        first->prev = back.ptr;
+        back.ptr->next = first;
+        back.ptr = last;
+        count.fetch_add(n, std::memory_order_release);
+    }
+
+public:
+    concurrent_queue() : count(0) {
+        front.ptr = back.ptr = new node();
+    }
+    concurrent_queue(const concurrent_queue &) = delete;
+    concurrent_queue &operator=(const concurrent_queue &) = delete;
+    /**
+     * no other thread may use the queue any more
+     */
+    ~concurrent_queue() {
+        node *cur = front.ptr->next;
+        delete front.ptr;
+        while (cur) {
+            node *nxt = cur->next;
+            cur->val()->~T();
+            delete cur;
+            cur = nxt;
+        }
+    }
+
+    /**
+     * the number of elements at some moment during the call; other threads may have changed it since
+     */
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * add an element at the back; the value is built before the lock is taken
+     */
+    void push(const T &value) { emplace(value); }
+    void push(T &&value) { emplace(std::move(value)); }
+    template<typename... Args>
+    void emplace(Args &&... args) {
+        node *cur = new_node(std::forward<Args>(args)...);
+        link_back(cur, cur, 1);
+    }
+    /**
+     * move every element of batch to the back in O(1), batch becomes empty;
+     * another producer's elements never end up between them.
+     * throw runtime_error if batch draws from an arena
+     */
+    void push_all(list<T> &batch) {
+        if (batch.pool) throw runtime_error(__func__);
+        if (batch.sz == 0) return;
+        batch.settle();
+        node *first = batch.head->next, *last = batch.head->prev;
+        size_t n = batch.sz;
+        batch.erase(first, last, n);
+        link_back(first, last, n);
+    }
+
+    /**
+     * move the front element into value and remove it, return false if the queue is empty.
+     * if the move assignment throws, the element stays in the queue
+     */
+    bool try_pop(T &value) {
+        node *old;
+        {
+            std::lock_guard<std::mutex> guard(front.lock);
+            if (count.load(std::memory_order_acquire) == 0) return false;
+            node *first = front.ptr->next;
+            value = std::move(*(first->val()));
+            first->val()->~T();
+            old = front.ptr;
+            front.ptr = first;
+            count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        delete old;
+        return true;
+    }
+    /**
+     * move every element to the back of out in O(1) and return how many there were.
+     * both locks are held only to cut the chain off; out is linked after they are released,
+     * so out must not be shared with other threads.
+     * throw runtime_error if out draws from an arena
+     */
+    size_t drain_into(list<T> &out) {
+        if (out.pool) throw runtime_error(__func__);
+        node *first, *last;
+        size_t n;
+        {
+            std::lock_guard<std::mutex> front_guard(front.lock);
+            std::lock_guard<std::mutex> back_guard(back.lock);
+            n = count.load(std::memory_order_relaxed);
+            if (n == 0) return 0;
+            first = front.ptr->next;
+            last = back.ptr;
+            front.ptr->next = nullptr;
+            back.ptr = front.ptr;
+            count.store(0, std::memory_order_relaxed);
+        }
+        out.settle();
+        out.insert(out.head, first, last, n);
+        return n;
+    }
+};
+
+}
+
+#endif //SJTU_CONCURRENT_QUEUE_HPP
@@ -7,29 +7,60 @@
 
 namespace Util {
 
-const size_t MIN_CAPACITY = 2048;
+// limbs kept inside the object before the first heap allocation
+const size_t SMALL_CAPACITY = 4;
+// every limb holds nine decimal digits
+const unsigned int BASE = 1000000000;
+const size_t BASE_DIGITS = 9;
+// below this many limbs in the shorter operand, schoolbook beats Karatsuba
+const size_t KARATSUBA_THRESHOLD = 24;
 
 class Bint {
-	class NewSpaceFailed : public std::runtime_error {
-	public:
-		NewSpaceFailed();
-	};
 	class BadCast : public std::invalid_argument {
 	public:
 		BadCast();
 	};
+	typedef unsigned int limb;
+	typedef unsigned long long wide;
 	bool isMinus = false;
 	size_t length;
-	int *data = nullptr;
-	size_t capacity = MIN_CAPACITY;
-	void _DoubleSpace();
-	void _SafeNewSpace(int *&p, const size_t &len);
+	// points at small until the value outgrows it
+	limb *data = small;
+	size_t capacity = SMALL_CAPACITY;
+	limb small[SMALL_CAPACITY];
+	// grow to at least len limbs, keeping the length live ones
+	void _Reserve(const size_t &len);
+	void _SetValue(long long x);
+	// take the value of the text [s, s + n), reusing the buffer; bad text leaves zero behind
+	void _Parse(const char *s, size_t n);
+	// drop zero top limbs and the sign of zero
+	void _Trim();
+	// zero with room for capa limbs to write a result into
 	explicit Bint(const size_t &capa);
+
+	/*
+	 * magnitude kernels on raw little-endian limb arrays; lengths are trimmed
+	 * unless stated otherwise, and r may alias an input wherever noted
+	 */
+	static int _CmpMag(const limb *a, size_t la, const limb *b, size_t lb);
+	// r = a + b with la >= lb, r may alias a or b, return the length of r
+	static size_t _AddMag(limb *r, const limb *a, size_t la, const limb *b, size_t lb);
+	// r = a - b with a >= b, r may alias a or b, return the trimmed length of r
+	static size_t _SubMag(limb *r, const limb *a, size_t la, const limb *b, size_t lb);
+	// r[0, lr) += a, the sum must fit in lr limbs
+	static void _AddInto(limb *r, size_t lr, const limb *a, size_t la);
+	// r[0, lr) -= a, r must not be smaller than a
+	static void _SubInto(limb *r, size_t lr, const limb *a, size_t la);
+	// r[0, la + lb) = a * b, r must not alias a or b
+	static void _MulSchool(limb *r, const limb *a, size_t la, const limb *b, size_t lb);
+	static void _Mul(limb *r, const limb *a, size_t la, const limb *b, size_t lb);
+	// result = a + b, or a - b when negate; a single carry pass
+	static void _Add(Bint &result, const Bint &a, const Bint &b, bool negate);
 public:
 	Bint();
 	Bint(int x);
 	Bint(long long x);
-	Bint(std::string x);
+	Bint(const std::string &x);
 	Bint(const Bint &b);
 	Bint(Bint &&b) noexcept;
 
@@ -38,6 +69,12 @@ public:
 	Bint &operator=(const Bint &rhs);
 	Bint &operator=(Bint &&rhs) noexcept;
 
+	// in place: += and -= grow the left operand's buffer only when the result outgrows it
+	Bint &operator+=(const Bint &rhs);
+	Bint &operator-=(const Bint &rhs);
+	// the product cannot overlap its operands, it is formed in a fresh buffer that replaces the old one
+	Bint &operator*=(const Bint &rhs);
+
 	friend Bint abs(const Bint &x);
 	friend Bint abs(Bint &&x);
 
@@ -48,14 +85,27 @@ public:
 	friend bool operator<=(const Bint &lhs, const Bint &rhs);
 	friend bool operator>=(const Bint &lhs, const Bint &rhs);
 
+	// an rvalue operand lends its buffer to the result
 	friend Bint operator+(const Bint &lhs, const Bint &rhs);
+	friend Bint operator+(Bint &&lhs, const Bint &rhs);
+	friend Bint operator+(const Bint &lhs, Bint &&rhs);
+	friend Bint operator+(Bint &&lhs, Bint &&rhs);
 	friend Bint operator-(const Bint &b);
 	friend Bint operator-(Bint &&b);
 	friend Bint operator-(const Bint &lhs, const Bint &rhs);
+	friend Bint operator-(Bint &&lhs, const Bint &rhs);
+	friend Bint operator-(const Bint &lhs, Bint &&rhs);
+	friend Bint operator-(Bint &&lhs, Bint &&rhs);
 	friend Bint operator*(const Bint &lhs, const Bint &rhs);
+	friend Bint operator*(Bint &&lhs, const Bint &rhs);
+	friend Bint operator*(const Bint &lhs, Bint &&rhs);
+	friend Bint operator*(Bint &&lhs, Bint &&rhs);
 
 	friend std::istream &operator>>(std::istream &is, Bint &b);
 	friend std::ostream &operator<<(std::ostream &os, const Bint &b);
+	// a compact binary form for checkpoints: the limbs as they are, no digit is formed
+	friend void save_binary(std::ostream &os, const Bint &b);
+	friend void load_binary(std::istream &is, Bint &b);
 
 	~Bint();
 };
@@ -66,163 +116,152 @@ public:
 
 namespace Util {
 
-Bint::NewSpaceFailed::NewSpaceFailed() : std::runtime_error("No Enough Memory Space.") {}
 Bint::BadCast::BadCast() : std::invalid_argument("Cannot convert to a Bint object") {}
 
-void Bint::_SafeNewSpace(int *&p, const size_t &len)
+void Bint::_Reserve(const size_t &len)
 {
-	if (p != nullptr) {
-		delete[] p;
-		p = nullptr;
+	if (len <= capacity) {
+		return;
 	}
-	p = new int[len];
-	if (p == nullptr) {
-		throw NewSpaceFailed();
+	size_t newCapa = std::max(len, capacity << 1);
+	limb *newMem = new limb[newCapa];
+	memcpy(newMem, data, length * sizeof(limb));
+	if (data != small) {
+		delete[] data;
 	}
-	memset(p, 0, len * sizeof(unsigned int));
+	data = newMem;
+	capacity = newCapa;
 }
 
-void Bint::_DoubleSpace()
+void Bint::_SetValue(long long x)
 {
-	int *newMem = nullptr;
-	_SafeNewSpace(newMem, capacity << 1);
-	memcpy(newMem, data, capacity * sizeof(int));
-	delete[] data;
-	data = newMem;
-	capacity <<= 1;
+	// the magnitude as unsigned, so that the most negative value does not overflow
+	unsigned long long mag = x < 0 ? 0ULL - static_cast<unsigned long long>(x) : x;
+	isMinus = x < 0;
+	length = 0;
+	_Reserve(3);
+	while (mag) {
+		data[length++] = static_cast<limb>(mag % BASE);
+		mag /= BASE;
+	}
+	if (!length) {
+		data[length++] = 0;
+	}
+}
+
+void Bint::_Trim()
+{
+	while (length > 1 && data[length - 1] == 0) {
+		--length;
+	}
+	if (length == 1 && data[0] == 0) {
+		isMinus = false;
+	}
 }
 
 Bint::Bint()
 	: length(1)
 {
-	_SafeNewSpace(data, capacity);
+	small[0] = 0;
 }
 
 Bint::Bint(int x)
 	: length(0)
 {
-	_SafeNewSpace(data, capacity);
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = x % 10000;
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
+	_SetValue(x);
 }
 
 Bint::Bint(long long x)
 	: length(0)
 {
-	_SafeNewSpace(data, capacity);
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = static_cast<unsigned int>(x % 10000);
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
+	_SetValue(x);
 }
 
 Bint::Bint(const size_t &capa)
 	: length(1)
 {
-	while (capacity < capa) {
-		capacity <<= 1;
-	}
-	_SafeNewSpace(data, capacity);
+	small[0] = 0;
+	_Reserve(capa);
 }
 
-Bint::Bint(std::string x)
+/**
+ * nine digits at a time, from the back of the text to the front
+ */
+void Bint::_Parse(const char *s, size_t n)
 {
-	while (x[0] == '-') {
-		isMinus = !isMinus;
-		x.erase(0, 1);
-	}
-	while ((capacity << 2) <= x.length()) {
-		capacity <<= 1;
-	}
-
-	_SafeNewSpace(data, capacity);
-
-	size_t mid = x.length() >> 1;
-	for (size_t i = 0; i < mid; ++i) {
-		std::swap(x[i], x[x.length() - 1 - i]);
-	}
-
-	const static unsigned int pow10[4] = {1, 10, 100, 1000};
-	for (size_t i = 0; i < capacity; ++i) {
-		if ((i << 2) >= x.length()) {
-			length = i;
-			break;
-		}
-		for (size_t j = 0; j < 4; ++j) {
-			if ((i << 2) + j >= x.length()) {
-				break;
-			}
-			if (x[(i << 2) + j] > '9' || x[(i << 2) + j] < '0') {
+	size_t begin = 0;
+	bool minus = false;
+	while (begin < n && s[begin] == '-') {
+		minus = !minus;
+		++begin;
+	}
+	length = 1;
+	_Reserve((n - begin + BASE_DIGITS - 1) / BASE_DIGITS);
+	length = 0;
+	for (size_t end = n; end > begin; ) {
+		size_t first = end > begin + BASE_DIGITS ? end - BASE_DIGITS : begin;
+		limb value = 0;
+		for (size_t i = first; i < end; ++i) {
+			if (s[i] > '9' || s[i] < '0') {
+				_SetValue(0);
 				throw BadCast();
 			}
-			data[i] = data[i] + (x[(i << 2) + j] - '0') * pow10[j];
+			value = value * 10 + (s[i] - '0');
 		}
+		data[length++] = value;
+		end = first;
+	}
+	if (!length) {
+		data[length++] = 0;
 	}
+	isMinus = minus;
+	_Trim();
+}
+
+Bint::Bint(const std::string &x)
+	: length(1)
+{
+	small[0] = 0;
+	_Parse(x.data(), x.length());
 }
 
 Bint::Bint(const Bint &b)
-	: isMinus(b.isMinus), length(b.length), capacity(b.capacity)
+	: isMinus(b.isMinus), length(0)
 {
-	_SafeNewSpace(data, capacity);
-	memcpy(data, b.data, sizeof(unsigned int) * capacity);
+	_Reserve(b.length);
+	memcpy(data, b.data, sizeof(limb) * b.length);
+	length = b.length;
 }
 
+/**
+ * a heap buffer is stolen, an inline one copied;
+ * either way b is left holding zero in its inline buffer
+ */
 Bint::Bint(Bint &&b) noexcept
-	: isMinus(b.isMinus), length(b.length), capacity(b.capacity)
+	: isMinus(b.isMinus), length(b.length)
 {
-	data = b.data;
-	b.data = nullptr;
+	if (b.data == b.small) {
+		memcpy(small, b.small, sizeof(limb) * b.length);
+	} else {
+		data = b.data;
+		capacity = b.capacity;
+		b.data = b.small;
+		b.capacity = SMALL_CAPACITY;
+	}
+	b.isMinus = false;
+	b.length = 1;
+	b.small[0] = 0;
 }
 
 Bint &Bint::operator=(int x)
 {
-	memset(data, 0, sizeof(unsigned int) * capacity);
-	length = 0;
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = x % 10000;
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
+	_SetValue(x);
 	return *this;
 }
 
 Bint &Bint::operator=(long long x)
 {
-	memset(data, 0, sizeof(unsigned int) * capacity);
-	length = 0;
-	if (x < 0) {
-		isMinus = true;
-		x = -x;
-	}
-	while (x) {
-		data[length++] = static_cast<unsigned int>(x % 10000);
-		x /= 10000;
-	}
-	if (!length) {
-		length = 1;
-	}
+	_SetValue(x);
 	return *this;
 }
 
@@ -231,11 +270,10 @@ Bint &Bint::operator=(const Bint &rhs)
 	if (this == &rhs) {
 		return *this;
 	}
-	if (rhs.capacity > capacity) {
-		capacity = rhs.capacity;
-		_SafeNewSpace(data, capacity);
-	}
-	memcpy(data, rhs.data, sizeof(unsigned int) * rhs.capacity);
+	// keep a valid value should the allocation throw, without copying the old limbs
+	length = 1;
+	_Reserve(rhs.length);
+	memcpy(data, rhs.data, sizeof(limb) * rhs.length);
 	length = rhs.length;
 	isMinus = rhs.isMinus;
 	return *this;
@@ -246,37 +284,110 @@ Bint &Bint::operator=(Bint &&rhs) noexcept
 	if (this == &rhs) {
 		return *this;
 	}
-	capacity = rhs.capacity;
+	if (rhs.data == rhs.small) {
+		// fits: capacity never drops below SMALL_CAPACITY
+		memcpy(data, rhs.small, sizeof(limb) * rhs.length);
+	} else {
+		if (data != small) {
+			delete[] data;
+		}
+		data = rhs.data;
+		capacity = rhs.capacity;
+		rhs.data = rhs.small;
+		rhs.capacity = SMALL_CAPACITY;
+	}
 	length = rhs.length;
 	isMinus = rhs.isMinus;
-	data = rhs.data;
-	rhs.data = nullptr;
+	rhs.isMinus = false;
+	rhs.length = 1;
+	rhs.small[0] = 0;
 	return *this;
 }
 
+/**
+ * parse straight into b, which keeps its value if nothing could be read
+ * and becomes zero if the text is not a number
+ */
 std::istream &operator>>(std::istream &is, Bint &b)
 {
 	std::string s;
-	is >> s;
-	b = Bint(s);
+	if (is >> s) {
+		b._Parse(s.data(), s.length());
+	}
 	return is;
 }
 
+/**
+ * the digits are formed in one buffer and written at once,
+ * leaving the formatting state of os alone
+ */
 std::ostream &operator<<(std::ostream &os, const Bint &b)
 {
-	if (b.data == nullptr) {
-		return os;
+	std::string s(b.length * BASE_DIGITS + 1, '0');
+	size_t pos = s.length();
+	for (size_t i = 0; i < b.length; ++i) {
+		Bint::limb value = b.data[i];
+		for (size_t j = 0; j < BASE_DIGITS && (value || i + 1 < b.length); ++j) {
+			s[--pos] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		}
 	}
-	if (b.isMinus && (b.length > 1 || b.data[0] != 0)) {
-		os << "-";
+	if (pos == s.length()) {
+		s[--pos] = '0';
 	}
-	os << b.data[b.length - 1];
-	for (long long i = b.length - 2LL; i >= 0; --i) {
-		os << std::setw(4) << std::setfill('0') << b.data[i];
+	if (b.isMinus) {
+		s[--pos] = '-';
 	}
+	os.write(s.data() + pos, s.length() - pos);
 	return os;
 }
 
+/**
+ * one word holding the length and the sign, then the limbs in memory order
+ */
+void save_binary(std::ostream &os, const Bint &b)
+{
+	unsigned long long word = static_cast<unsigned long long>(b.length) << 1 | b.isMinus;
+	os.write(reinterpret_cast<const char *>(&word), sizeof(word));
+	os.write(reinterpret_cast<const char *>(b.data), b.length * sizeof(Bint::limb));
+}
+
+/**
+ * read the limbs into a buffer of their own that grows with what was actually read, so that
+ * a corrupt length word cannot ask for more memory than the stream holds; b takes them only
+ * once all were read and checked. a dump that is cut short or holds no trimmed value fails
+ * the stream and leaves b unchanged
+ */
+void load_binary(std::istream &is, Bint &b)
+{
+	unsigned long long word;
+	if (!is.read(reinterpret_cast<char *>(&word), sizeof(word))) {
+		return;
+	}
+	const size_t first_step = 1024;
+	unsigned long long len = word >> 1;
+	bool bad = len == 0;
+	Bint t;
+	for (size_t got = 0; !bad && got < len; ) {
+		size_t step = static_cast<size_t>(std::min<unsigned long long>(len - got, std::max(got, first_step)));
+		t.length = got;
+		t._Reserve(got + step);
+		bad = !is.read(reinterpret_cast<char *>(t.data + got), step * sizeof(Bint::limb));
+		got += step;
+	}
+	for (size_t i = 0; !bad && i < len; ++i) {
+		bad = t.data[i] >= BASE;
+	}
+	if (bad || (len > 1 && t.data[len - 1] == 0)) {
+		is.setstate(std::ios::failbit);
+		return;
+	}
+	t.length = static_cast<size_t>(len);
+	t.isMinus = word & 1;
+	t._Trim();
+	b = std::move(t);
+}
+
 Bint abs(const Bint &b)
 {
 	Bint result(b);
@@ -287,230 +398,331 @@ Bint abs(const Bint &b)
 Bint abs(Bint &&b)
 {
 	b.isMinus = false;
-	return b;
+	return std::move(b);
 }
 
-bool operator==(const Bint &lhs, const Bint &rhs)
+int Bint::_CmpMag(const limb *a, size_t la, const limb *b, size_t lb)
 {
-	if (lhs.isMinus != rhs.isMinus) {
-		return false;
+	if (la != lb) {
+		return la < lb ? -1 : 1;
 	}
-	if (lhs.length != rhs.length) {
-		return false;
-	}
-	for (size_t i = 0; i < lhs.length; ++i) {
-		if (lhs.data[i] != rhs.data[i]) {
-			return false;
+	for (size_t i = la; i-- > 0; ) {
+		if (a[i] != b[i]) {
+			return a[i] < b[i] ? -1 : 1;
 		}
 	}
-	return true;
+	return 0;
 }
 
-bool operator!=(const Bint &lhs, const Bint &rhs)
+size_t Bint::_AddMag(limb *r, const limb *a, size_t la, const limb *b, size_t lb)
 {
-	if (lhs.isMinus != rhs.isMinus) {
-		return true;
+	limb carry = 0;
+	size_t i = 0;
+	for (; i < lb; ++i) {
+		limb sum = a[i] + b[i] + carry;
+		carry = sum >= BASE;
+		r[i] = carry ? sum - BASE : sum;
+	}
+	for (; i < la; ++i) {
+		limb sum = a[i] + carry;
+		carry = sum >= BASE;
+		r[i] = carry ? sum - BASE : sum;
+	}
+	if (carry) {
+		r[la++] = carry;
+	}
+	return la;
+}
+
+size_t Bint::_SubMag(limb *r, const limb *a, size_t la, const limb *b, size_t lb)
+{
+	limb borrow = 0;
+	size_t i = 0;
+	for (; i < lb; ++i) {
+		limb sub = b[i] + borrow;
+		borrow = a[i] < sub;
+		r[i] = borrow ? a[i] + BASE - sub : a[i] - sub;
+	}
+	for (; i < la; ++i) {
+		limb cur = a[i];
+		r[i] = cur < borrow ? BASE - 1 : cur - borrow;
+		borrow = cur < borrow;
+	}
+	while (la > 1 && r[la - 1] == 0) {
+		--la;
+	}
+	return la;
+}
+
+void Bint::_AddInto(limb *r, size_t lr, const limb *a, size_t la)
+{
+	limb carry = 0;
+	size_t i = 0;
+	for (; i < la; ++i) {
+		limb sum = r[i] + a[i] + carry;
+		carry = sum >= BASE;
+		r[i] = carry ? sum - BASE : sum;
+	}
+	for (; carry && i < lr; ++i) {
+		limb sum = r[i] + carry;
+		carry = sum >= BASE;
+		r[i] = carry ? sum - BASE : sum;
 	}
-	if (lhs.length != rhs.length) {
-		return true;
+}
+
+void Bint::_SubInto(limb *r, size_t lr, const limb *a, size_t la)
+{
+	limb borrow = 0;
+	size_t i = 0;
+	for (; i < la; ++i) {
+		limb sub = a[i] + borrow;
+		borrow = r[i] < sub;
+		r[i] = borrow ? r[i] + BASE - sub : r[i] - sub;
 	}
-	for (size_t i = 0; i < lhs.length; ++i) {
-		if (lhs.data[i] != rhs.data[i]) {
-			return true;
-		}
+	for (; borrow && i < lr; ++i) {
+		borrow = r[i] == 0;
+		r[i] = borrow ? BASE - 1 : r[i] - 1;
 	}
-	return false;
 }
 
-bool operator<(const Bint &lhs, const Bint &rhs)
+void Bint::_MulSchool(limb *r, const limb *a, size_t la, const limb *b, size_t lb)
 {
-	if (lhs.isMinus != rhs.isMinus) {
-		return !lhs.isMinus;
-	}
-	if (lhs.isMinus) {
-		if (lhs.length != rhs.length) {
-			return lhs.length > rhs.length;
-		}
-		for (long long i = lhs.length - 1; i >= 0; --i) {
-			if (lhs.data[i] != rhs.data[i]) {
-				return lhs.data[i] > rhs.data[i];
-			}
+	memset(r, 0, (la + lb) * sizeof(limb));
+	for (size_t i = 0; i < la; ++i) {
+		if (a[i] == 0) {
+			continue;
 		}
-		return false;
-	} else {
-		if (lhs.length != rhs.length) {
-			return lhs.length < rhs.length;
-		}
-		for (long long i = lhs.length - 1; i >= 0; --i) {
-			if (lhs.data[i] != rhs.data[i]) {
-				return lhs.data[i] < rhs.data[i];
-			}
+		// a[i] * b[j] + r + carry < 10^18 + 2 * 10^9, well inside 64 bits
+		wide carry = 0;
+		for (size_t j = 0; j < lb; ++j) {
+			wide cur = r[i + j] + static_cast<wide>(a[i]) * b[j] + carry;
+			r[i + j] = static_cast<limb>(cur % BASE);
+			carry = cur / BASE;
 		}
-		return false;
+		r[i + lb] = static_cast<limb>(carry);
 	}
 }
 
-bool operator>(const Bint &lhs, const Bint &rhs)
+/**
+ * Karatsuba: split both operands at m limbs, a = a1 B^m + a0, b = b1 B^m + b0,
+ * and form a b = z2 B^2m + ((a0 + a1)(b0 + b1) - z2 - z0) B^m + z0
+ * with three half-size products instead of four.
+ * An operand that does not reach past m is multiplied piecewise instead.
+ */
+void Bint::_Mul(limb *r, const limb *a, size_t la, const limb *b, size_t lb)
 {
-	return rhs < lhs;
+	if (la < lb) {
+		std::swap(a, b);
+		std::swap(la, lb);
+	}
+	if (lb < KARATSUBA_THRESHOLD) {
+		_MulSchool(r, a, la, b, lb);
+		return;
+	}
+	size_t m = la >> 1;
+	if (lb <= m) {
+		// unbalanced: r = a0 b + (a1 b) B^m
+		std::vector<limb> high(la - m + lb);
+		_Mul(r, a, m, b, lb);
+		memset(r + m + lb, 0, (la - m) * sizeof(limb));
+		_Mul(high.data(), a + m, la - m, b, lb);
+		_AddInto(r + m, la - m + lb, high.data(), high.size());
+		return;
+	}
+	const limb *a0 = a, *a1 = a + m, *b0 = b, *b1 = b + m;
+	size_t la1 = la - m, lb1 = lb - m;
+	// z0 into r[0, 2m), z2 into r[2m, la + lb)
+	_Mul(r, a0, m, b0, m);
+	_Mul(r + 2 * m, a1, la1, b1, lb1);
+
+	std::vector<limb> sa(la1 + 1), sb(std::max(m, lb1) + 1);
+	size_t lsa = _AddMag(sa.data(), a1, la1, a0, m);
+	size_t lsb = lb1 >= m ? _AddMag(sb.data(), b1, lb1, b0, m) : _AddMag(sb.data(), b0, m, b1, lb1);
+	std::vector<limb> z1(lsa + lsb);
+	_Mul(z1.data(), sa.data(), lsa, sb.data(), lsb);
+	_SubInto(z1.data(), z1.size(), r, 2 * m);
+	_SubInto(z1.data(), z1.size(), r + 2 * m, la1 + lb1);
+	size_t lz1 = z1.size();
+	while (lz1 > 0 && z1[lz1 - 1] == 0) {
+		--lz1;
+	}
+	_AddInto(r + m, la + lb - m, z1.data(), lz1);
 }
 
-bool operator<=(const Bint &lhs, const Bint &rhs)
+void Bint::_Add(Bint &result, const Bint &a, const Bint &b, bool negate)
 {
-	if (lhs.isMinus != rhs.isMinus) {
-		return !lhs.isMinus;
-	}
-	if (lhs.isMinus) {
-		if (lhs.length != rhs.length) {
-			return lhs.length > rhs.length;
-		}
-		for (long long i = lhs.length - 1; i >= 0; --i) {
-			if (lhs.data[i] != rhs.data[i]) {
-				return lhs.data[i] > rhs.data[i];
-			}
-		}
-		return true;
+	bool aMinus = a.isMinus, bMinus = b.isMinus != negate;
+	size_t la = a.length, lb = b.length;
+	if (aMinus == bMinus) {
+		// a carry out of the top needs the top limbs to sum to BASE - 1 or more
+		size_t hi = std::max(la, lb);
+		limb top = (la == hi ? a.data[hi - 1] : 0) + (lb == hi ? b.data[hi - 1] : 0);
+		result._Reserve(hi + (top >= BASE - 1));
+		result.length = la >= lb ? _AddMag(result.data, a.data, la, b.data, lb)
+		                         : _AddMag(result.data, b.data, lb, a.data, la);
+		result.isMinus = aMinus;
+	} else if (_CmpMag(a.data, la, b.data, lb) >= 0) {
+		result._Reserve(la);
+		result.length = _SubMag(result.data, a.data, la, b.data, lb);
+		result.isMinus = aMinus;
 	} else {
-		if (lhs.length != rhs.length) {
-			return lhs.length < rhs.length;
-		}
-		for (long long i = lhs.length - 1; i >= 0; --i) {
-			if (lhs.data[i] != rhs.data[i]) {
-				return lhs.data[i] < rhs.data[i];
-			}
-		}
-		return true;
+		result._Reserve(lb);
+		result.length = _SubMag(result.data, b.data, lb, a.data, la);
+		result.isMinus = bMinus;
 	}
+	result._Trim();
 }
 
-bool operator>=(const Bint &lhs, const Bint &rhs)
+bool operator==(const Bint &lhs, const Bint &rhs)
+{
+	return lhs.isMinus == rhs.isMinus && Bint::_CmpMag(lhs.data, lhs.length, rhs.data, rhs.length) == 0;
+}
+
+bool operator!=(const Bint &lhs, const Bint &rhs)
+{
+	return !(lhs == rhs);
+}
+
+bool operator<(const Bint &lhs, const Bint &rhs)
 {
 	if (lhs.isMinus != rhs.isMinus) {
 		return lhs.isMinus;
 	}
-	if (lhs.isMinus) {
-		if (lhs.length != rhs.length) {
-			return lhs.length < rhs.length;
-		}
-		for (long long i = lhs.length - 1; i >= 0; --i) {
-			if (lhs.data[i] != rhs.data[i]) {
-				return lhs.data[i] < rhs.data[i];
-			}
-		}
-		return true;
-	} else {
-		if (lhs.length != rhs.length) {
-			return lhs.length > rhs.length;
-		}
-		for (long long i = lhs.length - 1; i >= 0; --i) {
-			if (lhs.data[i] != rhs.data[i]) {
-				return lhs.data[i] > rhs.data[i];
-			}
-		}
-		return true;
-	}
+	int cmp = Bint::_CmpMag(lhs.data, lhs.length, rhs.data, rhs.length);
+	return lhs.isMinus ? cmp > 0 : cmp < 0;
+}
+
+bool operator>(const Bint &lhs, const Bint &rhs)
+{
+	return rhs < lhs;
+}
+
+bool operator<=(const Bint &lhs, const Bint &rhs)
+{
+	return !(rhs < lhs);
+}
+
+bool operator>=(const Bint &lhs, const Bint &rhs)
+{
+	return !(lhs < rhs);
 }
 
 
+Bint &Bint::operator+=(const Bint &rhs)
+{
+	_Add(*this, *this, rhs, false);
+	return *this;
+}
+
+Bint &Bint::operator-=(const Bint &rhs)
+{
+	_Add(*this, *this, rhs, true);
+	return *this;
+}
+
+Bint &Bint::operator*=(const Bint &rhs)
+{
+	*this = *this * rhs;
+	return *this;
+}
+
 Bint operator+(const Bint &lhs, const Bint &rhs)
 {
-	if (lhs.isMinus == rhs.isMinus) {
-		size_t maxLen = std::max(lhs.length, rhs.length);
-		size_t expectLen = maxLen + 1;
-		Bint result(expectLen); // special constructor
-		for (size_t i = 0; i < maxLen; ++i) {
-			result.data[i] = lhs.data[i] + rhs.data[i];
-		}
-		for (size_t i = 0; i < maxLen; ++i) {
-			if (result.data[i] > 10000) {
-				result.data[i] -= 10000;
-				++result.data[i + 1];
-			}
-		}
-		result.length = result.data[maxLen] > 0 ? maxLen + 1 : maxLen;
-		result.isMinus = lhs.isMinus;
-		return result;
-	} else {
-		if (lhs.isMinus) {
-			return rhs - abs(lhs);
-		} else {
-			return lhs - abs(rhs);
-		}
-	}
+	Bint result(std::max(lhs.length, rhs.length) + 1);
+	Bint::_Add(result, lhs, rhs, false);
+	return result;
+}
+
+Bint operator+(Bint &&lhs, const Bint &rhs)
+{
+	lhs += rhs;
+	return std::move(lhs);
+}
+
+Bint operator+(const Bint &lhs, Bint &&rhs)
+{
+	rhs += lhs;
+	return std::move(rhs);
+}
+
+Bint operator+(Bint &&lhs, Bint &&rhs)
+{
+	lhs += rhs;
+	return std::move(lhs);
 }
 
 Bint operator-(const Bint &b)
 {
 	Bint result(b);
 	result.isMinus = !result.isMinus;
+	result._Trim();
 	return result;
 }
 
 Bint operator-(Bint &&b)
 {
 	b.isMinus = !b.isMinus;
-	return b;
+	b._Trim();
+	return std::move(b);
 }
 
 Bint operator-(const Bint &lhs, const Bint &rhs)
 {
-	if (lhs.isMinus == rhs.isMinus) {
-		if (lhs.isMinus) {
-			return -(abs(lhs) - abs(rhs));
-		} else {
-			if (lhs < rhs) {
-				return -(rhs - lhs);
-			}
-			Bint result(std::max(lhs.length, rhs.length));
-			for (size_t i = 0; i < lhs.length; ++i) {
-				result.data[i] = lhs.data[i] - rhs.data[i];
-			}
-			for (size_t i = 0; i < lhs.length; ++i) {
-				if (result.data[i] < 0) {
-					result.data[i] += 10000;
-					++result.data[i + 1];
-				}
-			}
-			while (result.length > 1 && result.data[result.length - 1] == 0) {
-				--result.length;
-			}
-			return result;
-		}
-	} else {
-		return lhs + (-rhs);
-	}
+	Bint result(std::max(lhs.length, rhs.length) + 1);
+	Bint::_Add(result, lhs, rhs, true);
+	return result;
+}
+
+Bint operator-(Bint &&lhs, const Bint &rhs)
+{
+	lhs -= rhs;
+	return std::move(lhs);
+}
+
+Bint operator-(const Bint &lhs, Bint &&rhs)
+{
+	Bint::_Add(rhs, lhs, rhs, true);
+	return std::move(rhs);
+}
+
+Bint operator-(Bint &&lhs, Bint &&rhs)
+{
+	lhs -= rhs;
+	return std::move(lhs);
 }
 
 Bint operator*(const Bint &lhs, const Bint &rhs)
 {
-	size_t expectLen = lhs.length + rhs.length + 2;
-	Bint result(expectLen);
-	for (size_t i = 0; i < lhs.length; ++i) {
-		for (size_t j = 0; j < rhs.length; ++j) {
-			long long tmp = result.data[i + j] + static_cast<long long>(lhs.data[i]) * rhs.data[j];
-			if (tmp >= 10000) {
-				result.data[i + j] = tmp % 10000;
-				result.data[i + j + 1] += static_cast<int>(tmp / 10000);
-			} else {
-				result.data[i + j] = tmp;
-			}
-		}
-	}
-	result.length = lhs.length + rhs.length -1;
-	while (result.data[result.length] > 0) {
-		++result.length;
-	}
-	while (result.length > 1 && result.data[result.length - 1] == 0) {
-		--result.length;
-	}
+	Bint result(lhs.length + rhs.length);
+	Bint::_Mul(result.data, lhs.data, lhs.length, rhs.data, rhs.length);
+	result.length = lhs.length + rhs.length;
+	result.isMinus = lhs.isMinus != rhs.isMinus;
+	result._Trim();
 	return result;
 }
 
+Bint operator*(Bint &&lhs, const Bint &rhs)
+{
+	lhs *= rhs;
+	return std::move(lhs);
+}
+
+Bint operator*(const Bint &lhs, Bint &&rhs)
+{
+	rhs *= lhs;
+	return std::move(rhs);
+}
+
+Bint operator*(Bint &&lhs, Bint &&rhs)
+{
+	lhs *= rhs;
+	return std::move(lhs);
+}
+
 Bint::~Bint()
 {
-	if (data != nullptr) {
+	if (data != small) {
 		delete[] data;
-		data = nullptr;
 	}
 }
 }
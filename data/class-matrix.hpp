@@ -1,59 +1,281 @@
 #ifndef DIAMOND_MATRIX_HPP
 #define DIAMOND_MATRIX_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
-#include <vector>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#ifdef DIAMOND_MATRIX_THREADS
+#include <thread>
+#include <vector>
+#endif
 
 namespace Diamond {
 
+const size_t MATRIX_ALIGN = 64;
+// the buffer of a matrix with rows at least this long starts on a cache line, and its
+// rows are padded to start on one too; smaller matrices keep the cheaper default allocation
+const size_t MATRIX_PAD_BYTES = 512;
+
+/**
+ * A non-owning window of rows x cols elements into a row-major buffer whose
+ * rows lie stride elements apart. _Tv is _Td or const _Td.
+ */
+template<typename _Tv>
+class MatrixView {
+	_Tv *origin;
+	size_t n_rows, n_cols, stride;
+public:
+	MatrixView(_Tv *_origin, const size_t &_n_rows, const size_t &_n_cols, const size_t &_stride)
+		: origin(_origin), n_rows(_n_rows), n_cols(_n_cols), stride(_stride) {}
+	/**
+	 * a view of _Td converts to a view of const _Td
+	 */
+	template<typename _Tu, typename = typename std::enable_if<std::is_same<const _Tu, _Tv>::value>::type>
+	MatrixView(const MatrixView<_Tu> &view)
+		: origin(view[0]), n_rows(view.RowSize()), n_cols(view.ColSize()), stride(view.Stride()) {}
+	inline const size_t & RowSize() const
+	{
+		return n_rows;
+	}
+	inline const size_t & ColSize() const
+	{
+		return n_cols;
+	}
+	inline const size_t & Stride() const
+	{
+		return stride;
+	}
+	_Tv * operator[](const size_t &Kth) const
+	{
+		return origin + Kth * stride;
+	}
+	/**
+	 * the _n_rows x _n_cols window starting at row r, column c
+	 */
+	MatrixView Block(const size_t &r, const size_t &c, const size_t &_n_rows, const size_t &_n_cols) const
+	{
+		if (r + _n_rows > n_rows || c + _n_cols > n_cols) {
+			throw std::out_of_range("block outside the matrix");
+		}
+		return MatrixView(origin + r * stride + c, _n_rows, _n_cols, stride);
+	}
+};
+
+/**
+ * Base of the lazily evaluated element-wise expressions further down:
+ * a + b, a - b, -a, a * s, s * a, a / s and Transpose(a) only record their
+ * operands, and the whole expression is computed in one pass, into one
+ * buffer, when it is assigned to a Matrix.
+ */
+struct MatrixExpression {
+	static constexpr bool _is_leaf = false;
+	static constexpr bool _is_transposed_leaf = false;
+};
+
+namespace detail {
+template<typename _E>
+using _IfNode = typename std::enable_if<std::is_base_of<MatrixExpression, typename std::decay<_E>::type>::value>::type;
+}
+
+/**
+ * Row-major matrix in one flat buffer. Row i starts at data + i * stride.
+ * operator[] returns a pointer to the row, so m[i][j] costs one multiply-add.
+ */
 template<typename _Td>
 class Matrix {
 protected:
+	static constexpr size_t align = MATRIX_ALIGN > alignof(_Td) ? MATRIX_ALIGN : alignof(_Td);
 	size_t n_rows = 0;
 	size_t n_cols = 0;
-	std::vector<std::vector<_Td>> data;
-	class RowProxy {
-		std::vector<_Td> &row;
-	public:
-		RowProxy(std::vector<_Td> & _row) : row(_row) {}
-		_Td & operator[](const size_t &pos)
-		{
-			return row[pos];
+	size_t stride = 0;
+	_Td *data = nullptr;
+	static bool _Aligned(const size_t &cols)
+	{
+		return cols * sizeof(_Td) >= MATRIX_PAD_BYTES || alignof(_Td) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	}
+	static size_t _Stride(const size_t &cols)
+	{
+		if (!_Aligned(cols) || align % sizeof(_Td)) {
+			return cols;
+		}
+		size_t perLine = align / sizeof(_Td);
+		return (cols + perLine - 1) / perLine * perLine;
+	}
+	static _Td * _Allocate(const size_t &count, const size_t &cols)
+	{
+		if (!count) {
+			return nullptr;
 		}
-	};
-	class ConstRowProxy {
-		const std::vector<_Td> &row;
-	public:
-		ConstRowProxy(const std::vector<_Td> &_row) : row(_row) {}
-		const _Td & operator[](const size_t &pos) const
-		{
-			return row[pos];
+		if (_Aligned(cols)) {
+			return static_cast<_Td *>(::operator new(count * sizeof(_Td), std::align_val_t(align)));
 		}
-	};
+		return static_cast<_Td *>(::operator new(count * sizeof(_Td)));
+	}
+	static void _Deallocate(_Td *p, const size_t &cols)
+	{
+		if (!p) {
+			return;
+		}
+		if (_Aligned(cols)) {
+			::operator delete(p, std::align_val_t(align));
+		} else {
+			::operator delete(p);
+		}
+	}
+	/**
+	 * allocate the buffer for _n_rows x _n_cols and fill every slot, padding included, with value
+	 */
+	void _Init(const size_t &_n_rows, const size_t &_n_cols, const _Td &value)
+	{
+		n_rows = _n_rows, n_cols = _n_cols, stride = _Stride(_n_cols);
+		data = _Allocate(n_rows * stride, n_cols);
+		try {
+			std::uninitialized_fill_n(data, n_rows * stride, value);
+		} catch (...) {
+			_Deallocate(data, n_cols);
+			data = nullptr;
+			throw;
+		}
+	}
+	void _Release()
+	{
+		if (data) {
+			std::destroy_n(data, n_rows * stride);
+			_Deallocate(data, n_cols);
+		}
+		data = nullptr;
+		n_rows = n_cols = stride = 0;
+	}
 public:
+	typedef _Td value_type;
 	Matrix() {};
 	Matrix(const size_t &_n_rows, const size_t &_n_cols)
-		: n_rows(_n_rows), n_cols(_n_cols), data(std::vector<std::vector<_Td>>(n_rows, std::vector<_Td>(n_cols))) {}
+	{
+		_Init(_n_rows, _n_cols, _Td());
+	}
 	Matrix(const size_t &_n_rows, const size_t &_n_cols, const _Td &fillValue)
-		: n_rows(_n_rows), n_cols(_n_cols), data(std::vector<std::vector<_Td>>(n_rows, std::vector<_Td>(n_cols, fillValue))) {}
+	{
+		_Init(_n_rows, _n_cols, fillValue);
+	}
 	Matrix(const Matrix<_Td> &mat)
-		: n_rows(mat.n_rows), n_cols(mat.n_cols), data(mat.data) {}
+		: Matrix(mat.View()) {}
+	/**
+	 * a copy of the elements of a view
+	 */
+	template<typename _Tv>
+	explicit Matrix(const MatrixView<_Tv> &view)
+		: n_rows(view.RowSize()), n_cols(view.ColSize()), stride(_Stride(view.ColSize()))
+	{
+		data = _Allocate(n_rows * stride, n_cols);
+		size_t built = 0;
+		try {
+			for (size_t i = 0; i < n_rows; ++i, built += stride) {
+				std::uninitialized_copy_n(view[i], n_cols, data + built);
+				try {
+					std::uninitialized_fill_n(data + built + n_cols, stride - n_cols, _Td());
+				} catch (...) {
+					std::destroy_n(data + built, n_cols);
+					throw;
+				}
+			}
+		} catch (...) {
+			std::destroy_n(data, built);
+			_Deallocate(data, n_cols);
+			throw;
+		}
+	}
+	/**
+	 * evaluate an expression, constructing every element in place in a single pass
+	 */
+	template<typename _E, typename = detail::_IfNode<_E>>
+	Matrix(const _E &expr)
+		: n_rows(expr.RowSize()), n_cols(expr.ColSize()), stride(_Stride(expr.ColSize()))
+	{
+		if constexpr (_E::_is_transposed_leaf) {
+			_Init(n_rows, n_cols, _Td());
+			expr._Store(data, stride);
+			return;
+		}
+		data = _Allocate(n_rows * stride, n_cols);
+		size_t built = 0;
+		try {
+			for (size_t i = 0; i < n_rows; ++i) {
+				_Td *row = data + i * stride;
+				for (size_t j = 0; j < n_cols; ++j, ++built) {
+					::new (static_cast<void *>(row + j)) _Td(expr(i, j));
+				}
+				for (size_t j = n_cols; j < stride; ++j, ++built) {
+					::new (static_cast<void *>(row + j)) _Td();
+				}
+			}
+		} catch (...) {
+			std::destroy_n(data, built);
+			_Deallocate(data, n_cols);
+			throw;
+		}
+	}
+	/**
+	 * take over the buffer; mat is left an empty 0 x 0 matrix
+	 */
 	Matrix(Matrix<_Td> &&mat) noexcept
-		: n_rows(mat.n_rows), n_cols(mat.n_cols), data(mat.data) {}
+		: n_rows(mat.n_rows), n_cols(mat.n_cols), stride(mat.stride), data(mat.data)
+	{
+		mat.data = nullptr;
+		mat.n_rows = mat.n_cols = mat.stride = 0;
+	}
+	/**
+	 * same shape: assign element by element into the buffer already held
+	 */
 	Matrix<_Td> & operator=(const Matrix<_Td> &rhs)
 	{
-		this->n_rows = rhs.n_rows;
-		this->n_cols = rhs.n_cols;
-		this->data = rhs.data;
+		if (this == &rhs) {
+			return *this;
+		}
+		if (n_rows == rhs.n_rows && n_cols == rhs.n_cols) {
+			for (size_t i = 0; i < n_rows; ++i) {
+				std::copy(rhs[i], rhs[i] + n_cols, (*this)[i]);
+			}
+			return *this;
+		}
+		return *this = Matrix<_Td>(rhs);
+	}
+	/**
+	 * same shape, and no element is read back after it is overwritten
+	 * (Transpose of this matrix would be): evaluate into the buffer already held
+	 */
+	template<typename _E, typename = detail::_IfNode<_E>>
+	Matrix<_Td> & operator=(const _E &expr)
+	{
+		if (n_rows != expr.RowSize() || n_cols != expr.ColSize() || expr._Reorders(data)) {
+			return *this = Matrix<_Td>(expr);
+		}
+		if constexpr (_E::_is_transposed_leaf) {
+			expr._Store(data, stride);
+		} else {
+			for (size_t i = 0; i < n_rows; ++i) {
+				_Td *row = data + i * stride;
+				for (size_t j = 0; j < n_cols; ++j) {
+					row[j] = expr(i, j);
+				}
+			}
+		}
 		return *this;
 	}
-	Matrix<_Td> & operator=(Matrix<_Td> &&rhs)
+	Matrix<_Td> & operator=(Matrix<_Td> &&rhs) noexcept
 	{
-		this->n_rows = rhs.n_rows;
-		this->n_cols = rhs.n_cols;
-		this->data = rhs.data;
+		if (this == &rhs) {
+			return *this;
+		}
+		_Release();
+		std::swap(n_rows, rhs.n_rows);
+		std::swap(n_cols, rhs.n_cols);
+		std::swap(stride, rhs.stride);
+		std::swap(data, rhs.data);
 		return *this;
 	}
 	inline const size_t & RowSize() const
@@ -64,156 +286,778 @@ public:
 	{
 		return n_cols;
 	}
-	RowProxy operator[](const size_t &Kth)
+	inline const size_t & Stride() const
+	{
+		return stride;
+	}
+	_Td * operator[](const size_t &Kth)
+	{
+		return data + Kth * stride;
+	}
+	const _Td * operator[](const size_t &Kth) const
+	{
+		return data + Kth * stride;
+	}
+	MatrixView<_Td> View()
+	{
+		return MatrixView<_Td>(data, n_rows, n_cols, stride);
+	}
+	MatrixView<const _Td> View() const
+	{
+		return MatrixView<const _Td>(data, n_rows, n_cols, stride);
+	}
+	MatrixView<_Td> Block(const size_t &r, const size_t &c, const size_t &_n_rows, const size_t &_n_cols)
+	{
+		return View().Block(r, c, _n_rows, _n_cols);
+	}
+	MatrixView<const _Td> Block(const size_t &r, const size_t &c, const size_t &_n_rows, const size_t &_n_cols) const
+	{
+		return View().Block(r, c, _n_rows, _n_cols);
+	}
+	MatrixView<_Td> Row(const size_t &Kth)
+	{
+		return Block(Kth, 0, 1, n_cols);
+	}
+	MatrixView<const _Td> Row(const size_t &Kth) const
 	{
-		return RowProxy(this->data[Kth]);
+		return Block(Kth, 0, 1, n_cols);
 	}
-	const ConstRowProxy operator[](const size_t &Kth) const
+	~Matrix()
 	{
-		return ConstRowProxy(this->data[Kth]);
+		_Release();
 	}
-	~Matrix() = default;
 };
 
+namespace detail {
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// the packed kernel is compiled once more for AVX2 and for AVX-512, and picked by cpuid at run time
+#define DIAMOND_GEMM_DISPATCH
+#endif
+#if defined(__GNUC__)
+// the register tile is written with the vector extensions of GCC and Clang, and in scalars elsewhere
+#define DIAMOND_GEMM_SIMD
+#define DIAMOND_GEMM_INLINE __attribute__((always_inline))
+#else
+#define DIAMOND_GEMM_INLINE
+#endif
+
+/*
+ * Blocking of C = A * B: a KC x NC panel of B and an MC x KC block of A are
+ * packed into contiguous buffers sized to stay in L2 and L1, and an MR x NR
+ * tile of C is kept in registers across the whole KC depth.
+ */
+const size_t GEMM_MC = 64;
+const size_t GEMM_KC = 256;
+const size_t GEMM_NC = 1024;
+const size_t GEMM_MR = 4;
+// below this many multiply-adds the packing does not pay for itself
+const size_t GEMM_SMALL = 32 * 32 * 32;
+#ifdef DIAMOND_MATRIX_THREADS
+// from this many multiply-adds up, the row blocks of C are shared among threads
+const size_t GEMM_THREADED = 256 * 256 * 256;
+#endif
+
 /**
- * Sum of two matrics.
+ * two native vectors of _Bytes make one NR-wide row of a register tile:
+ * 16 bytes for the SSE2 / NEON baseline, 32 for AVX2, 64 for AVX-512
+ */
+template<typename _Td, size_t _Bytes>
+struct GemmVec {
+#ifdef DIAMOND_GEMM_SIMD
+	typedef _Td type __attribute__((vector_size(_Bytes)));
+#endif
+	static constexpr size_t width = _Bytes / sizeof(_Td);
+	static constexpr size_t nr = 2 * width;
+};
+
+/**
+ * the i-k-j kernel for element types without a packed one
  */
 template<typename _Td>
-Matrix<_Td> operator+(const Matrix<_Td> &a, const Matrix<_Td> &b)
+void _GemmPlain(const _Td *a, size_t lda, const _Td *b, size_t ldb, _Td *c, size_t ldc, size_t m, size_t n, size_t k)
 {
-	if (a.RowSize() != b.RowSize() || a.ColSize() != b.ColSize()) {
-		throw std::invalid_argument("different matrics\'s sizes");
+	for (size_t ii = 0; ii < m; ii += GEMM_MC) {
+		for (size_t kk = 0; kk < k; kk += GEMM_KC) {
+			size_t iEnd = std::min(m, ii + GEMM_MC), kEnd = std::min(k, kk + GEMM_KC);
+			for (size_t i = ii; i < iEnd; ++i) {
+				_Td *rc = c + i * ldc;
+				for (size_t p = kk; p < kEnd; ++p) {
+					const _Td aip = a[i * lda + p];
+					const _Td *rb = b + p * ldb;
+					for (size_t j = 0; j < n; ++j) {
+						rc[j] += aip * rb[j];
+					}
+				}
+			}
+		}
 	}
-	Matrix<_Td> c(a.RowSize(), a.ColSize());
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < a.ColSize(); ++j) {
-			c[i][j] = a[i][j] + b[i][j];
+}
+
+/**
+ * kc x nc of B into NR-column panels, row by row within a panel, zero-padded
+ */
+template<typename _Td, size_t _Bytes>
+DIAMOND_GEMM_INLINE inline void _PackB(const _Td *b, size_t ldb, size_t kc, size_t nc, _Td *bp)
+{
+	const size_t nr = GemmVec<_Td, _Bytes>::nr;
+	for (size_t j = 0; j < nc; j += nr) {
+		size_t w = std::min(nr, nc - j);
+		for (size_t p = 0; p < kc; ++p, bp += nr) {
+			const _Td *rb = b + p * ldb + j;
+			for (size_t q = 0; q < w; ++q) {
+				bp[q] = rb[q];
+			}
+			for (size_t q = w; q < nr; ++q) {
+				bp[q] = 0;
+			}
 		}
 	}
-	return c;
 }
 
+/**
+ * mc x kc of A into MR-row panels, column by column within a panel, zero-padded
+ */
 template<typename _Td>
-Matrix<_Td> operator-(const Matrix<_Td> &a, const Matrix<_Td> &b)
+DIAMOND_GEMM_INLINE inline void _PackA(const _Td *a, size_t lda, size_t mc, size_t kc, _Td *ap)
 {
-	if (a.RowSize() != b.RowSize() || a.ColSize() != b.ColSize()) {
-		throw std::invalid_argument("different matrics\'s sizes");
-	}
-	Matrix<_Td> c(a.RowSize(), a.ColSize());
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < a.ColSize(); ++j) {
-			c[i][j] = a[i][j] - b[i][j];
+	for (size_t i = 0; i < mc; i += GEMM_MR) {
+		size_t h = std::min(GEMM_MR, mc - i);
+		for (size_t p = 0; p < kc; ++p, ap += GEMM_MR) {
+			for (size_t r = 0; r < h; ++r) {
+				ap[r] = a[(i + r) * lda + p];
+			}
+			for (size_t r = h; r < GEMM_MR; ++r) {
+				ap[r] = 0;
+			}
 		}
 	}
-	return c;
 }
-template<typename _Td>
-bool operator==(const Matrix<_Td> &a, const Matrix<_Td> &b)
+
+/**
+ * C[0, mr) x [0, nr) += the MR x NR tile of the packed panels ap and bp over kc steps;
+ * the eight accumulators are named, not an array, so that they stay in registers,
+ * and without vector extensions the tile is summed in a plain array instead
+ */
+template<typename _Td, size_t _Bytes>
+DIAMOND_GEMM_INLINE inline void _GemmTile(size_t kc, const _Td *ap, const _Td *bp, _Td *c, size_t ldc, size_t mr, size_t nr)
 {
-	if (a.RowSize() != b.RowSize() || a.ColSize() != b.ColSize()) {
-		return false;
+#ifdef DIAMOND_GEMM_SIMD
+	typedef typename GemmVec<_Td, _Bytes>::type vec;
+	const size_t w = GemmVec<_Td, _Bytes>::width;
+	vec c00 = {}, c01 = {}, c10 = {}, c11 = {}, c20 = {}, c21 = {}, c30 = {}, c31 = {};
+	for (size_t p = 0; p < kc; ++p, ap += GEMM_MR, bp += 2 * w) {
+		vec b0, b1;
+		__builtin_memcpy(&b0, bp, sizeof(vec));
+		__builtin_memcpy(&b1, bp + w, sizeof(vec));
+		c00 += ap[0] * b0, c01 += ap[0] * b1;
+		c10 += ap[1] * b0, c11 += ap[1] * b1;
+		c20 += ap[2] * b0, c21 += ap[2] * b1;
+		c30 += ap[3] * b0, c31 += ap[3] * b1;
 	}
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < a.ColSize(); ++j) {
-			if (a[i][j] != b[i][j])
-				return false;
+	_Td tile[GEMM_MR][2 * GemmVec<_Td, _Bytes>::width];
+	__builtin_memcpy(tile[0], &c00, sizeof(vec)), __builtin_memcpy(tile[0] + w, &c01, sizeof(vec));
+	__builtin_memcpy(tile[1], &c10, sizeof(vec)), __builtin_memcpy(tile[1] + w, &c11, sizeof(vec));
+	__builtin_memcpy(tile[2], &c20, sizeof(vec)), __builtin_memcpy(tile[2] + w, &c21, sizeof(vec));
+	__builtin_memcpy(tile[3], &c30, sizeof(vec)), __builtin_memcpy(tile[3] + w, &c31, sizeof(vec));
+#else
+	const size_t w = GemmVec<_Td, _Bytes>::nr;
+	_Td tile[GEMM_MR][GemmVec<_Td, _Bytes>::nr] = {};
+	for (size_t p = 0; p < kc; ++p, ap += GEMM_MR, bp += w) {
+		for (size_t r = 0; r < GEMM_MR; ++r) {
+			for (size_t q = 0; q < w; ++q) {
+				tile[r][q] += ap[r] * bp[q];
+			}
+		}
+	}
+#endif
+	for (size_t r = 0; r < mr; ++r) {
+		for (size_t q = 0; q < nr; ++q) {
+			c[r * ldc + q] += tile[r][q];
 		}
 	}
-	return true;
 }
 
-template<typename _Td>
-Matrix<_Td> operator-(const Matrix<_Td> &mat)
+/**
+ * rows [ic0, m) of C in steps of step row blocks, against one packed panel of B
+ */
+template<typename _Td, size_t _Bytes>
+DIAMOND_GEMM_INLINE inline void _GemmRows(const _Td *a, size_t lda, const _Td *bp, _Td *c, size_t ldc,
+                                          size_t m, size_t nc, size_t kc, size_t ic0, size_t step)
 {
-	Matrix<_Td> result(mat.RowSize(), mat.ColSize());
-	for (size_t i = 0; i < mat.RowSize(); ++i) {
-		for (size_t j = 0; j < mat.ColSize(); ++j) {
-			result[i][j] = -mat[i][j];
+	const size_t nr = GemmVec<_Td, _Bytes>::nr;
+	std::unique_ptr<_Td[]> ap(new _Td[GEMM_MC * kc]);
+	for (size_t ic = ic0; ic < m; ic += step) {
+		size_t mc = std::min(GEMM_MC, m - ic);
+		_PackA(a + ic * lda, lda, mc, kc, ap.get());
+		for (size_t jr = 0; jr < nc; jr += nr) {
+			for (size_t ir = 0; ir < mc; ir += GEMM_MR) {
+				_GemmTile<_Td, _Bytes>(kc, ap.get() + ir * kc, bp + jr * kc, c + (ic + ir) * ldc + jr, ldc,
+				          std::min(GEMM_MR, mc - ir), std::min(nr, nc - jr));
+			}
 		}
 	}
-	return result;
 }
 
-template<typename _Td>
-Matrix<_Td> operator-(Matrix<_Td> &&mat)
+/**
+ * C += A * B, A m x k, B k x n, all row-major with the given strides
+ */
+template<typename _Td, size_t _Bytes>
+DIAMOND_GEMM_INLINE inline void _GemmPacked(const _Td *a, size_t lda, const _Td *b, size_t ldb, _Td *c, size_t ldc,
+                                            size_t m, size_t n, size_t k)
 {
-	for (size_t i = 0; i < mat.RowSize(); ++i) {
-		for (size_t j = 0; j < mat.ColSize(); ++j) {
-			mat[i][j] = -mat[i][j];
+	const size_t nr = GemmVec<_Td, _Bytes>::nr;
+	std::unique_ptr<_Td[]> bp(new _Td[GEMM_KC * ((GEMM_NC + nr - 1) / nr * nr)]);
+	for (size_t jc = 0; jc < n; jc += GEMM_NC) {
+		size_t nc = std::min(GEMM_NC, n - jc);
+		for (size_t pc = 0; pc < k; pc += GEMM_KC) {
+			size_t kc = std::min(GEMM_KC, k - pc);
+			_PackB<_Td, _Bytes>(b + pc * ldb + jc, ldb, kc, nc, bp.get());
+#ifdef DIAMOND_MATRIX_THREADS
+			size_t threads = std::min<size_t>(std::thread::hardware_concurrency(), (m + GEMM_MC - 1) / GEMM_MC);
+			if (m * n * k >= GEMM_THREADED && threads > 1) {
+				std::vector<std::thread> pool;
+				for (size_t t = 1; t < threads; ++t) {
+					pool.emplace_back([=, &bp] {
+						_GemmRows<_Td, _Bytes>(a + pc, lda, bp.get(), c + jc, ldc, m, nc, kc, t * GEMM_MC, threads * GEMM_MC);
+					});
+				}
+				_GemmRows<_Td, _Bytes>(a + pc, lda, bp.get(), c + jc, ldc, m, nc, kc, 0, threads * GEMM_MC);
+				for (std::thread &th : pool) {
+					th.join();
+				}
+				continue;
+			}
+#endif
+			_GemmRows<_Td, _Bytes>(a + pc, lda, bp.get(), c + jc, ldc, m, nc, kc, 0, GEMM_MC);
 		}
 	}
-	return mat;
+}
+
+template<typename _Td>
+void _Gemm(const _Td *a, size_t lda, const _Td *b, size_t ldb, _Td *c, size_t ldc, size_t m, size_t n, size_t k)
+{
+	_GemmPlain(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+#ifdef DIAMOND_GEMM_DISPATCH
+template<typename _Td>
+__attribute__((target("avx512f,fma"))) void _GemmAvx512(const _Td *a, size_t lda, const _Td *b, size_t ldb, _Td *c, size_t ldc,
+                                                        size_t m, size_t n, size_t k)
+{
+	_GemmPacked<_Td, 64>(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+template<typename _Td>
+__attribute__((target("avx2,fma"))) void _GemmAvx2(const _Td *a, size_t lda, const _Td *b, size_t ldb, _Td *c, size_t ldc,
+                                                   size_t m, size_t n, size_t k)
+{
+	_GemmPacked<_Td, 32>(a, lda, b, ldb, c, ldc, m, n, k);
 }
 
 /**
- * Multiplication of two matrics.
+ * 2 with AVX-512, 1 with AVX2, 0 otherwise; FMA is required for either
+ */
+inline int _SimdLevel()
+{
+	static const int level = !__builtin_cpu_supports("fma") ? 0
+		: __builtin_cpu_supports("avx512f") ? 2 : __builtin_cpu_supports("avx2") ? 1 : 0;
+	return level;
+}
+#endif
+
+/**
+ * the packed kernel for float and double, from GEMM_SMALL multiply-adds up
  */
 template<typename _Td>
-Matrix<_Td> operator*(const Matrix<_Td> &a, const Matrix<_Td> &b)
+void _GemmFloating(const _Td *a, size_t lda, const _Td *b, size_t ldb, _Td *c, size_t ldc, size_t m, size_t n, size_t k)
 {
-	if (a.ColSize() != b.RowSize()) {
-		throw std::invalid_argument("different matrics\'s sizes");
+	if (m * n * k < GEMM_SMALL) {
+		_GemmPlain(a, lda, b, ldb, c, ldc, m, n, k);
+		return;
 	}
-	Matrix<_Td> c(a.RowSize(), b.ColSize(), 0);
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < b.ColSize(); ++j) {
-			for (size_t k = 0; k < a.ColSize(); ++k) {
-				c[i][j] += a[i][k] * b[k][j];
+#ifdef DIAMOND_GEMM_DISPATCH
+	switch (_SimdLevel()) {
+	case 2:
+		_GemmAvx512(a, lda, b, ldb, c, ldc, m, n, k);
+		return;
+	case 1:
+		_GemmAvx2(a, lda, b, ldb, c, ldc, m, n, k);
+		return;
+	}
+#endif
+	_GemmPacked<_Td, 16>(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+inline void _Gemm(const double *a, size_t lda, const double *b, size_t ldb, double *c, size_t ldc, size_t m, size_t n, size_t k)
+{
+	_GemmFloating(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+inline void _Gemm(const float *a, size_t lda, const float *b, size_t ldb, float *c, size_t ldc, size_t m, size_t n, size_t k)
+{
+	_GemmFloating(a, lda, b, ldb, c, ldc, m, n, k);
+}
+
+/**
+ * b = a^T for a rows x cols: halve the longer side until a tile fits in L1,
+ * so both the reads and the writes stay cache-friendly at every size
+ */
+template<typename _Td>
+void _Transpose(const _Td *a, size_t lda, _Td *b, size_t ldb, size_t rows, size_t cols)
+{
+	if (rows <= 16 && cols <= 16) {
+		for (size_t i = 0; i < rows; ++i) {
+			for (size_t j = 0; j < cols; ++j) {
+				b[j * ldb + i] = a[i * lda + j];
 			}
 		}
+	} else if (rows >= cols) {
+		size_t half = rows / 2;
+		_Transpose(a, lda, b, ldb, half, cols);
+		_Transpose(a + half * lda, lda, b + half, ldb, rows - half, cols);
+	} else {
+		size_t half = cols / 2;
+		_Transpose(a, lda, b, ldb, rows, half);
+		_Transpose(a + half, lda, b + half * ldb, ldb, rows, cols - half);
 	}
-	return c;
+}
+
 }
 
 /**
- * Operations between a number and a matrix;
+ * A Matrix operand held by reference; the expression must not outlive it.
  */
 template<typename _Td>
-Matrix<_Td> operator*(const Matrix<_Td> &a, const _Td &b)
-{
-	Matrix<_Td> c(a.RowSize(), a.ColSize());
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < a.ColSize(); ++j) {
-			c[i][j] = a[i][j] * b;
+class MatrixLeaf : public MatrixExpression {
+	const _Td *origin;
+	size_t n_rows, n_cols, stride;
+public:
+	typedef _Td value_type;
+	static constexpr bool _is_leaf = true;
+	MatrixLeaf(const Matrix<_Td> &mat)
+		: origin(mat[0]), n_rows(mat.RowSize()), n_cols(mat.ColSize()), stride(mat.Stride()) {}
+	inline const size_t & RowSize() const
+	{
+		return n_rows;
+	}
+	inline const size_t & ColSize() const
+	{
+		return n_cols;
+	}
+	inline const size_t & Stride() const
+	{
+		return stride;
+	}
+	const _Td * _Origin() const
+	{
+		return origin;
+	}
+	const _Td & operator()(const size_t &i, const size_t &j) const
+	{
+		return origin[i * stride + j];
+	}
+	/**
+	 * whether the expression reads the buffer at all
+	 */
+	bool _Overlaps(const void *buffer) const
+	{
+		return origin == buffer;
+	}
+	/**
+	 * whether the expression reads element (i, j) of the buffer for any other (i, j) of its own
+	 */
+	bool _Reorders(const void *) const
+	{
+		return false;
+	}
+};
+
+/**
+ * A temporary Matrix operand moved into the expression,
+ * so that an expression kept in an auto variable does not dangle.
+ */
+template<typename _Td>
+class MatrixHolder : public MatrixExpression {
+	Matrix<_Td> mat;
+public:
+	typedef _Td value_type;
+	static constexpr bool _is_leaf = true;
+	MatrixHolder(Matrix<_Td> &&_mat)
+		: mat(std::move(_mat)) {}
+	inline const size_t & RowSize() const
+	{
+		return mat.RowSize();
+	}
+	inline const size_t & ColSize() const
+	{
+		return mat.ColSize();
+	}
+	inline const size_t & Stride() const
+	{
+		return mat.Stride();
+	}
+	const _Td * _Origin() const
+	{
+		return mat[0];
+	}
+	const _Td & operator()(const size_t &i, const size_t &j) const
+	{
+		return mat[i][j];
+	}
+	bool _Overlaps(const void *buffer) const
+	{
+		return mat[0] == buffer;
+	}
+	bool _Reorders(const void *) const
+	{
+		return false;
+	}
+};
+
+/**
+ * op applied to every element of an expression
+ */
+template<typename _E, typename _Op>
+class MatrixUnary : public MatrixExpression {
+	_E expr;
+	_Op op;
+public:
+	typedef typename _E::value_type value_type;
+	MatrixUnary(_E &&_expr, const _Op &_op)
+		: expr(std::move(_expr)), op(_op) {}
+	inline const size_t & RowSize() const
+	{
+		return expr.RowSize();
+	}
+	inline const size_t & ColSize() const
+	{
+		return expr.ColSize();
+	}
+	value_type operator()(const size_t &i, const size_t &j) const
+	{
+		return op(expr(i, j));
+	}
+	bool _Overlaps(const void *buffer) const
+	{
+		return expr._Overlaps(buffer);
+	}
+	bool _Reorders(const void *buffer) const
+	{
+		return expr._Reorders(buffer);
+	}
+};
+
+/**
+ * op applied to the elements of two expressions of the same shape
+ */
+template<typename _L, typename _R, typename _Op>
+class MatrixBinary : public MatrixExpression {
+	_L lhs;
+	_R rhs;
+	_Op op;
+public:
+	typedef typename _L::value_type value_type;
+	static_assert(std::is_same<value_type, typename _R::value_type>::value, "different matrics\'s element types");
+	MatrixBinary(_L &&_lhs, _R &&_rhs, const _Op &_op)
+		: lhs(std::move(_lhs)), rhs(std::move(_rhs)), op(_op)
+	{
+		if (lhs.RowSize() != rhs.RowSize() || lhs.ColSize() != rhs.ColSize()) {
+			throw std::invalid_argument("different matrics\'s sizes");
 		}
 	}
-	return c;
+	inline const size_t & RowSize() const
+	{
+		return lhs.RowSize();
+	}
+	inline const size_t & ColSize() const
+	{
+		return lhs.ColSize();
+	}
+	value_type operator()(const size_t &i, const size_t &j) const
+	{
+		return op(lhs(i, j), rhs(i, j));
+	}
+	bool _Overlaps(const void *buffer) const
+	{
+		return lhs._Overlaps(buffer) || rhs._Overlaps(buffer);
+	}
+	bool _Reorders(const void *buffer) const
+	{
+		return lhs._Reorders(buffer) || rhs._Reorders(buffer);
+	}
+};
+
+/**
+ * An expression read with its row and column indices swapped, i.e. a Matrix
+ * seen through swapped strides; nothing is copied until it is evaluated.
+ */
+template<typename _E>
+class MatrixTransposed : public MatrixExpression {
+	_E expr;
+public:
+	typedef typename _E::value_type value_type;
+	static constexpr bool _is_transposed_leaf = _E::_is_leaf;
+	explicit MatrixTransposed(_E &&_expr)
+		: expr(std::move(_expr)) {}
+	inline const size_t & RowSize() const
+	{
+		return expr.ColSize();
+	}
+	inline const size_t & ColSize() const
+	{
+		return expr.RowSize();
+	}
+	decltype(auto) operator()(const size_t &i, const size_t &j) const
+	{
+		return expr(j, i);
+	}
+	bool _Overlaps(const void *buffer) const
+	{
+		return expr._Overlaps(buffer);
+	}
+	bool _Reorders(const void *buffer) const
+	{
+		return expr._Overlaps(buffer);
+	}
+	/**
+	 * a transposed Matrix on its own goes through the cache-oblivious kernel
+	 * instead of a strided element-by-element walk
+	 */
+	void _Store(value_type *out, const size_t &ldo) const
+	{
+		detail::_Transpose(expr._Origin(), expr.Stride(), out, ldo, expr.RowSize(), expr.ColSize());
+	}
+};
+
+namespace detail {
+
+template<typename _Tm>
+struct _IsMatrix : std::false_type {};
+template<typename _Td>
+struct _IsMatrix<Matrix<_Td>> : std::true_type {};
+
+template<typename _E>
+struct _IsExpr : std::integral_constant<bool, _IsMatrix<typename std::decay<_E>::type>::value
+	|| std::is_base_of<MatrixExpression, typename std::decay<_E>::type>::value> {};
+
+template<typename... _E>
+using _IfExpr = typename std::enable_if<std::conjunction<_IsExpr<_E>...>::value>::type;
+
+template<typename _E>
+using _Value = typename std::decay<_E>::type::value_type;
+
+/**
+ * How an operand is stored in an expression: a Matrix lvalue by reference,
+ * a Matrix rvalue by moving it in, and a sub-expression by value.
+ */
+template<typename _E>
+struct _OperandOf {
+	typedef typename std::decay<_E>::type type;
+};
+template<typename _Td>
+struct _OperandOf<Matrix<_Td>> {
+	typedef MatrixHolder<_Td> type;
+};
+template<typename _Td>
+struct _OperandOf<Matrix<_Td> &> {
+	typedef MatrixLeaf<_Td> type;
+};
+template<typename _Td>
+struct _OperandOf<const Matrix<_Td> &> {
+	typedef MatrixLeaf<_Td> type;
+};
+template<typename _Td>
+struct _OperandOf<const Matrix<_Td>> {
+	typedef MatrixLeaf<_Td> type;
+};
+template<typename _E>
+using _Operand = typename _OperandOf<_E>::type;
+
+/**
+ * element access for anything that is a Matrix or an expression
+ */
+template<typename _Td>
+MatrixLeaf<_Td> _Access(const Matrix<_Td> &mat)
+{
+	return MatrixLeaf<_Td>(mat);
+}
+template<typename _E, typename = _IfNode<_E>>
+const _E & _Access(const _E &expr)
+{
+	return expr;
+}
+
+/**
+ * a Matrix as it is, an expression evaluated into a new one
+ */
+template<typename _Td>
+const Matrix<_Td> & _Evaluate(const Matrix<_Td> &mat)
+{
+	return mat;
+}
+template<typename _E, typename = _IfNode<_E>>
+Matrix<typename _E::value_type> _Evaluate(const _E &expr)
+{
+	return Matrix<typename _E::value_type>(expr);
 }
 
+struct _Negate {
+	template<typename _Td>
+	_Td operator()(const _Td &x) const
+	{
+		return -x;
+	}
+};
+
 template<typename _Td>
-Matrix<_Td> operator*(const _Td &b, const Matrix<_Td> &a)
+struct _Scale {
+	_Td factor;
+	_Td operator()(const _Td &x) const
+	{
+		return x * factor;
+	}
+};
+
+template<typename _Td>
+struct _Divide {
+	double divisor;
+	_Td operator()(const _Td &x) const
+	{
+		return x / divisor;
+	}
+};
+
+struct _Plus {
+	template<typename _Td>
+	_Td operator()(const _Td &x, const _Td &y) const
+	{
+		return x + y;
+	}
+};
+
+struct _Minus {
+	template<typename _Td>
+	_Td operator()(const _Td &x, const _Td &y) const
+	{
+		return x - y;
+	}
+};
+
+}
+
+/**
+ * Sum of two matrics.
+ */
+template<typename _L, typename _R, typename = detail::_IfExpr<_L, _R>>
+MatrixBinary<detail::_Operand<_L>, detail::_Operand<_R>, detail::_Plus> operator+(_L &&a, _R &&b)
+{
+	return MatrixBinary<detail::_Operand<_L>, detail::_Operand<_R>, detail::_Plus>(
+		detail::_Operand<_L>(std::forward<_L>(a)), detail::_Operand<_R>(std::forward<_R>(b)), detail::_Plus());
+}
+
+template<typename _L, typename _R, typename = detail::_IfExpr<_L, _R>>
+MatrixBinary<detail::_Operand<_L>, detail::_Operand<_R>, detail::_Minus> operator-(_L &&a, _R &&b)
+{
+	return MatrixBinary<detail::_Operand<_L>, detail::_Operand<_R>, detail::_Minus>(
+		detail::_Operand<_L>(std::forward<_L>(a)), detail::_Operand<_R>(std::forward<_R>(b)), detail::_Minus());
+}
+
+template<typename _L, typename _R, typename = detail::_IfExpr<_L, _R>>
+bool operator==(const _L &a, const _R &b)
 {
-	Matrix<_Td> c(a.RowSize(), a.ColSize());
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < a.ColSize(); ++j) {
-			c[i][j] = a[i][j] * b;
+	const auto &ea = detail::_Access(a);
+	const auto &eb = detail::_Access(b);
+	if (ea.RowSize() != eb.RowSize() || ea.ColSize() != eb.ColSize()) {
+		return false;
+	}
+	for (size_t i = 0; i < ea.RowSize(); ++i) {
+		for (size_t j = 0; j < ea.ColSize(); ++j) {
+			if (ea(i, j) != eb(i, j))
+				return false;
 		}
 	}
-	return c;
+	return true;
+}
+
+/**
+ * a Matrix rvalue is negated in place below; everything else lazily
+ */
+template<typename _E, typename = detail::_IfExpr<_E>,
+         typename = typename std::enable_if<!detail::_IsMatrix<_E>::value>::type>
+MatrixUnary<detail::_Operand<_E>, detail::_Negate> operator-(_E &&mat)
+{
+	return MatrixUnary<detail::_Operand<_E>, detail::_Negate>(detail::_Operand<_E>(std::forward<_E>(mat)), detail::_Negate());
 }
 
 template<typename _Td>
-Matrix<_Td> operator/(const Matrix<_Td> &a, const double &b)
+Matrix<_Td> operator-(Matrix<_Td> &&mat)
 {
-	Matrix<_Td> c(a.RowSize(), a.ColSize());
-	for (size_t i = 0; i < a.RowSize(); ++i) {
-		for (size_t j = 0; j < a.ColSize(); ++j) {
-			c[i][j] = a[i][j] / b;
+	for (size_t i = 0; i < mat.RowSize(); ++i) {
+		_Td *rm = mat[i];
+		for (size_t j = 0; j < mat.ColSize(); ++j) {
+			rm[j] = -rm[j];
 		}
 	}
-	return c;
+	return std::move(mat);
+}
+
+/**
+ * Operations between a number and a matrix;
+ */
+template<typename _E, typename = detail::_IfExpr<_E>>
+MatrixUnary<detail::_Operand<_E>, detail::_Scale<detail::_Value<_E>>> operator*(_E &&a, const detail::_Value<_E> &b)
+{
+	return MatrixUnary<detail::_Operand<_E>, detail::_Scale<detail::_Value<_E>>>(
+		detail::_Operand<_E>(std::forward<_E>(a)), detail::_Scale<detail::_Value<_E>>{b});
+}
+
+template<typename _E, typename = detail::_IfExpr<_E>>
+MatrixUnary<detail::_Operand<_E>, detail::_Scale<detail::_Value<_E>>> operator*(const detail::_Value<_E> &b, _E &&a)
+{
+	return std::forward<_E>(a) * b;
+}
+
+template<typename _E, typename = detail::_IfExpr<_E>>
+MatrixUnary<detail::_Operand<_E>, detail::_Divide<detail::_Value<_E>>> operator/(_E &&a, const double &b)
+{
+	return MatrixUnary<detail::_Operand<_E>, detail::_Divide<detail::_Value<_E>>>(
+		detail::_Operand<_E>(std::forward<_E>(a)), detail::_Divide<detail::_Value<_E>>{b});
+}
+
+template<typename _E, typename = detail::_IfExpr<_E>>
+MatrixTransposed<detail::_Operand<_E>> Transpose(_E &&a)
+{
+	return MatrixTransposed<detail::_Operand<_E>>(detail::_Operand<_E>(std::forward<_E>(a)));
 }
 
+/**
+ * Multiplication of two matrics.
+ * float and double go through the packed, register-tiled kernel,
+ * other element types through the blocked i-k-j loop.
+ */
 template<typename _Td>
-Matrix<_Td> Transpose(const Matrix<_Td> &a)
+Matrix<_Td> operator*(const Matrix<_Td> &a, const Matrix<_Td> &b)
 {
-	Matrix<_Td> res(a.ColSize(), a.RowSize());
-	for (size_t i = 0; i < a.ColSize(); ++i) {
-		for (size_t j = 0; j < a.RowSize(); ++j) {
-			res[i][j] = a[j][i];
-		}
+	if (a.ColSize() != b.RowSize()) {
+		throw std::invalid_argument("different matrics\'s sizes");
 	}
-	return res;
+	Matrix<_Td> c(a.RowSize(), b.ColSize(), 0);
+	detail::_Gemm(a[0], a.Stride(), b[0], b.Stride(), c[0], c.Stride(), a.RowSize(), b.ColSize(), a.ColSize());
+	return c;
+}
+
+/**
+ * operands that are still expressions are evaluated first
+ */
+template<typename _L, typename _R, typename = detail::_IfExpr<_L, _R>,
+         typename = typename std::enable_if<!(detail::_IsMatrix<typename std::decay<_L>::type>::value
+                                              && detail::_IsMatrix<typename std::decay<_R>::type>::value)>::type>
+Matrix<detail::_Value<_L>> operator*(const _L &a, const _R &b)
+{
+	const auto &ma = detail::_Evaluate(a);
+	const auto &mb = detail::_Evaluate(b);
+	return ma * mb;
 }
 
 template<typename _Td>
@@ -235,6 +1079,12 @@ std::ostream & operator<<(std::ostream &stream, const Matrix<_Td> &mat)
 	return stream;
 }
 
+template<typename _E, typename = detail::_IfNode<_E>>
+std::ostream & operator<<(std::ostream &stream, const _E &expr)
+{
+	return stream << Matrix<typename _E::value_type>(expr);
+}
+
 template<typename _Td>
 Matrix<_Td> I(const size_t &n)
 {
@@ -245,6 +1095,9 @@ Matrix<_Td> I(const size_t &n)
 	return res;
 }
 
+/**
+ * every step moves its product into place instead of copying it
+ */
 template<typename _Td>
 Matrix<_Td> Pow(Matrix<_Td> A, size_t &b)
 {
@@ -263,4 +1116,8 @@ Matrix<_Td> Pow(Matrix<_Td> A, size_t &b)
 }
 
 }
+
+#undef DIAMOND_GEMM_INLINE
+#undef DIAMOND_GEMM_SIMD
+#undef DIAMOND_GEMM_DISPATCH
 #endif
@@ -0,0 +1,1251 @@
+#include "list.hpp"
+#include "indexed_list.hpp"
+#include "intrusive_list.hpp"
+#include "compact_list.hpp"
+#if !defined(SJTU_LIST_UNROLLED) && !defined(SJTU_LIST_INDEXED) && !defined(SJTU_LIST_COMPACT)
+#include "concurrent_queue.hpp"
+#include "serialize.hpp"
+#include "class-bint.hpp"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#ifdef SJTU_PARALLEL
+#include <atomic>
+#include <thread>
+#endif
+
+const int N = 5e4;
+
+class Int{
+public:
+    static int born;
+    static int dead;
+    int val;
+
+    Int(int val) : val(val) {
+        born++;
+    }
+    Int(const Int &rhs) {
+        val = rhs.val;
+        born++;
+    }
+    Int & operator = (const Int &rhs) {
+        born++; dead++;
+        val = rhs.val;
+        return *this;
+    }
+    bool operator == (const Int &rhs) const {
+        return val == rhs.val;
+    }
+    bool operator != (const Int &rhs) const {
+        return val != rhs.val;
+    }
+    friend bool operator < (const Int &lhs, const Int &rhs) {
+        return lhs.val < rhs.val;
+    }
+    ~Int() {
+        dead++;
+    }
+};
+
+int Int::born = 0;
+int Int::dead = 0;
+
+/**
+ * built with SJTU_LIST_UNROLLED, sjtu::list moves elements between the slots of its chunks
+ * where the node list relinks nodes, and with SJTU_LIST_COMPACT between the pools of two lists:
+ * only the number of live elements is checked then
+ */
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_COMPACT)
+#define NOTHING_COPIED() (Int::born == Int::dead)
+#else
+#define NOTHING_COPIED() (!Int::born && !Int::dead)
+#endif
+
+template<typename T>
+bool equal(const std::list<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::list<T>::const_iterator itx = x.cbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return true;
+}
+
+template<typename It>
+It advance(It it, int k) {
+    while (k--) ++it;
+    return it;
+}
+
+bool testSpliceList() {
+    std::list<Int> ans1, ans2;
+    sjtu::list<Int> myList1, myList2;
+    for (int i = 0; i < N; ++i){
+        ans1.push_back(Int(i)), myList1.push_back(Int(i));
+        ans2.push_back(Int(-i)), myList2.push_back(Int(-i));
+    }
+
+    Int::born = Int::dead = 0;
+    int pos = rand() % N;
+    ans1.splice(advance(ans1.begin(), pos), ans2);
+    myList1.splice(advance(myList1.begin(), pos), myList2);
+    if (!NOTHING_COPIED() || !myList2.empty() || !equal(ans1, myList1) || !equal(ans2, myList2))
+        return false;
+
+    ans2.splice(ans2.end(), ans1), myList2.splice(myList2.end(), myList1);
+    return equal(ans1, myList1) && equal(ans2, myList2);
+}
+
+bool testSpliceElement() {
+    std::list<Int> ans1, ans2;
+    sjtu::list<Int> myList1, myList2;
+    for (int i = 0; i < N / 10; ++i){
+        ans1.push_back(Int(i)), myList1.push_back(Int(i));
+        ans2.push_back(Int(-i)), myList2.push_back(Int(-i));
+    }
+
+    Int::born = Int::dead = 0;
+    for (int i = 0; i < N / 10; ++i){
+        if (ans2.empty())
+            break;
+        int from = rand() % ans2.size(), to = rand() % (ans1.size() + 1);
+        if (rand() % 2){
+            ans1.splice(advance(ans1.begin(), to), ans2, advance(ans2.begin(), from));
+            myList1.splice(advance(myList1.begin(), to), myList2, advance(myList2.begin(), from));
+        } else {
+            // inside one list
+            from = rand() % ans1.size();
+            ans1.splice(advance(ans1.begin(), to), ans1, advance(ans1.begin(), from));
+            myList1.splice(advance(myList1.begin(), to), myList1, advance(myList1.begin(), from));
+        }
+    }
+    return NOTHING_COPIED() && equal(ans1, myList1) && equal(ans2, myList2);
+}
+
+bool testSpliceRange() {
+    std::list<Int> ans1, ans2;
+    sjtu::list<Int> myList1, myList2;
+    for (int i = 0; i < N / 10; ++i){
+        ans1.push_back(Int(i)), myList1.push_back(Int(i));
+        ans2.push_back(Int(-i)), myList2.push_back(Int(-i));
+    }
+
+    Int::born = Int::dead = 0;
+    for (int i = 0; i < N / 100; ++i){
+        int l = rand() % (ans2.size() + 1), r = rand() % (ans2.size() + 1);
+        if (l > r)
+            std::swap(l, r);
+        int to = rand() % (ans1.size() + 1);
+        ans1.splice(advance(ans1.begin(), to), ans2, advance(ans2.begin(), l), advance(ans2.begin(), r));
+        myList1.splice(advance(myList1.begin(), to), myList2, advance(myList2.begin(), l), advance(myList2.begin(), r));
+        if (ans1.size() != myList1.size() || ans2.size() != myList2.size())
+            return false;
+
+        // rotate a range to the front of the same list
+        l = rand() % (ans1.size() + 1), r = rand() % (ans1.size() + 1);
+        if (l > r)
+            std::swap(l, r);
+        if (l == 0)
+            l = r;
+        ans1.splice(ans1.begin(), ans1, advance(ans1.begin(), l), advance(ans1.begin(), r));
+        myList1.splice(myList1.begin(), myList1, advance(myList1.begin(), l), advance(myList1.begin(), r));
+        std::swap(ans1, ans2);
+        std::swap(myList1, myList2);
+    }
+    return NOTHING_COPIED() && equal(ans1, myList1) && equal(ans2, myList2);
+}
+
+bool testSpliceException() {
+    sjtu::list<int> myList, otherList;
+    sjtu::list<int>::arena_type arena;
+    sjtu::list<int> arenaList(arena);
+    int ans = 0;
+    otherList.push_back(1);
+    arenaList.push_back(2);
+
+    try{ myList.splice(otherList.end(), otherList); } catch (...) { ans++; }
+    try{ myList.splice(myList.end(), otherList, otherList.end()); } catch (...) { ans++; }
+    try{ myList.splice(myList.end(), otherList, myList.begin(), myList.end()); } catch (...) { ans++; }
+    try{ myList.splice(myList.end(), arenaList); } catch (...) { ans++; }
+    try{ myList.splice(myList.end(), otherList, otherList.begin()); } catch (...) { ans--; }
+
+    return ans == 4 && myList.size() == 1 && otherList.empty() && arenaList.size() == 1;
+}
+
+struct Record {
+    int key, id;
+    bool operator < (const Record &rhs) const {
+        return key < rhs.key;
+    }
+    bool operator == (const Record &rhs) const {
+        return key == rhs.key && id == rhs.id;
+    }
+};
+
+bool testSortStability() {
+    std::list<Record> ans;
+    sjtu::list<Record> myList;
+    for (int i = 0; i < N; ++i){
+        Record r = {rand() % 100, i};
+        ans.push_back(r), myList.push_back(r);
+    }
+
+    ans.sort(), myList.sort();
+    return equal(ans, myList);
+}
+
+bool testSortCompare() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    for (int i = 0; i < N; ++i){
+        int x = rand() % 3 ? rand() : rand() % 10;
+        ans.push_back(Int(x)), myList.push_back(Int(x));
+    }
+
+    Int::born = Int::dead = 0;
+    auto greater = [](const Int &a, const Int &b) { return b < a; };
+    ans.sort(greater), myList.sort(greater);
+    if (!NOTHING_COPIED() || !equal(ans, myList))
+        return false;
+
+    // sorted and reversed input
+    ans.sort(), myList.sort();
+    if (!equal(ans, myList))
+        return false;
+    ans.reverse(), myList.reverse();
+    ans.sort(), myList.sort();
+    if (!equal(ans, myList))
+        return false;
+
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_COMPACT)
+    // chunks and slot pools of such elements would be too large
+    return true;
+#else
+    // elements larger than the stack: sorting must not make a node on it
+    struct Huge {
+        int key;
+        char pad[16 << 20];
+        explicit Huge(int key) : key(key) {}
+        bool operator<(const Huge &rhs) const { return key < rhs.key; }
+    };
+    sjtu::list<Huge> huge;
+    for (int key : {3, 1, 2}) huge.emplace_back(key);
+    huge.sort();
+    return huge.front().key == 1 && (++huge.begin())->key == 2 && huge.back().key == 3;
+#endif
+}
+
+bool testSortException() {
+    sjtu::list<int> myList;
+    long long sum = 0;
+    for (int i = 0; i < N; ++i){
+        int x = rand();
+        myList.push_back(x);
+        sum += x;
+    }
+
+    int budget = N * 3;
+    try{
+        myList.sort([&budget](int a, int b) {
+            if (--budget == 0) throw sjtu::runtime_error();
+            return a < b;
+        });
+        return false;
+    } catch (sjtu::runtime_error &) {}
+
+    // every element survives and the links are intact in both directions
+    size_t cnt = 0;
+    for (auto it = myList.begin(); it != myList.end(); ++it)
+        sum -= *it, ++cnt;
+    for (auto it = myList.end(); it != myList.begin(); --it)
+        --cnt;
+    if (sum || cnt || myList.size() != N)
+        return false;
+    myList.sort();
+    int last = myList.front();
+    for (auto it = myList.begin(); it != myList.end(); ++it){
+        if (*it < last)
+            return false;
+        last = *it;
+    }
+    return true;
+}
+
+bool testMergeCompare() {
+    std::list<Int> ans1, ans2;
+    sjtu::list<Int> myList1, myList2;
+    for (int i = 0; i < N; ++i){
+        int x = rand() % 1000;
+        if (rand() % 2) ans1.push_back(Int(x)), myList1.push_back(Int(x));
+        else ans2.push_back(Int(x)), myList2.push_back(Int(x));
+    }
+    auto greater = [](const Int &a, const Int &b) { return b < a; };
+    ans1.sort(greater), ans2.sort(greater);
+    myList1.sort(greater), myList2.sort(greater);
+
+    Int::born = Int::dead = 0;
+    ans1.merge(ans2, greater), myList1.merge(myList2, greater);
+    return NOTHING_COPIED() && myList2.empty() && equal(ans1, myList1);
+}
+
+bool testUniquePredicate() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    for (int i = 0; i < N; ++i){
+        int x = rand() % 100;
+        ans.push_back(Int(x)), myList.push_back(Int(x));
+    }
+    auto sameTens = [](const Int &a, const Int &b) { return a.val / 10 == b.val / 10; };
+    ans.unique(sameTens), myList.unique(sameTens);
+    return equal(ans, myList);
+}
+
+bool testRemove() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    for (int i = 0; i < N; ++i){
+        int x = rand() % 10;
+        ans.push_back(Int(x)), myList.push_back(Int(x));
+    }
+
+    int live = Int::born - Int::dead;
+    size_t before = ans.size();
+    ans.remove(Int(3));
+    if (myList.remove(Int(3)) != before - ans.size() || !equal(ans, myList))
+        return false;
+    // the value to remove lives inside the list
+    ans.remove(ans.front()), myList.remove(myList.front());
+    if (!equal(ans, myList))
+        return false;
+
+    auto odd = [](const Int &a) { return a.val % 2 == 1; };
+    before = ans.size();
+    ans.remove_if(odd);
+    if (myList.remove_if(odd) != before - ans.size() || !equal(ans, myList))
+        return false;
+    return live - (Int::born - Int::dead) == (int)(2 * (N - ans.size()));
+}
+
+bool testArraySort() {
+    std::vector<int> ans;
+    int *a = new int[N];
+    for (int i = 0; i < N; ++i)
+        ans.push_back(a[i] = rand() % (N / 10));
+
+    int offset = N / 20;
+    auto byDistance = [offset](int x, int y) {
+        int dx = x > offset ? x - offset : offset - x, dy = y > offset ? y - offset : offset - y;
+        return dx < dy || (dx == dy && x < y);
+    };
+    std::sort(ans.begin(), ans.end(), byDistance);
+    sjtu::sort(a, a + N, byDistance);
+    bool okay = std::equal(ans.begin(), ans.end(), a);
+
+    std::sort(ans.begin(), ans.end());
+    sjtu::sort(a, a + N);
+    okay = okay && std::equal(ans.begin(), ans.end(), a);
+    delete [] a;
+    return okay;
+}
+
+bool testIteratorSort() {
+    // organ-pipe and few distinct keys used to push the old quicksort quadratic and its recursion off the stack
+    std::vector<int> ans, pipe;
+    for (int i = 0; i < 20 * N; ++i)
+        pipe.push_back(i < 10 * N ? i : 20 * N - i);
+    ans = pipe;
+    std::sort(ans.begin(), ans.end());
+    sjtu::sort(pipe.begin(), pipe.end());
+    bool okay = ans == pipe;
+
+    std::vector<std::string> words, expected;
+    for (int i = 0; i < N; ++i)
+        words.push_back(std::to_string(rand() % 7));
+    expected = words;
+    std::sort(expected.begin(), expected.end(), std::greater<std::string>());
+    sjtu::sort(words.begin(), words.end(), std::greater<std::string>());
+    return okay && words == expected;
+}
+
+bool testSearch() {
+    std::vector<int> sorted;
+    for (int i = 0; i < N; ++i)
+        sorted.push_back(rand() % (N / 10));
+    std::sort(sorted.begin(), sorted.end());
+    sjtu::eytzinger_index<int> index(sorted.begin(), sorted.end());
+
+    std::vector<int> keys;
+    for (int key = -1; key <= N / 10; ++key)
+        keys.push_back(key);
+    std::vector<std::vector<int>::iterator> lower(keys.size()), upper(keys.size());
+    sjtu::lower_bounds(sorted.begin(), sorted.end(), keys.begin(), keys.end(), lower.begin());
+    sjtu::upper_bounds(sorted.begin(), sorted.end(), keys.begin(), keys.end(), upper.begin());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto l = std::lower_bound(sorted.begin(), sorted.end(), keys[i]);
+        auto u = std::upper_bound(sorted.begin(), sorted.end(), keys[i]);
+        if (sjtu::lower_bound(sorted.begin(), sorted.end(), keys[i]) != l
+            || sjtu::upper_bound(sorted.begin(), sorted.end(), keys[i]) != u
+            || lower[i] != l || upper[i] != u
+            || index.lower_bound(keys[i]) != (size_t)(l - sorted.begin())
+            || index.upper_bound(keys[i]) != (size_t)(u - sorted.begin()))
+            return false;
+    }
+    return true;
+}
+
+bool testParallelSort() {
+    // a small grain so that even N elements are cut into many tasks
+    sjtu::parallel_policy policy(4, 1000);
+    std::vector<int> ans, a;
+    for (int i = 0; i < N; ++i)
+        ans.push_back(rand() % (N / 10));
+    a = ans;
+    std::sort(ans.begin(), ans.end());
+    sjtu::parallel_sort(a.begin(), a.end(), sjtu::less(), policy);
+    bool okay = a == ans;
+
+    std::vector<int> merged(2 * N), expected(2 * N);
+    sjtu::parallel_merge(a.begin(), a.end(), ans.begin(), ans.end(), merged.begin(), sjtu::less(), policy);
+    std::merge(a.begin(), a.end(), ans.begin(), ans.end(), expected.begin());
+    okay = okay && merged == expected;
+
+    // equal keys keep their order, as with list::sort()
+    std::list<Record> stdList;
+    sjtu::list<Record> myList;
+    for (int i = 0; i < N; ++i) {
+        Record r = {rand() % 100, i};
+        stdList.push_back(r), myList.push_back(r);
+    }
+    stdList.sort(), myList.parallel_sort(policy);
+    okay = okay && equal(stdList, myList);
+
+    // no element is copied, and a throwing comparator leaves the list untouched
+    sjtu::list<Int> ints;
+    for (int i = 0; i < N; ++i)
+        ints.push_back(Int(rand()));
+    std::vector<int> before;
+    for (const Int &x : ints)
+        before.push_back(x.val);
+    Int::born = Int::dead = 0;
+    int calls = 0;
+    try {
+        ints.parallel_sort([&calls](const Int &x, const Int &y) {
+            if (++calls == N) throw std::runtime_error("comparator");
+            return x < y;
+        }, sjtu::parallel_policy(1, 1000));
+        okay = false;
+    } catch (std::runtime_error &) {}
+    sjtu::list<Int>::iterator it = ints.begin();
+    for (size_t i = 0; i < before.size(); ++i, ++it)
+        okay = okay && it->val == before[i];
+    return okay && Int::born == 0 && Int::dead == 0;
+}
+
+bool testConcurrentQueue() {
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+    // the queue trades nodes with the node list only
+    return true;
+#else
+    sjtu::concurrent_queue<Int> queue;
+    for (int i = 0; i < N; ++i)
+        queue.push(Int(i));
+    Int x(-1);
+    bool okay = queue.size() == N;
+    for (int i = 0; i < 10; ++i)
+        okay = okay && queue.try_pop(x) && x.val == i;
+
+    // a batch goes in and everything comes out by relinking, no element is copied
+    sjtu::list<Int> batch, out;
+    for (int i = N; i < 2 * N; ++i)
+        batch.push_back(Int(i));
+    out.push_back(Int(-1));
+    Int::born = Int::dead = 0;
+    queue.push_all(batch);
+    okay = okay && batch.empty() && queue.size() == 2 * N - 10;
+    okay = okay && queue.drain_into(out) == 2 * N - 10 && queue.empty() && !queue.try_pop(x);
+    okay = okay && Int::born == 0 && Int::dead == 0 && out.size() == 2 * N - 9;
+    int expect = -1;
+    for (const Int &y : out) {
+        okay = okay && y.val == expect;
+        expect = expect == -1 ? 10 : expect + 1;
+    }
+    okay = okay && out.back().val == 2 * N - 1;
+
+    // the queue keeps working after a drain, and lists with an arena are refused
+    queue.push(Int(1)), queue.push(Int(2));
+    okay = okay && queue.try_pop(x) && x.val == 1 && queue.size() == 1;
+    sjtu::list<Int>::arena_type arena;
+    sjtu::list<Int> pooled(arena);
+    try {
+        queue.drain_into(pooled);
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+    okay = okay && queue.size() == 1 && pooled.empty();
+
+#ifdef SJTU_PARALLEL
+    // every element pushed by several producers comes out once, each producer's in order
+    const int producers = 4, consumers = 3, each = N / producers;
+    sjtu::concurrent_queue<std::pair<int, int>> shared;
+    std::vector<std::vector<int>> seen(consumers * producers);
+    std::atomic<int> taken(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&shared, p, each] {
+            sjtu::list<std::pair<int, int>> local;
+            for (int i = 0; i < each; ++i) {
+                if (i % 16 == 0) {
+                    shared.push_all(local);
+                    shared.push(std::make_pair(p, i));
+                } else {
+                    local.push_back(std::make_pair(p, i));
+                }
+            }
+            shared.push_all(local);
+        });
+    for (int c = 0; c < consumers; ++c)
+        threads.emplace_back([&, c] {
+            std::pair<int, int> item;
+            sjtu::list<std::pair<int, int>> local;
+            while (taken.load() < producers * each) {
+                if (c == 0 && shared.try_pop(item)) {
+                    seen[c * producers + item.first].push_back(item.second);
+                    ++taken;
+                } else if (c != 0 && shared.drain_into(local)) {
+                    taken += (int)local.size();
+                    for (const std::pair<int, int> &y : local)
+                        seen[c * producers + y.first].push_back(y.second);
+                    local.clear();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    for (std::thread &t : threads)
+        t.join();
+    for (int p = 0; p < producers; ++p) {
+        std::vector<int> all;
+        for (int c = 0; c < consumers; ++c) {
+            const std::vector<int> &mine = seen[c * producers + p];
+            okay = okay && std::is_sorted(mine.begin(), mine.end());
+            all.insert(all.end(), mine.begin(), mine.end());
+        }
+        std::sort(all.begin(), all.end());
+        okay = okay && all.size() == (size_t)each;
+        for (int i = 0; okay && i < each; ++i)
+            okay = all[i] == i;
+    }
+    okay = okay && shared.empty();
+#endif
+    return okay;
+#endif
+}
+
+bool testStats() {
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+    // only the node list keeps stats
+    return true;
+#else
+    sjtu::list<int> l;
+    if (!sjtu::list_stats::enabled) {
+        for (int i = 0; i < 100; ++i)
+            l.push_back(i);
+        l.sort();
+        const sjtu::list_stats &none = l.stats();
+        return none.allocations == 0 && none.steps == 0 && none.comparisons == 0 && none.calls[sjtu::list_stats::sort] == 0;
+    }
+    static int observed;
+    observed = 0;
+    sjtu::list_stats::observer = [](const sjtu::list_stats &, sjtu::list_stats::operation op, double ms) {
+        if (op == sjtu::list_stats::sort && ms >= 0) ++observed;
+    };
+    bool okay = l.stats().allocations == 1 && l.stats().frees == 0;
+    for (int i = 0; i < N; ++i)
+        l.push_back(rand());
+    for (int i = 0; i < N / 2; ++i)
+        l.pop_back();
+    okay = okay && l.stats().allocations == N + 1 && l.stats().frees == N / 2 && l.stats().peak_size == N;
+
+    size_t steps = 0;
+    for (sjtu::list<int>::const_iterator it = l.cbegin(); it != l.cend(); ++it)
+        ++steps;
+    okay = okay && l.stats().steps == steps && steps == l.size();
+
+    // every call of the comparator is counted
+    size_t calls = 0;
+    l.sort([&calls](int a, int b) { ++calls; return a < b; });
+    okay = okay && calls > 0 && l.stats().comparisons == calls && l.stats().calls[sjtu::list_stats::sort] == 1;
+    okay = okay && observed == 1;
+    size_t tests = 0;
+    l.unique([&tests](int a, int b) { ++tests; return a == b; });
+    okay = okay && tests > 0 && l.stats().comparisons == calls + tests;
+    okay = okay && l.stats().calls[sjtu::list_stats::unique] == 1;
+
+    l.reset_stats();
+    okay = okay && l.stats().allocations == 0 && l.stats().steps == 0 && l.stats().peak_size == l.size();
+    sjtu::list<int> other;
+    for (int i = 0; i < 10; ++i)
+        other.push_back(i);
+    l.merge(other);
+    okay = okay && l.stats().calls[sjtu::list_stats::merge] == 1 && l.stats().comparisons > 0 && l.stats().peak_size == l.size();
+    l.clear();
+    okay = okay && l.stats().frees == l.stats().peak_size && l.stats().calls[sjtu::list_stats::clear] == 1;
+    sjtu::list_stats::observer = nullptr;
+    return okay;
+#endif
+}
+
+/**
+ * looks into the tree of an indexed_list
+ */
+template<typename T>
+struct indexed_probe : sjtu::indexed_list<T> {
+    typedef typename sjtu::indexed_list<T>::node node;
+    static size_t depth(const node *t) { return t ? 1 + std::max(depth(t->left), depth(t->right)) : 0; }
+    size_t depth() const { return depth(this->root); }
+};
+
+bool testIndexedList() {
+    // positions follow inserts and erases anywhere
+    sjtu::indexed_list<Int> a;
+    std::vector<int> ans;
+    for (int i = 0; i < N; ++i) {
+        size_t k = rand() % (ans.size() + 1);
+        a.insert(a.nth(k), Int(i));
+        ans.insert(ans.begin() + k, i);
+        if (i % 4 == 3) {
+            size_t j = rand() % ans.size();
+            a.erase(a.nth(j));
+            ans.erase(ans.begin() + j);
+        }
+    }
+    bool okay = a.size() == ans.size();
+    for (int i = 0; okay && i < 1000; ++i) {
+        size_t k = rand() % ans.size();
+        sjtu::indexed_list<Int>::iterator it = a.nth(k);
+        okay = it->val == ans[k] && a.index_of(it) == k;
+        std::ptrdiff_t d = (std::ptrdiff_t)(rand() % ans.size()) - (std::ptrdiff_t)k;
+        a.advance(it, d);
+        okay = okay && it->val == ans[k + d] && a.index_of(it) == k + d;
+    }
+    okay = okay && a.nth(ans.size()) == a.end() && a.index_of(a.end()) == ans.size();
+    sjtu::indexed_list<Int>::iterator it = a.nth(1);
+    try {
+        a.advance(it, -2);
+        okay = false;
+    } catch (sjtu::index_out_of_bound &) {}
+    try {
+        a.nth(ans.size() + 1);
+        okay = false;
+    } catch (sjtu::index_out_of_bound &) {}
+    okay = okay && a.index_of(it) == 1;
+
+    // a range moves to another list without a copy, and both stay indexed
+    sjtu::indexed_list<Int> b;
+    b.push_back(Int(-1)), b.push_back(Int(-2));
+    size_t first = ans.size() / 4, last = ans.size() / 2;
+    Int::born = Int::dead = 0;
+    b.splice(b.nth(1), a, a.nth(first), a.nth(last));
+    okay = okay && Int::born == 0 && Int::dead == 0;
+    std::vector<int> moved(ans.begin() + first, ans.begin() + last);
+    ans.erase(ans.begin() + first, ans.begin() + last);
+    okay = okay && a.size() == ans.size() && b.size() == moved.size() + 2;
+    okay = okay && b.nth(0)->val == -1 && b.nth(b.size() - 1)->val == -2;
+    for (size_t k = 0; okay && k < moved.size(); k += 97)
+        okay = b.nth(k + 1)->val == moved[k];
+    for (size_t k = 0; okay && k < ans.size(); k += 89)
+        okay = a.nth(k)->val == ans[k];
+
+    // sort and reverse rebuild the index
+    a.sort();
+    std::sort(ans.begin(), ans.end());
+    for (size_t k = 0; okay && k < ans.size(); k += 101)
+        okay = a.nth(k)->val == ans[k];
+    a.reverse();
+    for (size_t k = 0; okay && k < ans.size(); k += 103)
+        okay = a.nth(ans.size() - 1 - k)->val == ans[k];
+
+    // lists draw priorities of their own: a list built of one-element lists stays balanced
+    indexed_probe<int> c;
+    for (int i = 0; i < N; ++i) {
+        sjtu::indexed_list<int> one;
+        one.push_back(i);
+        c.splice(i % 2 ? c.end() : c.nth(c.size() / 2), one);
+    }
+    okay = okay && c.size() == (size_t)N && c.depth() < 4 * sjtu::search_detail::floor_log2(N);
+    return okay;
+}
+
+struct by_age {};
+struct by_key {};
+/**
+ * an element in two intrusive lists at once, one per hook
+ */
+struct Task : sjtu::list_hook<by_age>, sjtu::list_hook<by_key> {
+    int age, key;
+    Task(int age, int key) : age(age), key(key) {}
+    bool operator<(const Task &rhs) const { return key < rhs.key; }
+    bool operator==(const Task &rhs) const { return key == rhs.key; }
+};
+
+bool testIntrusiveList() {
+    typedef sjtu::intrusive_list<Task, by_age> age_list;
+    typedef sjtu::intrusive_list<Task, by_key> key_list;
+    std::vector<Task> tasks;
+    for (int i = 0; i < N; ++i) tasks.emplace_back(i, rand() % 100);
+    age_list ages;
+    key_list keys;
+    for (Task &t : tasks) ages.push_back(t), keys.push_front(t);
+    bool okay = ages.size() == (size_t)N && keys.size() == (size_t)N;
+
+    // sorting one list relinks its hooks only: the other keeps its order
+    keys.sort();
+    std::vector<const Task *> ans;
+    for (const Task &t : tasks) ans.push_back(&t);
+    std::reverse(ans.begin(), ans.end());
+    std::stable_sort(ans.begin(), ans.end(), [](const Task *a, const Task *b) { return *a < *b; });
+    size_t k = 0;
+    for (Task &t : keys) okay = okay && &t == ans[k++];
+    int age = 0;
+    for (const Task &t : ages) okay = okay && t.age == age++;
+
+    // removing unlinks, the element is still alive and may be linked again
+    keys.unique();
+    okay = okay && keys.size() == 100;
+    size_t odd = ages.remove_if([](const Task &t) { return t.age % 2; });
+    okay = okay && odd == (size_t)N / 2 && ages.size() == (size_t)N / 2;
+    okay = okay && !static_cast<sjtu::list_hook<by_age> &>(tasks[1]).is_linked();
+    try {
+        ages.push_back(tasks[0]);
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+
+    age_list odds;
+    for (Task &t : tasks)
+        if (t.age % 2) odds.push_back(t);
+    odds.reverse();
+    okay = okay && odds.front().age == N - 1 && odds.iterator_to(tasks[N - 1]) == odds.begin();
+    odds.reverse();
+    ages.merge(odds, [](const Task &a, const Task &b) { return a.age < b.age; });
+    okay = okay && odds.empty() && ages.size() == (size_t)N;
+    age = 0;
+    for (const Task &t : ages) okay = okay && t.age == age++;
+    age_list parts[3];
+    for (int i = 0; i < N; ++i) parts[i % 3].splice(parts[i % 3].end(), ages, ages.begin());
+    ages.merge_all(parts, parts + 3, [](const Task &a, const Task &b) { return a.age < b.age; });
+    okay = okay && parts[0].empty() && parts[2].empty() && ages.size() == (size_t)N;
+    age = 0;
+    for (const Task &t : ages) okay = okay && t.age == age++;
+
+    // an element moves between lists of the same hook in O(1)
+    odds.splice(odds.end(), ages, ages.iterator_to(tasks[7]));
+    okay = okay && odds.size() == 1 && &odds.back() == &tasks[7] && ages.size() == (size_t)N - 1;
+    age_list moved(std::move(ages));
+    okay = okay && ages.empty() && moved.size() == (size_t)N - 1 && moved.front().age == 0;
+    moved.clear();
+    for (Task &t : tasks) okay = okay && !static_cast<sjtu::list_hook<by_age> &>(t).is_linked() == (&t != &tasks[7]);
+    return okay;
+}
+
+struct Checkpoint {
+    int id;
+    double weight;
+    char tag[3];
+};
+
+bool testSerialize() {
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+    // the binary format builds the chain of the node list only
+    return true;
+#else
+    sjtu::list<Checkpoint> records;
+    for (int i = 0; i < N; ++i) records.push_back(Checkpoint{i, i * 0.5, {'a', 'b', char('a' + i % 26)}});
+    auto same_records = [](sjtu::list<Checkpoint> &a, sjtu::list<Checkpoint> &b) {
+        if (a.size() != b.size()) return false;
+        auto it = b.begin();
+        for (const Checkpoint &r : a) {
+            if (r.id != it->id || r.weight != it->weight || memcmp(r.tag, it->tag, sizeof(r.tag)) != 0) return false;
+            ++it;
+        }
+        return true;
+    };
+
+    // a stream round trip replaces what was there
+    std::stringstream ss;
+    records.save(ss);
+    sjtu::list<Checkpoint> back;
+    back.push_back(Checkpoint{-1, 0, {}});
+    back.load(ss);
+    bool okay = same_records(records, back);
+
+    // the same bytes through a mapped file
+    std::string path = "/tmp/sjtu_list_eight_" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".bin";
+    records.save_file(path.c_str());
+    sjtu::list<Checkpoint> mapped;
+    mapped.load_file(path.c_str());
+    okay = okay && same_records(records, mapped);
+    std::remove(path.c_str());
+    sjtu::list<Checkpoint> empty;
+    empty.save_file(path.c_str());
+    mapped.load_file(path.c_str());
+    okay = okay && mapped.empty();
+    std::remove(path.c_str());
+
+    // another element size, a cut stream or a missing file leave the list as it was
+    std::stringstream ints;
+    sjtu::list<int>(5, 7).save(ints);
+    try {
+        back.load(ints);
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+    std::string cut = ss.str();
+    std::stringstream partial(cut.substr(0, cut.size() - sizeof(Checkpoint) / 2));
+    try {
+        back.load(partial);
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+    try {
+        back.load_file("/nonexistent/sjtu_list.bin");
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+    okay = okay && same_records(records, back);
+
+    // Bint writes its limbs, elements one after the other
+    sjtu::list<Util::Bint> bints, bints_back;
+    Util::Bint large = Util::Bint(1000000007);
+    for (int i = -500; i < 500; ++i) bints.push_back(Util::Bint(i) * large * large * large);
+    std::stringstream bs;
+    bints.save(bs);
+    bints_back.load(bs);
+    okay = okay && bints_back.size() == bints.size();
+    auto it = bints_back.begin();
+    for (const Util::Bint &b : bints) okay = okay && b == *it++;
+    sjtu::list<Util::Bint> one;
+    one.load(bs.seekg(0));
+    one.save_file(path.c_str());
+    one.load_file(path.c_str());
+    std::remove(path.c_str());
+    okay = okay && one.size() == bints.size() && one.front() == bints.front() && one.back() == bints.back();
+
+    // a corrupt length word or a dump cut short fails the stream and leaves the value as it was
+    Util::Bint kept(12345);
+    std::stringstream huge;
+    unsigned long long word = ~0ull;
+    huge.write(reinterpret_cast<const char *>(&word), sizeof(word));
+    huge.write("limbs", 5);
+    load_binary(huge, kept);
+    okay = okay && huge.fail() && kept == Util::Bint(12345);
+    std::stringstream full;
+    save_binary(full, large * large * large);
+    std::string bytes = full.str();
+    std::stringstream short_dump(bytes.substr(0, bytes.size() - 2));
+    load_binary(short_dump, kept);
+    return okay && short_dump.fail() && kept == Util::Bint(12345);
+#endif
+}
+
+bool testCompactList() {
+    // lists on one arena relink their slots: no copy, iterators and addresses stay valid
+    sjtu::compact_pool<Int> arena;
+    sjtu::compact_list<Int> a(arena), b(arena);
+    for (int i = 0; i < N; ++i) (i % 2 ? a : b).push_back(Int(i));
+    size_t slots = arena.capacity();
+    const Int *addr = &*b.begin();
+    Int::born = Int::dead = 0;
+    a.splice(a.begin(), b, b.begin());
+    a.merge(b);
+    bool okay = Int::born == 0 && Int::dead == 0 && &*a.begin() == addr;
+    okay = okay && b.empty() && a.size() == (size_t)N && a.arena() == &arena;
+    int prev = -1;
+    for (sjtu::compact_list<Int>::iterator p = ++a.begin(); okay && p != a.end(); ++p) {
+        okay = p->val > prev;
+        prev = p->val;
+    }
+    // freed slots are reused before the pool grows
+    a.clear();
+    for (int i = 0; i < N; ++i) b.push_back(Int(i));
+    okay = okay && arena.capacity() == slots;
+
+    // a list of its own pool hands its elements over by moving them
+    sjtu::compact_list<Int> c, d;
+    for (int i = 0; i < 100; ++i) c.push_back(Int(i)), d.push_back(Int(-i));
+    c.splice(c.end(), d, d.begin(), d.end());
+    okay = okay && c.arena() == nullptr && d.empty() && c.size() == 200 && c.back().val == -99;
+    try {
+        a.splice(a.end(), c);
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+    okay = okay && c.size() == 200;
+    return okay;
+}
+
+bool testMergeAll() {
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+    // the k-way merge is that of the node list
+    return true;
+#else
+    // earlier lists win ties: the same order as a stable sort of *this and the shards in turn
+    typedef std::pair<int, int> Tagged;
+    auto by_key = [](const Tagged &a, const Tagged &b) { return a.first < b.first; };
+    std::vector<sjtu::list<Tagged>> shards(33);
+    sjtu::list<Tagged> all;
+    std::vector<Tagged> ans;
+    for (int i = 0; i < N; ++i) {
+        int k = rand() % 34;
+        Tagged x(rand() % 1000, k);
+        (k == 33 ? all : shards[k]).push_back(x);
+    }
+    all.sort(by_key);
+    for (const Tagged &x : all) ans.push_back(x);
+    for (sjtu::list<Tagged> &l : shards) {
+        l.sort(by_key);
+        for (const Tagged &x : l) ans.push_back(x);
+    }
+    std::stable_sort(ans.begin(), ans.end(), by_key);
+    all.merge_all(shards.begin(), shards.end(), by_key);
+    bool okay = all.size() == ans.size();
+    size_t k = 0;
+    for (sjtu::list<Tagged>::iterator it = all.begin(); okay && it != all.end(); ++it, ++k)
+        okay = *it == ans[k];
+    for (sjtu::list<Tagged> &l : shards) okay = okay && l.empty();
+
+    // a range of pointers, with *this and a repeated list in it; nothing is copied
+    sjtu::list<Int> a, b, c;
+    for (int i = 0; i < 300; ++i) (i % 3 == 0 ? a : i % 3 == 1 ? b : c).push_back(Int(i));
+    sjtu::list<Int> *lists[] = {&b, &a, &c, &b};
+    Int::born = Int::dead = 0;
+    a.merge_all(lists, lists + 4);
+    okay = okay && Int::born == 0 && Int::dead == 0 && a.size() == 300 && b.empty() && c.empty();
+    int prev = -1;
+    for (sjtu::list<Int>::iterator it = a.begin(); okay && it != a.end(); ++it) {
+        okay = it->val == prev + 1;
+        prev = it->val;
+    }
+
+    // a list of another arena is refused before anything moves
+    sjtu::list<Int>::arena_type arena;
+    sjtu::list<Int> d(arena);
+    d.push_back(Int(1));
+    sjtu::list<Int> *mixed[] = {&a, &d};
+    try {
+        b.merge_all(mixed, mixed + 2);
+        okay = false;
+    } catch (sjtu::runtime_error &) {}
+    okay = okay && a.size() == 300 && d.size() == 1 && b.empty();
+
+    // a throwing comparator loses no element
+    for (int i = 0; i < 300; ++i) (i % 2 ? b : c).push_back(Int(i));
+    int calls = 0;
+    try {
+        a.merge_all(lists, lists + 4, [&calls](const Int &x, const Int &y) {
+            if (++calls == 100) throw 1;
+            return x < y;
+        });
+        okay = false;
+    } catch (int) {}
+    okay = okay && a.size() == 600 && b.empty() && c.empty();
+    long long sum = 0;
+    for (sjtu::list<Int>::iterator it = a.begin(); it != a.end(); ++it) sum += it->val;
+    return okay && sum == 2LL * 299 * 300 / 2;
+#endif
+}
+
+/**
+ * every element of a reversed list read backwards as well, so that a lazily reversed
+ * list is checked in both of its orientations
+ */
+template<typename T>
+bool equalBothWays(const std::list<T> &x, const sjtu::list<T> &y) {
+    if (!equal(x, y)) return false;
+    typename std::list<T>::const_reverse_iterator itx = x.crbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cend();
+    for (; itx != x.crend(); ++itx)
+        if (!(*itx == *--ity)) return false;
+    return ity == y.cbegin() && (x.empty() || (x.front() == y.front() && x.back() == y.back()));
+}
+bool testReversedOperations() {
+    // every operation on a reversed list, with SJTU_LIST_LAZY_REVERSE one that was never relinked
+    std::list<int> ans1, ans2;
+    sjtu::list<int> my1, my2;
+    bool okay = true;
+    for (int round = 0; okay && round < 200; ++round) {
+        int x = rand() % 100;
+        switch (rand() % 12) {
+        case 0: ans1.push_back(x), my1.push_back(x); break;
+        case 1: ans1.push_front(x), my1.push_front(x); break;
+        case 2: ans2.push_back(x), my2.push_back(x); break;
+        case 3: if (!ans1.empty()) ans1.pop_back(), my1.pop_back(); break;
+        case 4: if (!ans1.empty()) ans1.pop_front(), my1.pop_front(); break;
+        case 5: {
+            int k = rand() % (ans1.size() + 1);
+            ans1.insert(advance(ans1.begin(), k), 3, x), my1.insert(advance(my1.begin(), k), 3, x);
+            break;
+        }
+        case 6:
+            if (!ans1.empty()) {
+                int k = rand() % ans1.size();
+                ans1.erase(advance(ans1.begin(), k)), my1.erase(advance(my1.begin(), k));
+            }
+            break;
+        case 7: {
+            int k = rand() % (ans1.size() + 1);
+            ans1.splice(advance(ans1.begin(), k), ans2), my1.splice(advance(my1.begin(), k), my2);
+            break;
+        }
+        case 8:
+            if (!ans1.empty()) {
+                int k = rand() % ans1.size(), l = k + rand() % (ans1.size() - k + 1);
+                int j = rand() % (ans2.size() + 1);
+                ans2.splice(advance(ans2.begin(), j), ans1, advance(ans1.begin(), k), advance(ans1.begin(), l));
+                my2.splice(advance(my2.begin(), j), my1, advance(my1.begin(), k), advance(my1.begin(), l));
+            }
+            if (ans1.size() > 1) {
+                // within one list, pos outside the range
+                int k = 1 + rand() % (ans1.size() - 1), l = k + rand() % (ans1.size() - k + 1);
+                ans1.splice(ans1.begin(), ans1, advance(ans1.begin(), k), advance(ans1.begin(), l));
+                my1.splice(my1.begin(), my1, advance(my1.begin(), k), advance(my1.begin(), l));
+            }
+            break;
+        case 9: ans1.sort(), my1.sort(), ans2.sort(), my2.sort(); ans1.merge(ans2), my1.merge(my2); break;
+        case 10: ans1.unique(), my1.unique(); break;
+        default: {
+            ans2 = ans1, my2 = my1;
+            sjtu::list<int> copy(my1);
+            okay = equalBothWays(ans1, copy);
+        }
+        }
+        if (rand() % 3 == 0) ans1.reverse(), my1.reverse();
+        if (rand() % 3 == 0) ans2.reverse(), my2.reverse();
+        okay = okay && equalBothWays(ans1, my1) && equalBothWays(ans2, my2);
+    }
+
+    // reverse() builds no element, as tester8 of data/three checks on the node list
+    sjtu::list<Int> ints;
+    for (int i = 0; i < N; ++i)
+        ints.push_back(Int(i));
+    Int::born = Int::dead = 0;
+    ints.reverse();
+    return okay && NOTHING_COPIED() && ints.size() == (size_t)N && ints.front().val == N - 1 && ints.back().val == 0;
+}
+
+bool testExceptions() {
+    // cheap to copy and throw, and caught as std::exception with a static message
+    static_assert(std::is_nothrow_copy_constructible<sjtu::invalid_iterator>::value, "");
+    static_assert(std::is_base_of<std::exception, sjtu::container_is_empty>::value, "");
+    bool okay = true;
+    sjtu::list<int> l;
+    try {
+        l.pop_back();
+        okay = false;
+    } catch (std::exception &e) {
+        okay = okay && strcmp(e.what(), "container_is_empty") == 0;
+    }
+    try {
+        l.front();
+        okay = false;
+    } catch (sjtu::exception &e) {
+        okay = okay && e.code() == sjtu::errc::container_is_empty && strcmp(e.operation(), "front") == 0;
+        sjtu::exception copy = e;
+        okay = okay && copy.code() == e.code() && copy.what() == e.what();
+    }
+    try {
+        sjtu::list<int>::iterator it;
+        *it;
+        okay = false;
+    } catch (sjtu::invalid_iterator &e) {
+        okay = okay && strcmp(e.what(), "invalid_iterator") == 0 && e.size() == sjtu::exception::npos;
+    }
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+    // the try_ operations are those of the node list
+    return okay;
+#else
+    // the try_ operations report instead of throwing
+    int value = -1;
+    okay = okay && l.try_pop_front() == sjtu::errc::container_is_empty;
+    okay = okay && l.try_pop_back(value) == sjtu::errc::container_is_empty && value == -1;
+    okay = okay && l.try_erase(l.begin()) == sjtu::errc::container_is_empty;
+    for (int i = 0; i < 10; ++i) l.push_back(i);
+    okay = okay && l.try_pop_front(value) == sjtu::errc::ok && value == 0;
+    okay = okay && l.try_pop_back(value) == sjtu::errc::ok && value == 9;
+    okay = okay && l.try_pop_front() == sjtu::errc::ok && l.try_pop_back() == sjtu::errc::ok;
+    sjtu::list<int> other;
+    other.push_back(1);
+    sjtu::list<int>::iterator next = l.end();
+    okay = okay && l.try_erase(l.end(), next) == sjtu::errc::invalid_iterator && next == l.end();
+    okay = okay && l.try_erase(other.begin()) == sjtu::errc::invalid_iterator && other.size() == 1;
+    okay = okay && l.try_erase(++l.begin(), next) == sjtu::errc::ok && *next == 4;
+    okay = okay && l.size() == 5 && l.front() == 2 && l.back() == 7;
+    return okay;
+#endif
+}
+
+bool testBulkConstructors() {
+    std::vector<int> raw;
+    for (int i = 0; i < N; ++i)
+        raw.push_back(rand());
+
+    std::list<int> ans1(raw.begin(), raw.end());
+    sjtu::list<int> myList1(raw.begin(), raw.end());
+    std::list<int> ans2(N / 10, 7);
+    sjtu::list<int> myList2(N / 10, 7);
+    std::list<int> ans3{3, 1, 4, 1, 5};
+    sjtu::list<int> myList3{3, 1, 4, 1, 5};
+    sjtu::list<int> myList4(myList1.cbegin(), myList1.cend());
+    std::list<int> ans5(5, 3);
+    sjtu::list<int> myList5(5, 3);
+    return equal(ans1, myList1) && equal(ans2, myList2) && equal(ans3, myList3)
+        && equal(ans1, myList4) && equal(ans5, myList5);
+}
+
+bool testAssign() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    for (int i = 0; i < N; ++i)
+        ans.push_back(Int(i)), myList.push_back(Int(i));
+
+    std::vector<Int> raw;
+    for (int i = 0; i < N / 2; ++i)
+        raw.push_back(Int(rand()));
+    ans.assign(raw.begin(), raw.end()), myList.assign(raw.begin(), raw.end());
+    if (!equal(ans, myList))
+        return false;
+
+    ans.assign(N, Int(5)), myList.assign(N, Int(5));
+    if (!equal(ans, myList))
+        return false;
+
+    ans.assign({Int(1), Int(2), Int(3)}), myList.assign({Int(1), Int(2), Int(3)});
+    if (!equal(ans, myList))
+        return false;
+    ans = {Int(4)}, myList = {Int(4)};
+    if (!equal(ans, myList))
+        return false;
+    ans.assign(0, Int(0)), myList.assign(0, Int(0));
+    return equal(ans, myList) && myList.empty();
+}
+
+bool testRangeInsert() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    std::vector<Int> raw;
+    for (int i = 0; i < 100; ++i)
+        raw.push_back(Int(i));
+
+    for (int i = 0; i < 100; ++i) {
+        int pos = ans.empty() ? 0 : rand() % (ans.size() + 1), k = rand() % 50;
+        auto ansIt = advance(ans.begin(), pos);
+        auto myIt = advance(myList.begin(), pos);
+        switch (rand() % 3) {
+            case 0: ansIt = ans.insert(ansIt, raw.begin(), raw.begin() + k);
+                    myIt = myList.insert(myIt, raw.begin(), raw.begin() + k); break;
+            case 1: ansIt = ans.insert(ansIt, k, Int(-i));
+                    myIt = myList.insert(myIt, k, Int(-i)); break;
+            default: ansIt = ans.insert(ansIt, {Int(i), Int(i + 1)});
+                     myIt = myList.insert(myIt, {Int(i), Int(i + 1)});
+        }
+        if ((ansIt == ans.end()) != (myIt == myList.end()) || (ansIt != ans.end() && *ansIt != *myIt))
+            return false;
+    }
+    if (!equal(ans, myList))
+        return false;
+
+    sjtu::list<Int> other;
+    try { myList.insert(other.begin(), raw.begin(), raw.end()); return false; } catch (...) {}
+    return equal(ans, myList);
+}
+
+bool testAssignmentReuse() {
+    sjtu::list<Int> src, dst;
+    for (int i = 0; i < N; ++i)
+        src.push_back(Int(i)), dst.push_back(Int(-i));
+
+    int live = Int::born - Int::dead;
+    auto it = dst.begin();
+    dst = src;
+    // the nodes of dst are kept, only their values are assigned over
+    if (Int::born - Int::dead != live || *it != Int(0) || it != dst.begin())
+        return false;
+
+    src.pop_back();
+    dst = src;
+    if (dst.size() != src.size() || dst.back() != src.back())
+        return false;
+    src.push_back(Int(N)), src.push_back(Int(N + 1));
+    dst = src;
+    return dst.size() == src.size() && dst.back() == Int(N + 1);
+}
+
+int main(){
+    srand(time(NULL));
+    bool (*testList[])() = {
+        testSpliceList, testSpliceElement, testSpliceRange, testSpliceException,
+        testSortStability, testSortCompare, testSortException,
+        testMergeCompare, testUniquePredicate, testRemove, testArraySort,
+        testBulkConstructors, testAssign, testRangeInsert, testAssignmentReuse, testIteratorSort,
+        testSearch, testParallelSort, testConcurrentQueue, testStats,
+        testIndexedList, testIntrusiveList, testSerialize, testCompactList,
+        testMergeAll, testReversedOperations, testExceptions
+    };
+    const char* Messages[] = {
+        "Test 1: Testing splice() of a whole list...",
+        "Test 2: Testing splice() of one element...",
+        "Test 3: Testing splice() of a range...",
+        "Test 4: Testing splice() exception throw...",
+        "Test 5: Testing stability of sort()...",
+        "Test 6: Testing sort() with a comparator...",
+        "Test 7: Testing sort() with a throwing comparator...",
+        "Test 8: Testing merge() with a comparator...",
+        "Test 9: Testing unique() with a predicate...",
+        "Test 10: Testing remove() & remove_if()...",
+        "Test 11: Testing sjtu::sort() with a comparator...",
+        "Test 12: Testing range & fill constructors...",
+        "Test 13: Testing assign()...",
+        "Test 14: Testing insert() of a range...",
+        "Test 15: Testing node reuse of operator=...",
+        "Test 16: Testing sjtu::sort() on iterators and adversarial input...",
+        "Test 17: Testing lower_bound(), upper_bound() & eytzinger_index...",
+        "Test 18: Testing parallel_sort(), parallel_merge() & list::parallel_sort()...",
+        "Test 19: Testing concurrent_queue...",
+        "Test 20: Testing list stats...",
+        "Test 21: Testing indexed_list positions...",
+        "Test 22: Testing intrusive_list with two hooks...",
+        "Test 23: Testing binary save() & load()...",
+        "Test 24: Testing compact_list pools...",
+        "Test 25: Testing merge_all() of many lists...",
+        "Test 26: Testing operations on reversed lists...",
+        "Test 27: Testing exceptions & the try_ operations..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -0,0 +1,341 @@
+#include "class-bint.hpp"
+#include "class-matrix.hpp"
+#include "list.hpp"
+#include "utility.hpp"
+
+#include <iostream>
+#include <list>
+
+const int N = 5e4;
+
+class Int{
+public:
+    static int born;
+    static int dead;
+    static int moved;
+    int val;
+
+    Int(int val) : val(val) {
+        born++;
+    }
+    Int(int a, int b) : val(a * b) {
+        born++;
+    }
+    Int(const Int &rhs) {
+        val = rhs.val;
+        born++;
+    }
+    Int(Int &&rhs) noexcept {
+        val = rhs.val;
+        born++; moved++;
+    }
+    Int & operator = (const Int &rhs) {
+        born++; dead++;
+        val = rhs.val;
+        return *this;
+    }
+    bool operator == (const Int &rhs) const {
+        return val == rhs.val;
+    }
+    bool operator != (const Int &rhs) const {
+        return val != rhs.val;
+    }
+    friend bool operator < (const Int &lhs, const Int &rhs) {
+        return lhs.val < rhs.val;
+    }
+    ~Int() {
+        dead++;
+    }
+};
+
+int Int::born = 0;
+int Int::dead = 0;
+int Int::moved = 0;
+
+/**
+ * built with SJTU_LIST_UNROLLED, sjtu::list moves elements between the slots of its chunks:
+ * every element is still built once in place, but may be moved afterwards
+ */
+#ifdef SJTU_LIST_UNROLLED
+#define BUILT_IN_PLACE(n) (Int::born - Int::moved == (n) && Int::born - Int::dead == (n))
+#else
+#define BUILT_IN_PLACE(n) (Int::born == (n) && !Int::moved && !Int::dead)
+#endif
+
+void resetCounter() {
+    Int::born = Int::dead = Int::moved = 0;
+}
+
+template<typename T>
+bool equal(const std::list<T> &x, const sjtu::list<T> &y) {
+    if (x.size() != y.size())
+        return false;
+
+    typename std::list<T>::const_iterator itx = x.cbegin();
+    typename sjtu::list<T>::const_iterator ity = y.cbegin();
+    for (; itx != x.cend() && ity != y.cend(); ++itx, ++ity)
+        if (!(*itx == *ity))
+            return false;
+
+    return true;
+}
+
+sjtu::list<Int> makeList(int n) {
+    sjtu::list<Int> res;
+    for (int i = 0; i < n; ++i)
+        res.emplace_back(i);
+    return res;
+}
+
+bool testMoveConstructor() {
+    sjtu::list<Int> src;
+    for (int i = 0; i < N; ++i)
+        src.emplace_back(i);
+
+    resetCounter();
+    sjtu::list<Int> dst(std::move(src));
+    if (Int::born || Int::dead || dst.size() != N || src.size() != 0)
+        return false;
+
+    int expect = 0;
+    for (auto it = dst.cbegin(); it != dst.cend(); ++it)
+        if (it->val != expect++)
+            return false;
+
+    // the moved-from list is a valid empty list
+    if (src.begin() != src.end() || src.cbegin() != src.cend())
+        return false;
+    src.emplace_back(1);
+    src.push_front(Int(0));
+    return src.size() == 2 && src.front().val == 0 && src.back().val == 1 && dst.size() == N;
+}
+
+bool testMoveAssignment() {
+    sjtu::list<Int> src, dst;
+    for (int i = 0; i < N; ++i)
+        src.emplace_back(i);
+    for (int i = 0; i < N / 2; ++i)
+        dst.emplace_back(-i);
+
+    resetCounter();
+    dst = std::move(src);
+    if (Int::born || Int::dead || dst.size() != N || dst.front().val != 0 || dst.back().val != N - 1)
+        return false;
+
+    // the old elements of dst are released together with src
+    src = sjtu::list<Int>();
+    if (Int::born || Int::dead != N / 2)
+        return false;
+
+    // a moved-from list can be refilled once it has been assigned to
+    sjtu::list<Int> moved(std::move(dst));
+    dst = moved;
+    dst.push_back(Int(N));
+    return dst.size() == N + 1 && moved.size() == N;
+}
+
+bool testReturnByValue() {
+    resetCounter();
+    sjtu::list<Int> res = makeList(N);
+    if (Int::born != N || Int::dead || Int::moved)
+        return false;
+    res = makeList(N / 2);
+    return Int::born == N + N / 2 && Int::dead == N && res.size() == N / 2;
+}
+
+bool testRvaluePush() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    for (int i = 0; i < N; ++i){
+        if (rand()%2){
+            ans.push_back(Int(i));
+            myList.push_back(Int(i));
+        } else {
+            ans.push_front(Int(i));
+            myList.push_front(Int(i));
+        }
+    }
+    if (!equal(ans, myList))
+        return false;
+
+    resetCounter();
+    for (int i = 0; i < N; ++i)
+        myList.push_back(Int(i));
+    // one temporary and one move per element, no copy
+    return Int::born == 2 * N && Int::moved == N && Int::dead == N;
+}
+
+bool testRvalueInsert() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+    for (int i = 0; i < N; ++i){
+        int val = rand();
+        if (rand()%2){
+            resetCounter();
+            Int tmp(val);
+            ans.insert(ans.begin(), Int(val));
+            if (*myList.insert(myList.begin(), std::move(tmp)) != Int(val) || Int::moved != 2)
+                return false;
+        } else {
+            ans.insert(ans.end(), Int(val));
+            myList.insert(myList.end(), Int(val));
+        }
+    }
+    return equal(ans, myList);
+}
+
+bool testEmplace() {
+    std::list<Int> ans;
+    sjtu::list<Int> myList;
+
+    resetCounter();
+    for (int i = 0; i < N; ++i){
+        switch (i == 0 ? 0 : rand()%3){
+            case 0:
+                ans.emplace_back(i, 2);
+                if (myList.emplace_back(i, 2).val != i * 2)
+                    return false;
+                break;
+            case 1:
+                ans.emplace_front(i);
+                if (myList.emplace_front(i).val != i)
+                    return false;
+                break;
+            case 2:
+                ans.emplace(++ans.begin(), i, 3);
+                if (myList.emplace(++myList.begin(), i, 3)->val != i * 3)
+                    return false;
+                break;
+        }
+    }
+    // every element is built exactly once, in place
+    if (!BUILT_IN_PLACE(2 * N))
+        return false;
+    return equal(ans, myList);
+}
+
+bool testLiveObjects() {
+    resetCounter();
+    {
+        sjtu::list<Int> a = makeList(N), b;
+        b = std::move(a);
+        a = makeList(N / 3);
+        sjtu::list<Int> c(std::move(b));
+        c.emplace(c.begin(), 1);
+        c.pop_back();
+        c.merge(a);
+    }
+    return Int::born == Int::dead;
+}
+
+bool testHeavyPayload() {
+    sjtu::list<Util::Bint> bints;
+    Util::Bint large = Util::Bint(rand());
+    for (int i = 0; i < N / 30; ++i)
+        bints.push_back(Util::Bint(i) * large);
+    sjtu::list<Util::Bint> otherBints(std::move(bints));
+
+    using Matrix = Diamond::Matrix<double>;
+    sjtu::list<Matrix> mats;
+    for (int i = 0; i < N / 30; ++i)
+        mats.emplace_back(2, 3, i);
+    sjtu::list<Matrix> otherMats;
+    otherMats = std::move(mats);
+    // a moved matrix hands its buffer over and is left empty
+    Matrix big(100, 100, 1);
+    const double *buffer = big[0];
+    otherMats.push_back(std::move(big));
+
+    return otherBints.size() == N / 30 && otherBints.back() == Util::Bint(N / 30 - 1) * large
+        && otherMats.size() == N / 30 + 1 && (*--(--otherMats.end()))[1][2] == N / 30 - 1
+        && otherMats.back()[0] == buffer && big.RowSize() == 0;
+}
+
+bool testPairMoves() {
+    using Matrix = Diamond::Matrix<double>;
+    using Entry = sjtu::pair<Int, Matrix>;
+    static_assert(std::is_trivially_copyable<sjtu::pair<int, int>>::value, "pair<int, int> must stay trivially copyable");
+
+    sjtu::list<Entry> entries;
+    resetCounter();
+    // temporaries are moved into the pair, never copied
+    for (int i = 0; i < N / 30; ++i)
+        entries.emplace_back(Int(i), Matrix(2, 3, i));
+    bool okay = Int::born == 2 * (N / 30) && Int::moved == N / 30;
+
+    // piecewise construction builds both members in place
+    resetCounter();
+    entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(N, 2), std::forward_as_tuple(40, 40, 1));
+    okay = okay && Int::born == 1 && Int::moved == 0 && entries.back().first.val == 2 * N;
+
+    // moving an entry out hands the matrix buffer over
+    const double *buffer = entries.back().second[0];
+    Entry last = std::move(*--entries.end());
+    Entry other(Int(0), Matrix());
+    swap(last, other);
+    return okay && other.second[0] == buffer && entries.back().second.RowSize() == 0
+        && other.first.val == 2 * N && last.first.val == 0;
+}
+
+bool testMatrixExpression() {
+    using Matrix = Diamond::Matrix<double>;
+    std::list<Matrix> ans;
+    sjtu::list<Matrix> myList;
+
+    Matrix a(3, 2, 1);
+    for (int i = 0; i < N / 30; ++i){
+        Matrix b(3, 2, i), c(2, 3, i);
+        Matrix expected(3, 2, 2);
+        expected[0][1] += 2 * i;
+        b[0][1] += 2 * i;
+        c[1][0] -= 2 * i;
+        ans.push_back(expected);
+        // the expression is evaluated into a temporary, moved into the list
+        myList.push_back(a * 2.0 + b / 2.0 - Diamond::Transpose(c) / 2.0);
+    }
+    // transposing a matrix into itself must not read back what it already overwrote
+    Matrix square(3, 3);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            square[i][j] = i * 3 + j;
+    square = square + Diamond::Transpose(square);
+
+    return equal(ans, myList) && square[0][1] == 4 && square[1][0] == 4 && square[2][2] == 16;
+}
+
+int main(){
+    srand(time(NULL));
+    bool (*testList[])() = {
+        testMoveConstructor, testMoveAssignment, testReturnByValue, testRvaluePush,
+        testRvalueInsert, testEmplace, testLiveObjects, testHeavyPayload, testPairMoves,
+        testMatrixExpression
+    };
+    const char* Messages[] = {
+        "Test 1: Testing move constructor and check number of live objects...",
+        "Test 2: Testing move assignment and check number of live objects...",
+        "Test 3: Testing returning a list by value...",
+        "Test 4: Testing push_front() & push_back() with rvalues...",
+        "Test 5: Testing insert() with rvalues...",
+        "Test 6: Testing emplace(), emplace_front() & emplace_back()...",
+        "Test 7: Testing number of live objects after moves...",
+        "Test 8: Testing moves of class-bint and class-Matrix...",
+        "Test 9: Testing moves and piecewise construction of sjtu::pair...",
+        "Test 10: Testing expressions of class-Matrix..."
+    };
+
+    bool okay = true;
+    for (int i = 0; i < sizeof(testList) / sizeof(testList[0]); ++i) {
+        printf("%s", Messages[i]);
+        if (testList[i]()){
+            printf("Passed\n");
+        } else {
+            okay = false;
+            printf("Failed\n");
+        }
+    }
+
+    if (okay)
+        printf("Congratulations, you have passed all tests!\n");
+    else printf("Unfortunately, you failed in some of the tests.\n");
+    return 0;
+}
@@ -2,41 +2,92 @@
 #define SJTU_EXCEPTIONS_HPP
 
 #include <cstddef>
-#include <cstring>
-#include <string>
+#include <exception>
 
 /*
- * You don't have to implement exceptions.hpp.
- * Just remember to throw exception when needed.
+ * the errors the containers throw.
+ * an exception is a code, whose message is static text, and a small fixed context:
+ * the operation that failed and, where the thrower knows them, the size of the container
+ * and the position asked for. building, copying and throwing one allocates nothing,
+ * and what() returns the static message, so a failed check costs no more than the throw.
  */
 namespace sjtu {
 
-class exception {
+/**
+ * what went wrong, as thrown or as returned by the try_ operations
+ */
+enum class errc {
+    ok = 0,
+    index_out_of_bound,
+    runtime_error,
+    invalid_iterator,
+    container_is_empty
+};
+
+/**
+ * the static message of a code
+ */
+inline const char *message(errc code) noexcept {
+    switch (code) {
+    case errc::ok: return "ok";
+    case errc::index_out_of_bound: return "index_out_of_bound";
+    case errc::runtime_error: return "runtime_error";
+    case errc::invalid_iterator: return "invalid_iterator";
+    case errc::container_is_empty: return "container_is_empty";
+    }
+    return "unknown error";
+}
+
+class exception : public std::exception {
+public:
+    static constexpr size_t npos = (size_t)-1;
+
 protected:
-    const std::string variant = "";
-    std::string detail = "";
+    errc err = errc::runtime_error;
+    const char *op = ""; // static text, usually the name of the function that threw
+    size_t sz = npos;
+    size_t pos = npos;
+
+    exception(errc code, const char *operation, size_t size, size_t position) noexcept
+        : err(code), op(operation), sz(size), pos(position) {}
+
 public:
-    exception() {}
-    exception(const exception &ec) : variant(ec.variant), detail(ec.detail) {}
-    virtual std::string what() {
-        return variant + " " + detail;
-    }
+    exception() noexcept = default;
+    exception(const exception &) noexcept = default;
+    exception &operator=(const exception &) noexcept = default;
+
+    const char *what() const noexcept override { return message(err); }
+    errc code() const noexcept { return err; }
+    /**
+     * the context of the error: "" / npos where the thrower did not give it
+     */
+    const char *operation() const noexcept { return op; }
+    size_t size() const noexcept { return sz; }
+    size_t position() const noexcept { return pos; }
 };
 
 class index_out_of_bound : public exception {
-    /* __________________________ */
+public:
+    explicit index_out_of_bound(const char *operation = "", size_t size = npos, size_t position = npos) noexcept
+        : exception(errc::index_out_of_bound, operation, size, position) {}
 };
 
 class runtime_error : public exception {
-    /* __________________________ */
+public:
+    explicit runtime_error(const char *operation = "", size_t size = npos, size_t position = npos) noexcept
+        : exception(errc::runtime_error, operation, size, position) {}
 };
 
 class invalid_iterator : public exception {
-    /* __________________________ */
+public:
+    explicit invalid_iterator(const char *operation = "", size_t size = npos, size_t position = npos) noexcept
+        : exception(errc::invalid_iterator, operation, size, position) {}
 };
 
 class container_is_empty : public exception {
-    /* __________________________ */
+public:
+    explicit container_is_empty(const char *operation = "", size_t size = npos, size_t position = npos) noexcept
+        : exception(errc::container_is_empty, operation, size, position) {}
 };
 }
 
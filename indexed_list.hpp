@@ -0,0 +1,998 @@
+#ifndef SJTU_INDEXED_LIST_HPP
+#define SJTU_INDEXED_LIST_HPP
+
+#include "exceptions.hpp"
+#include "algorithm.hpp"
+#include "chain.hpp"
+#include "pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * same iterator checking policy as list.hpp: define SJTU_LIST_UNCHECKED to drop the checks
+ */
+#ifdef SJTU_LIST_UNCHECKED
+#define SJTU_INDEXED_CHECK(cond) ((void)0)
+#else
+#define SJTU_INDEXED_CHECK(cond) do { if (cond) throw invalid_iterator(__func__); } while (0)
+#endif
+
+namespace sjtu {
+/**
+ * a data container with the interface of sjtu::list that also finds the k-th element
+ * and the position of an element in O(log n). Besides the doubly linked chain of list,
+ * the nodes form a treap ordered by position: a binary tree whose in-order walk is the
+ * chain, heap-ordered by a random priority drawn once per node, every node counting
+ * the nodes under it.
+ * ++ and -- follow the chain in O(1) as in list. insert and erase relink a node in the
+ * tree in O(log n) expected, a range splice cuts and joins subtrees in O(log n), counting
+ * the range included; sort, merge, reverse, unique, remove and assignment rebuild the
+ * tree from the chain in one O(n) pass after their own.
+ * no element is ever copied or moved, and iterators stay valid exactly as in list.
+ * a node costs four words and a priority more than one of list.
+ */
+template<typename T>
+class indexed_list {
+protected:
+    /**
+     * the element lives in raw storage inside the node, as in list.
+     * next and prev chain the nodes in order, the sentinel head included; left, right and
+     * parent make the tree of the element nodes, and size counts the nodes of a subtree.
+     * next comes first so that a chain of nodes is also a free list of arena_type.
+     */
+    class node {
+    public:
+        node *next, *prev;
+        node *left, *right, *parent;
+        size_t size;
+        unsigned priority;
+        node(): next(nullptr), prev(nullptr), left(nullptr), right(nullptr), parent(nullptr), size(1), priority(0) {}
+        T *val() { return reinterpret_cast<T *>(storage); }
+        const T *val() const { return reinterpret_cast<const T *>(storage); }
+    private:
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+public:
+    /**
+     * a slab of nodes that several lists may share.
+     * nodes can only be spliced or merged between lists drawing from the same arena.
+     */
+    typedef node_pool<sizeof(node), alignof(node)> arena_type;
+
+protected:
+    node *head = nullptr;
+    node *root = nullptr; // of the tree, nullptr when the list is empty
+    size_t sz = 0;
+    arena_type *pool = nullptr; // nullptr: nodes come from the global heap
+    unsigned seed = fresh_seed(this); // of the xorshift drawing priorities
+
+    /**
+     * a seed of its own for every list, so that the first nodes of two lists do not draw
+     * equal priorities: a global counter stepped by the golden ratio, mixed with the address
+     * of the list and scrambled by the splitmix64 finalizer. never 0, where xorshift is stuck
+     */
+    static unsigned fresh_seed(const void *self) {
+        static std::atomic<uint64_t> counter{0};
+        uint64_t x = counter.fetch_add(0x9e3779b97f4a7c15ull, std::memory_order_relaxed) ^ (uint64_t)(uintptr_t)self;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        unsigned s = (unsigned)(x ^ (x >> 32));
+        return s ? s : 2463534242u;
+    }
+    /**
+     * allocate / release a node without touching its value
+     */
+    node *get_node() {
+        node *cur = pool ? new (pool->allocate()) node() : new node();
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        cur->priority = seed;
+        return cur;
+    }
+    void put_node(node *cur) {
+        if (pool) pool->deallocate(cur);
+        else delete cur;
+    }
+    /**
+     * allocate a detached node whose value is constructed from args
+     */
+    template<typename... Args>
+    node *new_node(Args &&... args) {
+        node *cur = get_node();
+        try {
+            new (cur->val()) T(std::forward<Args>(args)...);
+        } catch (...) {
+            put_node(cur);
+            throw;
+        }
+        return cur;
+    }
+    void delete_node(node *cur) {
+        cur->val()->~T();
+        put_node(cur);
+    }
+
+    static size_t count(const node *t) { return t ? t->size : 0; }
+    static void pull(node *t) { t->size = 1 + count(t->left) + count(t->right); }
+    /**
+     * put x where the child old of p was, p being nullptr for the root
+     */
+    void replace_child(node *p, node *old, node *x) {
+        if (!p) root = x;
+        else if (p->left == old) p->left = x;
+        else p->right = x;
+        if (x) x->parent = p;
+    }
+    /**
+     * rotate x above its parent, keeping the in-order sequence
+     */
+    void rotate_up(node *x) {
+        node *p = x->parent;
+        if (p->left == x) {
+            p->left = x->right;
+            if (p->left) p->left->parent = p;
+            x->right = p;
+        } else {
+            p->right = x->left;
+            if (p->right) p->right->parent = p;
+            x->left = p;
+        }
+        replace_child(p->parent, p, x);
+        p->parent = x;
+        x->size = p->size;
+        pull(p);
+    }
+    /**
+     * add x, already linked into the chain, to the tree at its place in the chain
+     */
+    void tree_insert(node *x) {
+        x->left = x->right = nullptr;
+        x->size = 1;
+        node *nxt = x->next, *prv = x->prev;
+        // the place is the left of the successor or else the right of the predecessor
+        if (nxt != head && !nxt->left) nxt->left = x, x->parent = nxt;
+        else if (prv != head) prv->right = x, x->parent = prv;
+        else root = x, x->parent = nullptr;
+        for (node *p = x->parent; p; p = p->parent) ++p->size;
+        while (x->parent && x->parent->priority < x->priority) rotate_up(x);
+    }
+    /**
+     * take x out of the tree; the chain is left alone
+     */
+    void tree_erase(node *x) {
+        while (x->left && x->right) rotate_up(x->left->priority > x->right->priority ? x->left : x->right);
+        node *p = x->parent;
+        replace_child(p, x, x->left ? x->left : x->right);
+        for (; p; p = p->parent) --p->size;
+    }
+    /**
+     * the position of x in the chain, sz for head
+     */
+    size_t index(const node *x) const {
+        if (x == head) return sz;
+        size_t k = count(x->left);
+        for (; x->parent; x = x->parent)
+            if (x->parent->right == x) k += count(x->parent->left) + 1;
+        return k;
+    }
+    /**
+     * the node at position k, head for k == sz
+     */
+    node *at(size_t k) const {
+        if (k >= sz) return head;
+        node *t = root;
+        while (true) {
+            size_t l = count(t->left);
+            if (k < l) t = t->left;
+            else if (k == l) return t;
+            else k -= l + 1, t = t->right;
+        }
+    }
+    /**
+     * cut the tree t into a, its first k nodes, and b, the rest
+     */
+    static void split(node *t, size_t k, node *&a, node *&b) {
+        if (!t) {
+            a = b = nullptr;
+            return;
+        }
+        if (count(t->left) >= k) {
+            split(t->left, k, a, t->left);
+            if (t->left) t->left->parent = t;
+            b = t;
+        } else {
+            split(t->right, k - count(t->left) - 1, t->right, b);
+            if (t->right) t->right->parent = t;
+            a = t;
+        }
+        pull(t);
+        if (a) a->parent = nullptr;
+        if (b) b->parent = nullptr;
+    }
+    /**
+     * the tree of the nodes of a followed by those of b
+     */
+    static node *join(node *a, node *b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->priority > b->priority) {
+            a->right = join(a->right, b);
+            a->right->parent = a;
+            pull(a);
+            return a;
+        }
+        b->left = join(a, b->left);
+        b->left->parent = b;
+        pull(b);
+        return b;
+    }
+    /**
+     * the tree of the chain [first, end) in one pass: each node goes to the bottom of the
+     * right spine of the tree built so far, the spine nodes of lower priority becoming its
+     * left subtree, whose sizes are final from then on
+     */
+    static node *build(node *first, node *end) {
+        node *top = nullptr, *last = nullptr;
+        for (node *x = first; x != end; x = x->next) {
+            node *child = nullptr, *y = last;
+            while (y && y->priority < x->priority) {
+                pull(y);
+                child = y;
+                y = y->parent;
+            }
+            x->left = child;
+            if (child) child->parent = x;
+            x->right = nullptr;
+            x->parent = y;
+            if (y) y->right = x;
+            else top = x;
+            last = x;
+        }
+        for (node *y = last; y; y = y->parent) pull(y);
+        return top;
+    }
+    void rebuild() { root = build(head->next, head); }
+    /**
+     * the tree with the subtree t put in front of position k
+     */
+    void join_at(size_t k, node *t) {
+        node *a, *b;
+        split(root, k, a, b);
+        root = join(join(a, t), b);
+        if (root) root->parent = nullptr;
+    }
+    /**
+     * take the nodes at positions [k, k + n) out of the tree, return their subtree
+     */
+    node *cut(size_t k, size_t n) {
+        node *a, *b, *c;
+        split(root, k, a, b);
+        split(b, n, b, c);
+        root = join(a, c);
+        if (root) root->parent = nullptr;
+        return b;
+    }
+
+    /**
+     * insert node cur before node pos, in the chain and the tree
+     */
+    node *insert(node *pos, node *cur) {
+        cur->prev = pos->prev;
+        cur->next = pos;
+        pos->prev->next = cur;
+        pos->prev = cur;
+        ++sz;
+        tree_insert(cur);
+        return cur;
+    }
+    /**
+     * remove node pos from the chain and the tree (no need to delete the node)
+     */
+    node *erase(node *pos) {
+        tree_erase(pos);
+        pos->prev->next = pos->next;
+        pos->next->prev = pos->prev;
+        pos->prev = pos->next = nullptr;
+        --sz;
+        return pos;
+    }
+    /**
+     * link the chain of n nodes from first to last before node pos; the tree is left alone
+     */
+    void link(node *pos, node *first, node *last, size_t n) {
+        first->prev = pos->prev;
+        last->next = pos;
+        pos->prev->next = first;
+        pos->prev = last;
+        sz += n;
+    }
+    /**
+     * unlink the n nodes from first to last, they stay linked to each other; the tree is left alone
+     */
+    void unlink(node *first, node *last, size_t n) {
+        first->prev->next = last->next;
+        last->next->prev = first->prev;
+        first->prev = last->next = nullptr;
+        sz -= n;
+    }
+
+    /**
+     * the default ordering, operator< of T
+     */
+    struct less {
+        bool operator()(const T &a, const T &b) const { return a < b; }
+    };
+    /**
+     * the default equivalence, operator== of T
+     */
+    struct equal_to {
+        bool operator()(const T &a, const T &b) const { return a == b; }
+    };
+    /**
+     * a chain of nodes from first to last, linked in both directions
+     */
+    typedef chain_detail::run<node> run;
+    /**
+     * the element of a node, for the shared chain algorithms
+     */
+    struct value_of {
+        T &operator()(node *p) const { return *(p->val()); }
+    };
+    /**
+     * release every node of a detached chain ending with nullptr
+     */
+    void release_chain(node *cur) {
+        while (cur) {
+            node *nxt = cur->next;
+            delete_node(cur);
+            cur = nxt;
+        }
+    }
+    static void chain_push(run &c, node *cur) {
+        if (c.first) {
+            c.last->next = cur;
+            cur->prev = c.last;
+        } else {
+            c.first = cur;
+        }
+        c.last = cur;
+    }
+    /**
+     * build a detached chain holding copies of [first, last) in one pass, n receives its length
+     * if a copy throws, the nodes built so far are released
+     */
+    template<typename InputIt>
+    run build_chain(InputIt first, InputIt last, size_t &n) {
+        run c;
+        n = 0;
+        try {
+            for (; first != last; ++first, ++n) chain_push(c, new_node(*first));
+        } catch (...) {
+            release_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+    run build_chain(size_t n, const T &value) {
+        run c;
+        try {
+            for (size_t i = 0; i < n; ++i) chain_push(c, new_node(value));
+        } catch (...) {
+            release_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+    /**
+     * link a detached chain of n nodes before pos, its tree built on the side and joined in
+     * return the first linked node, or pos if the chain is empty
+     */
+    node *link_chain(node *pos, run c, size_t n) {
+        if (!n) return pos;
+        c.last->next = nullptr;
+        node *t = build(c.first, nullptr);
+        size_t k = index(pos);
+        link(pos, c.first, c.last, n);
+        join_at(k, t);
+        return c.first;
+    }
+    /**
+     * release the nodes from cur to the back of the list
+     */
+    void erase_tail(node *cur) {
+        if (cur == head) return;
+        size_t k = index(cur), n = sz - k;
+        cut(k, n);
+        node *last = head->prev;
+        unlink(cur, last, n);
+        release_chain(cur);
+    }
+    void init() {
+        head = get_node();
+        head->next = head->prev = head;
+        root = nullptr;
+        sz = 0;
+    }
+    template<typename... Args>
+    void init_from(Args &&... args) {
+        init();
+        try {
+            size_t n;
+            run c = make_chain(n, std::forward<Args>(args)...);
+            link_chain(head, c, n);
+        } catch (...) {
+            put_node(head);
+            head = nullptr;
+            throw;
+        }
+    }
+    template<typename InputIt>
+    run make_chain(size_t &n, InputIt first, InputIt last) { return build_chain(first, last, n); }
+    run make_chain(size_t &n, size_t count, const T &value) { n = count; return build_chain(count, value); }
+    /**
+     * read-only walk over the values of a node chain
+     */
+    struct value_walker {
+        const node *p;
+        const T & operator*() const { return *(p->val()); }
+        value_walker & operator++() { p = p->next; return *this; }
+        bool operator!=(const value_walker &rhs) const { return p != rhs.p; }
+    };
+    /**
+     * assign [first, last) over the existing elements, reusing their nodes,
+     * then append the rest of the range or release the extra nodes
+     */
+    template<typename InputIt>
+    void assign_range(InputIt first, InputIt last) {
+        if (!head) init();
+        node *cur = head->next;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; cur != head && first != last; cur = cur->next, ++first) *(cur->val()) = *first;
+        }
+        erase_tail(cur);
+        size_t n;
+        run c = build_chain(first, last, n);
+        link_chain(head, c, n);
+    }
+    /**
+     * unlink and release every node for which drop(value) holds in one pass over the chain,
+     * then rebuild the tree, also when drop throws; return the number of released nodes
+     */
+    template<typename Drop>
+    size_t sweep(Drop drop) {
+        size_t cnt = 0;
+        try {
+            for (node *cur = head->next, *nxt; cur != head; cur = nxt) {
+                nxt = cur->next;
+                if (!drop(cur)) continue;
+                unlink(cur, cur, 1);
+                delete_node(cur);
+                ++cnt;
+            }
+        } catch (...) {
+            rebuild();
+            throw;
+        }
+        rebuild();
+        return cnt;
+    }
+    template<typename InputIt>
+    using if_iterator = typename std::enable_if<!std::is_integral<InputIt>::value>::type;
+
+public:
+    class const_iterator;
+    class iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        indexed_list *owner = nullptr;
+#endif
+        node *ptr = nullptr;
+        friend class const_iterator;
+        friend class indexed_list;
+    public:
+        iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        iterator(indexed_list *o, node *p) : owner(o), ptr(p) {}
+#else
+        iterator(indexed_list *, node *p) : ptr(p) {}
+#endif
+        iterator operator++(int) {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            iterator tmp = *this;
+            ptr = ptr->next;
+            return tmp;
+        }
+        iterator & operator++() {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            ptr = ptr->next;
+            return *this;
+        }
+        iterator operator--(int) {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr->prev == owner->head);
+            iterator tmp = *this;
+            ptr = ptr->prev;
+            return tmp;
+        }
+        iterator & operator--() {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr->prev == owner->head);
+            ptr = ptr->prev;
+            return *this;
+        }
+        T & operator *() const {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            return *(ptr->val());
+        }
+        T * operator ->() const {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            return ptr->val();
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+#else
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr; }
+#endif
+        bool operator==(const const_iterator &rhs) const { return rhs == *this; }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator &rhs) const { return !(rhs == *this); }
+    };
+    class const_iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        const indexed_list *owner = nullptr;
+#endif
+        node *ptr = nullptr;
+        friend class iterator;
+        friend class indexed_list;
+    public:
+        const_iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        const_iterator(const indexed_list *o, node *p) : owner(o), ptr(p) {}
+        const_iterator(const iterator &it) : owner(it.owner), ptr(it.ptr) {}
+#else
+        const_iterator(const indexed_list *, node *p) : ptr(p) {}
+        const_iterator(const iterator &it) : ptr(it.ptr) {}
+#endif
+        const_iterator operator++(int) {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            const_iterator tmp = *this;
+            ptr = ptr->next;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            ptr = ptr->next;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr->prev == owner->head);
+            const_iterator tmp = *this;
+            ptr = ptr->prev;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr->prev == owner->head);
+            ptr = ptr->prev;
+            return *this;
+        }
+        const T & operator *() const {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            return *(ptr->val());
+        }
+        const T * operator ->() const {
+            SJTU_INDEXED_CHECK(!owner || !ptr || ptr == owner->head);
+            return ptr->val();
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+#else
+        bool operator==(const const_iterator &rhs) const { return ptr == rhs.ptr; }
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr; }
+#endif
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+    };
+
+    indexed_list() { init(); }
+    /**
+     * a list whose nodes (sentinel included) are drawn from arena.
+     * the arena must outlive the list.
+     */
+    explicit indexed_list(arena_type &arena) : pool(&arena) { init(); }
+    /**
+     * the copy shares the arena of other
+     */
+    indexed_list(const indexed_list &other) : pool(other.pool) {
+        init_from(value_walker{other.head->next}, value_walker{other.head});
+    }
+    indexed_list(size_t n, const T &value) { init_from(n, value); }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    indexed_list(InputIt first, InputIt last) { init_from(first, last); }
+    indexed_list(std::initializer_list<T> values) { init_from(values.begin(), values.end()); }
+    /**
+     * steal the sentinel (and so every node) of other, no element is touched.
+     * other gets a fresh sentinel and stays a valid empty list; the move allocates nothing
+     * else, and std::terminate is called should that one allocation fail.
+     */
+    indexed_list(indexed_list &&other) noexcept
+        : head(other.head), root(other.root), sz(other.sz), pool(other.pool), seed(other.seed) {
+        other.seed = fresh_seed(&other);
+        other.init();
+    }
+    ~indexed_list() {
+        clear();
+        if (head) { put_node(head); head = nullptr; }
+    }
+    indexed_list &operator=(const indexed_list &other) {
+        if (this == &other) return *this;
+        assign_range(value_walker{other.head->next}, value_walker{other.head});
+        return *this;
+    }
+    indexed_list &operator=(indexed_list &&other) noexcept {
+        if (this == &other) return *this;
+        std::swap(head, other.head);
+        std::swap(root, other.root);
+        std::swap(sz, other.sz);
+        std::swap(pool, other.pool);
+        return *this;
+    }
+    indexed_list &operator=(std::initializer_list<T> values) {
+        assign_range(values.begin(), values.end());
+        return *this;
+    }
+    /**
+     * replace the contents, existing nodes are reused by assigning over their values
+     */
+    void assign(size_t n, const T &value) {
+        if (!head) init();
+        node *cur = head->next;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; cur != head && n; cur = cur->next, --n) *(cur->val()) = value;
+        }
+        erase_tail(cur);
+        link_chain(head, build_chain(n, value), n);
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    void assign(InputIt first, InputIt last) { assign_range(first, last); }
+    void assign(std::initializer_list<T> values) { assign_range(values.begin(), values.end()); }
+    /**
+     * access the first / last element
+     * throw container_is_empty when the container is empty.
+     */
+    const T & front() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return *(head->next->val());
+    }
+    const T & back() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return *(head->prev->val());
+    }
+    iterator begin() { return iterator(this, head->next); }
+    const_iterator cbegin() const { return const_iterator(this, head->next); }
+    iterator end() { return iterator(this, head); }
+    const_iterator cend() const { return const_iterator(this, head); }
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+    arena_type *arena() const { return pool; }
+
+    /**
+     * an iterator to the element at position k, end() for k == size(), in O(log n)
+     * throw index_out_of_bound if k > size()
+     */
+    iterator nth(size_t k) {
+        if (k > sz) throw index_out_of_bound("nth", sz, k);
+        return iterator(this, at(k));
+    }
+    const_iterator nth(size_t k) const {
+        if (k > sz) throw index_out_of_bound("nth", sz, k);
+        return const_iterator(this, at(k));
+    }
+    /**
+     * the position of the element at it, size() for end(), in O(log n)
+     * throw if the iterator is invalid
+     */
+    size_t index_of(const_iterator it) const {
+        SJTU_INDEXED_CHECK(it.owner != this || it.ptr == nullptr);
+        return index(it.ptr);
+    }
+    /**
+     * move it by k positions, backwards for negative k; a few steps are walked along the
+     * chain, longer moves go through the tree in O(log n)
+     * throw index_out_of_bound if the position would leave [0, size()], it is then unchanged
+     */
+    void advance(iterator &it, std::ptrdiff_t k) const {
+        SJTU_INDEXED_CHECK(it.owner != this || it.ptr == nullptr);
+        it.ptr = move_by(it.ptr, k);
+    }
+    void advance(const_iterator &it, std::ptrdiff_t k) const {
+        SJTU_INDEXED_CHECK(it.owner != this || it.ptr == nullptr);
+        it.ptr = move_by(it.ptr, k);
+    }
+
+protected:
+    // moves up to this long are walked, as they cost less than two paths through the tree
+    static constexpr std::ptrdiff_t walk_limit = 16;
+
+    node *move_by(node *p, std::ptrdiff_t k) const {
+        if (k >= -walk_limit && k <= walk_limit) {
+            node *q = p;
+            for (; k > 0; --k, q = q->next)
+                if (q == head) throw index_out_of_bound("advance", sz);
+            for (; k < 0; ++k, q = q->prev)
+                if (q->prev == head) throw index_out_of_bound("advance", sz);
+            return q;
+        }
+        size_t i = index(p);
+        if (k < 0 ? (size_t)-k > i : (size_t)k > sz - i) throw index_out_of_bound("advance", sz);
+        return at(i + k);
+    }
+
+public:
+    /**
+     * clears the contents
+     */
+    void clear() {
+        if (std::is_trivially_destructible<T>::value && pool && sz) {
+            pool->deallocate_chain(head->next, head->prev);
+            head->next = head->prev = head;
+            root = nullptr;
+            sz = 0;
+            return;
+        }
+        node *cur = head ? head->next : nullptr;
+        while (cur && cur != head) {
+            node *nxt = cur->next;
+            delete_node(cur);
+            cur = nxt;
+        }
+        if (head) head->next = head->prev = head;
+        root = nullptr;
+        sz = 0;
+    }
+    /**
+     * insert value before pos (pos may be the end() iterator), in O(log n) expected
+     * return an iterator pointing to the inserted value
+     * throw if the iterator is invalid
+     */
+    iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+    iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+    /**
+     * insert n copies of value before pos: the nodes are built off the list with a tree
+     * of their own, which is joined in; return an iterator to the first inserted element,
+     * or pos if n is 0
+     */
+    iterator insert(iterator pos, size_t n, const T &value) {
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        return iterator(this, link_chain(pos.ptr, build_chain(n, value), n));
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    iterator insert(iterator pos, InputIt first, InputIt last) {
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        size_t n;
+        run c = build_chain(first, last, n);
+        return iterator(this, link_chain(pos.ptr, c, n));
+    }
+    iterator insert(iterator pos, std::initializer_list<T> values) {
+        return insert(pos, values.begin(), values.end());
+    }
+    template<typename... Args>
+    iterator emplace(iterator pos, Args &&... args) {
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        node *cur = new_node(std::forward<Args>(args)...);
+        insert(pos.ptr, cur);
+        return iterator(this, cur);
+    }
+    /**
+     * remove the element at pos (the end() iterator is invalid), in O(log n) expected
+     * returns an iterator pointing to the following element, if pos pointing to the last element, end() will be returned.
+     * throw if the container is empty, the iterator is invalid
+     */
+    iterator erase(iterator pos) {
+        if (sz == 0) throw container_is_empty(__func__);
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr || pos.ptr == head);
+        node *nxt = pos.ptr->next;
+        delete_node(erase(pos.ptr));
+        return iterator(this, nxt);
+    }
+    void push_back(const T &value) { insert(iterator(this, head), value); }
+    void push_back(T &&value) { insert(iterator(this, head), std::move(value)); }
+    template<typename... Args>
+    T & emplace_back(Args &&... args) { return *emplace(iterator(this, head), std::forward<Args>(args)...); }
+    void pop_back() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, head->prev));
+    }
+    void push_front(const T &value) { insert(iterator(this, head->next), value); }
+    void push_front(T &&value) { insert(iterator(this, head->next), std::move(value)); }
+    template<typename... Args>
+    T & emplace_front(Args &&... args) { return *emplace(iterator(this, head->next), std::forward<Args>(args)...); }
+    void pop_front() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, head->next));
+    }
+    /**
+     * move all elements of other before pos, other becomes empty
+     * no elements are copied or moved, O(log n)
+     * throw invalid_iterator if pos does not belong to *this,
+     * runtime_error if the two lists draw from different arenas
+     */
+    void splice(iterator pos, indexed_list &other) {
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        if (this == &other || other.sz == 0) return;
+        if (pool != other.pool) throw runtime_error(__func__);
+        node *first = other.head->next, *last = other.head->prev, *t = other.root;
+        size_t n = other.sz, k = index(pos.ptr);
+        other.unlink(first, last, n);
+        other.root = nullptr;
+        link(pos.ptr, first, last, n);
+        join_at(k, t);
+    }
+    /**
+     * move the element at it from other before pos, other may be *this
+     * no elements are copied or moved, O(log n) expected
+     */
+    void splice(iterator pos, indexed_list &other, iterator it) {
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_INDEXED_CHECK(it.owner != &other || it.ptr == nullptr || it.ptr == other.head);
+        if (pool != other.pool) throw runtime_error(__func__);
+        if (pos.ptr == it.ptr || pos.ptr == it.ptr->next) return;
+        insert(pos.ptr, other.erase(it.ptr));
+    }
+    /**
+     * move the elements in [first, last) from other before pos, other may be *this
+     * (then pos shall not be inside the range)
+     * no elements are copied or moved; the range is counted and cut out of the tree of
+     * other, and its subtree joined into this one, in O(log n)
+     */
+    void splice(iterator pos, indexed_list &other, iterator first, iterator last) {
+        SJTU_INDEXED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_INDEXED_CHECK(first.owner != &other || last.owner != &other || first.ptr == nullptr || last.ptr == nullptr);
+        if (pool != other.pool) throw runtime_error(__func__);
+        if (first.ptr == last.ptr || pos.ptr == first.ptr || pos.ptr == last.ptr) return;
+        size_t a = other.index(first.ptr), b = other.index(last.ptr);
+        SJTU_INDEXED_CHECK(a > b);
+        size_t n = b - a;
+        node *tail = last.ptr->prev;
+        node *t = other.cut(a, n);
+        other.unlink(first.ptr, tail, n);
+        size_t k = index(pos.ptr);
+        link(pos.ptr, first.ptr, tail, n);
+        join_at(k, t);
+    }
+    /**
+     * sort the values in ascending order with operator< of T
+     */
+    void sort() { sort(less()); }
+    /**
+     * stable bottom-up merge sort of the chain as in list::sort, then one pass rebuilding the tree.
+     * if cmp throws, every element is kept but their order is unspecified.
+     */
+    template<typename Compare>
+    void sort(Compare cmp) {
+        if (sz <= 1) return;
+        try {
+            chain_detail::sort(head, value_of(), cmp);
+        } catch (...) {
+            rebuild();
+            throw;
+        }
+        rebuild();
+    }
+    /**
+     * sort() on the threads of policy, as list::parallel_sort
+     * if cmp throws, the list is left as it was.
+     */
+    void parallel_sort(parallel_policy policy = parallel_policy()) { parallel_sort(less(), policy); }
+    template<typename Compare>
+    void parallel_sort(Compare cmp, parallel_policy policy = parallel_policy()) {
+        if (sz <= 1) return;
+        node **a = new node*[sz];
+        size_t idx = 0;
+        for (node *cur = head->next; cur != head; cur = cur->next) a[idx++] = cur;
+        try {
+            sjtu::parallel_stable_sort(a, a + sz, [&cmp](const node *x, const node *y) {
+                return cmp(*x->val(), *y->val());
+            }, policy);
+        } catch (...) {
+            delete [] a;
+            throw;
+        }
+        node *prev = head;
+        for (size_t k = 0; k < sz; ++k) {
+            prev->next = a[k];
+            a[k]->prev = prev;
+            prev = a[k];
+        }
+        prev->next = head;
+        head->prev = prev;
+        delete [] a;
+        rebuild();
+    }
+    /**
+     * merge two sorted lists into one as list::merge, then rebuild the tree
+     * container other becomes empty after the operation
+     * throw runtime_error if the two lists draw from different arenas
+     */
+    void merge(indexed_list &other) { merge(other, less()); }
+    template<typename Compare>
+    void merge(indexed_list &other, Compare cmp) {
+        if (this == &other || other.sz == 0) return;
+        if (pool != other.pool) throw runtime_error(__func__);
+        sz += other.sz;
+        other.root = nullptr;
+        other.sz = 0;
+        try {
+            chain_detail::merge_into(head, other.head, value_of(), cmp);
+        } catch (...) {
+            rebuild();
+            throw;
+        }
+        rebuild();
+    }
+    /**
+     * reverse the order of the elements
+     * the chain is reversed in place and the tree mirrored, no elements are copied or moved
+     */
+    void reverse() {
+        if (sz <= 1) return;
+        node *cur = head;
+        do {
+            node *tmp = cur->next;
+            cur->next = cur->prev;
+            cur->prev = tmp;
+            cur = tmp;
+            if (cur != head) std::swap(cur->left, cur->right);
+        } while (cur != head);
+    }
+    void unique() { unique(equal_to()); }
+    /**
+     * same as unique(), an element is removed when pred(first of its group, element) holds
+     */
+    template<typename BinaryPredicate>
+    void unique(BinaryPredicate pred) {
+        if (sz <= 1) return;
+        node *kept = head->next;
+        sweep([&](node *cur) {
+            if (cur != kept && pred(*(kept->val()), *(cur->val()))) return true;
+            kept = cur;
+            return false;
+        });
+    }
+    /**
+     * remove every element equal to value (operator== of T) in one pass
+     * value may refer to an element of the list itself
+     * return the number of removed elements
+     */
+    size_t remove(const T &value) {
+        node *self = nullptr;
+        size_t cnt = sweep([&](node *cur) {
+            if (!(*(cur->val()) == value)) return false;
+            if (cur->val() == &value) { self = cur; return false; }
+            return true;
+        });
+        if (self) {
+            delete_node(erase(self));
+            ++cnt;
+        }
+        return cnt;
+    }
+    template<typename Predicate>
+    size_t remove_if(Predicate pred) {
+        return sweep([&](node *cur) { return pred(*(cur->val())); });
+    }
+};
+
+}
+
+#undef SJTU_INDEXED_CHECK
+
+#endif //SJTU_INDEXED_LIST_HPP
@@ -0,0 +1,483 @@
+#ifndef SJTU_INTRUSIVE_LIST_HPP
+#define SJTU_INTRUSIVE_LIST_HPP
+
+#include "exceptions.hpp"
+#include "chain.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * same iterator checking policy as list.hpp: define SJTU_LIST_UNCHECKED to drop the checks
+ */
+#ifdef SJTU_LIST_UNCHECKED
+#define SJTU_INTRUSIVE_CHECK(cond) ((void)0)
+#else
+#define SJTU_INTRUSIVE_CHECK(cond) do { if (cond) throw invalid_iterator(__func__); } while (0)
+#endif
+
+namespace sjtu {
+/**
+ * the links an element embeds to be in an intrusive_list: derive the element type from it.
+ * an element that derives from list_hook<A> and list_hook<B> can be in one
+ * intrusive_list<T, A> and one intrusive_list<T, B> at the same time.
+ * next and prev belong to the list the element is in and must not be written by anyone else;
+ * copying an element does not copy its links, the copy is in no list.
+ */
+template<typename Tag = void>
+class list_hook {
+public:
+    list_hook *next = nullptr, *prev = nullptr;
+
+    list_hook() = default;
+    list_hook(const list_hook &) {}
+    list_hook &operator=(const list_hook &) { return *this; }
+    /**
+     * whether the element is in a list through this hook
+     */
+    bool is_linked() const { return next != nullptr; }
+};
+
+/**
+ * a list like sjtu::list of elements it does not own: T derives from list_hook<Tag>
+ * and the list links the hooks of the elements the caller gives it, so it never allocates
+ * (merge_all aside), and sort, merge, reverse and unique are the relinking of list (see chain.hpp).
+ * the list never copies, moves or destroys an element, and removing one only unlinks it.
+ * an element must outlive its time in the list and may be in one list per hook at a time.
+ */
+template<typename T, typename Tag = void>
+class intrusive_list {
+public:
+    typedef list_hook<Tag> hook;
+    static_assert(std::is_base_of<hook, T>::value, "T must derive from list_hook<Tag>");
+
+protected:
+    /**
+     * the sentinel, the only link that is not in an element
+     */
+    hook head;
+    size_t sz = 0;
+
+    /**
+     * the element of a link, for the shared chain algorithms
+     */
+    struct value_of {
+        T &operator()(hook *p) const { return static_cast<T &>(*p); }
+    };
+    static intrusive_list &as_list(intrusive_list &l) { return l; }
+    static intrusive_list &as_list(intrusive_list *l) { return *l; }
+    /**
+     * the default ordering, operator< of T
+     */
+    struct less {
+        bool operator()(const T &a, const T &b) const { return a < b; }
+    };
+    /**
+     * the default equivalence, operator== of T
+     */
+    struct equal_to {
+        bool operator()(const T &a, const T &b) const { return a == b; }
+    };
+
+    void init() { head.next = head.prev = &head; }
+    /**
+     * insert link cur before link pos
+     * return the inserted link cur
+     */
+    hook *insert(hook *pos, hook *cur) {
+        cur->prev = pos->prev;
+        cur->next = pos;
+        pos->prev->next = cur;
+        pos->prev = cur;
+        ++sz;
+        return cur;
+    }
+    /**
+     * remove link pos from the list, which leaves its element unlinked
+     * return the removed link pos
+     */
+    hook *erase(hook *pos) {
+        pos->prev->next = pos->next;
+        pos->next->prev = pos->prev;
+        pos->prev = pos->next = nullptr;
+        --sz;
+        return pos;
+    }
+    /**
+     * insert the chain of n links from first to last (linked through next) before link pos
+     */
+    void insert(hook *pos, hook *first, hook *last, size_t n) {
+        first->prev = pos->prev;
+        last->next = pos;
+        pos->prev->next = first;
+        pos->prev = last;
+        sz += n;
+    }
+    /**
+     * remove the n links from first to last from the list, they stay linked to each other
+     */
+    void erase(hook *first, hook *last, size_t n) {
+        first->prev->next = last->next;
+        last->next->prev = first->prev;
+        first->prev = last->next = nullptr;
+        sz -= n;
+    }
+    /**
+     * take the chain of other, leaving other empty; *this must be empty
+     */
+    void take(intrusive_list &other) {
+        if (other.sz == 0) return;
+        hook *first = other.head.next, *last = other.head.prev;
+        size_t n = other.sz;
+        other.erase(first, last, n);
+        insert(&head, first, last, n);
+    }
+
+public:
+    class const_iterator;
+    class iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        intrusive_list *owner = nullptr;
+#endif
+        hook *ptr = nullptr;
+        friend class const_iterator;
+        friend class intrusive_list;
+    public:
+        iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        iterator(intrusive_list *o, hook *p) : owner(o), ptr(p) {}
+#else
+        iterator(intrusive_list *, hook *p) : ptr(p) {}
+#endif
+        iterator operator++(int) {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            iterator tmp = *this;
+            ptr = ptr->next;
+            return tmp;
+        }
+        iterator & operator++() {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            ptr = ptr->next;
+            return *this;
+        }
+        iterator operator--(int) {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr->prev == &owner->head);
+            iterator tmp = *this;
+            ptr = ptr->prev;
+            return tmp;
+        }
+        iterator & operator--() {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr->prev == &owner->head);
+            ptr = ptr->prev;
+            return *this;
+        }
+        T & operator *() const {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            return value_of()(ptr);
+        }
+        T * operator ->() const {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            return &value_of()(ptr);
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+#else
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr; }
+#endif
+        bool operator==(const const_iterator &rhs) const { return rhs == *this; }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator &rhs) const { return !(rhs == *this); }
+    };
+    class const_iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        const intrusive_list *owner = nullptr;
+#endif
+        const hook *ptr = nullptr;
+        friend class iterator;
+        friend class intrusive_list;
+    public:
+        const_iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        const_iterator(const intrusive_list *o, const hook *p) : owner(o), ptr(p) {}
+        const_iterator(const iterator &it) : owner(it.owner), ptr(it.ptr) {}
+#else
+        const_iterator(const intrusive_list *, const hook *p) : ptr(p) {}
+        const_iterator(const iterator &it) : ptr(it.ptr) {}
+#endif
+        const_iterator operator++(int) {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            const_iterator tmp = *this;
+            ptr = ptr->next;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            ptr = ptr->next;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr->prev == &owner->head);
+            const_iterator tmp = *this;
+            ptr = ptr->prev;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr->prev == &owner->head);
+            ptr = ptr->prev;
+            return *this;
+        }
+        const T & operator *() const {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            return static_cast<const T &>(*ptr);
+        }
+        const T * operator ->() const {
+            SJTU_INTRUSIVE_CHECK(!owner || !ptr || ptr == &owner->head);
+            return &static_cast<const T &>(*ptr);
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+#else
+        bool operator==(const const_iterator &rhs) const { return ptr == rhs.ptr; }
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr; }
+#endif
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+    };
+
+    intrusive_list() { init(); }
+    /**
+     * a list owns no element, so it is not copied; moving it relinks the sentinel
+     */
+    intrusive_list(const intrusive_list &) = delete;
+    intrusive_list &operator=(const intrusive_list &) = delete;
+    intrusive_list(intrusive_list &&other) noexcept {
+        init();
+        take(other);
+    }
+    intrusive_list &operator=(intrusive_list &&other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        take(other);
+        return *this;
+    }
+    /**
+     * unlink every element, none is destroyed
+     */
+    ~intrusive_list() { clear(); }
+
+    /**
+     * access the first / last element
+     * throw container_is_empty when the container is empty.
+     */
+    T & front() {
+        if (sz == 0) throw container_is_empty(__func__);
+        return value_of()(head.next);
+    }
+    const T & front() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return static_cast<const T &>(*head.next);
+    }
+    T & back() {
+        if (sz == 0) throw container_is_empty(__func__);
+        return value_of()(head.prev);
+    }
+    const T & back() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return static_cast<const T &>(*head.prev);
+    }
+    iterator begin() { return iterator(this, head.next); }
+    const_iterator begin() const { return const_iterator(this, head.next); }
+    const_iterator cbegin() const { return begin(); }
+    iterator end() { return iterator(this, &head); }
+    const_iterator end() const { return const_iterator(this, &head); }
+    const_iterator cend() const { return end(); }
+    /**
+     * an iterator to value, which must be in this list, in O(1)
+     * throw invalid_iterator if value is in no list through this hook
+     */
+    iterator iterator_to(T &value) {
+        hook *cur = &value;
+        SJTU_INTRUSIVE_CHECK(!cur->is_linked());
+        return iterator(this, cur);
+    }
+    const_iterator iterator_to(const T &value) const {
+        const hook *cur = &value;
+        SJTU_INTRUSIVE_CHECK(!cur->is_linked());
+        return const_iterator(this, cur);
+    }
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+
+    /**
+     * unlink every element, O(n) to clear their hooks
+     */
+    void clear() {
+        hook *cur = head.next;
+        while (cur != &head) {
+            hook *nxt = cur->next;
+            cur->next = cur->prev = nullptr;
+            cur = nxt;
+        }
+        init();
+        sz = 0;
+    }
+    /**
+     * link value before pos and return an iterator to it
+     * throw invalid_iterator if pos does not belong to *this,
+     * runtime_error if value is already in a list through this hook
+     */
+    iterator insert(iterator pos, T &value) {
+        SJTU_INTRUSIVE_CHECK(pos.owner != this || pos.ptr == nullptr);
+        hook *cur = &value;
+        if (cur->is_linked()) throw runtime_error(__func__);
+        return iterator(this, insert(pos.ptr, cur));
+    }
+    /**
+     * unlink the element at pos (the end() iterator is invalid)
+     * return an iterator to the following element
+     * throw if the container is empty, the iterator is invalid
+     */
+    iterator erase(iterator pos) {
+        if (sz == 0) throw container_is_empty(__func__);
+        SJTU_INTRUSIVE_CHECK(pos.owner != this || pos.ptr == nullptr || pos.ptr == &head);
+        hook *nxt = pos.ptr->next;
+        erase(pos.ptr);
+        return iterator(this, nxt);
+    }
+    void push_back(T &value) { insert(end(), value); }
+    void push_front(T &value) { insert(begin(), value); }
+    /**
+     * unlink the last / first element
+     * throw when the container is empty.
+     */
+    void pop_back() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(head.prev);
+    }
+    void pop_front() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(head.next);
+    }
+    /**
+     * move all elements of other before pos, other becomes empty, O(1)
+     * throw invalid_iterator if pos does not belong to *this
+     */
+    void splice(iterator pos, intrusive_list &other) {
+        SJTU_INTRUSIVE_CHECK(pos.owner != this || pos.ptr == nullptr);
+        if (this == &other || other.sz == 0) return;
+        hook *first = other.head.next, *last = other.head.prev;
+        size_t n = other.sz;
+        other.erase(first, last, n);
+        insert(pos.ptr, first, last, n);
+    }
+    /**
+     * move the element at it from other before pos, other may be *this, O(1)
+     */
+    void splice(iterator pos, intrusive_list &other, iterator it) {
+        SJTU_INTRUSIVE_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_INTRUSIVE_CHECK(it.owner != &other || it.ptr == nullptr || it.ptr == &other.head);
+        if (pos.ptr == it.ptr || pos.ptr == it.ptr->next) return;
+        insert(pos.ptr, other.erase(it.ptr));
+    }
+    /**
+     * move the elements in [first, last) from other before pos, other may be *this
+     * (then pos shall not be inside the range)
+     * relinking is O(1), counting the moved elements is O(distance) unless other is *this
+     */
+    void splice(iterator pos, intrusive_list &other, iterator first, iterator last) {
+        SJTU_INTRUSIVE_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_INTRUSIVE_CHECK(first.owner != &other || last.owner != &other || first.ptr == nullptr || last.ptr == nullptr);
+        if (first.ptr == last.ptr || pos.ptr == first.ptr || pos.ptr == last.ptr) return;
+        hook *tail = last.ptr->prev;
+        size_t n = 0;
+        if (this != &other) {
+            for (hook *cur = first.ptr; cur != last.ptr; cur = cur->next) {
+                SJTU_INTRUSIVE_CHECK(cur == &other.head);
+                ++n;
+            }
+        }
+        other.erase(first.ptr, tail, n);
+        insert(pos.ptr, first.ptr, tail, n);
+    }
+    /**
+     * stable merge sort by relinking, as list::sort
+     * if cmp throws, every element is kept but their order is unspecified.
+     */
+    void sort() { sort(less()); }
+    template<typename Compare>
+    void sort(Compare cmp) {
+        if (sz <= 1) return;
+        chain_detail::sort(&head, value_of(), cmp);
+    }
+    /**
+     * merge two sorted lists into one as list::merge, other becomes empty
+     * elements of *this precede equivalent elements of other
+     */
+    void merge(intrusive_list &other) { merge(other, less()); }
+    template<typename Compare>
+    void merge(intrusive_list &other, Compare cmp) {
+        if (this == &other || other.sz == 0) return;
+        sz += other.sz;
+        other.sz = 0;
+        chain_detail::merge_into(&head, &other.head, value_of(), cmp);
+    }
+    /**
+     * merge every sorted list of [first, last) into *this in one pass, as list::merge_all
+     * the one member that allocates: the tournament tree takes O(k) memory for k lists,
+     * so it may throw bad_alloc, before anything is merged
+     */
+    template<typename ForwardIt>
+    void merge_all(ForwardIt first, ForwardIt last) { merge_all(first, last, less()); }
+    template<typename ForwardIt, typename Compare>
+    void merge_all(ForwardIt first, ForwardIt last, Compare cmp) {
+        size_t k = 1;
+        for (ForwardIt it = first; it != last; ++it) {
+            intrusive_list &l = as_list(*it);
+            if (&l != this && l.sz) ++k;
+        }
+        if (k == 1) return;
+        chain_detail::tournament<hook> t(k);
+        t.add(&head);
+        for (ForwardIt it = first; it != last; ++it) {
+            intrusive_list &l = as_list(*it);
+            if (&l == this || l.sz == 0) continue;
+            sz += l.sz;
+            l.sz = 0;
+            t.add(&l.head);
+        }
+        t.merge_into(&head, value_of(), cmp);
+    }
+    void reverse() {
+        if (sz <= 1) return;
+        chain_detail::reverse(&head);
+    }
+    /**
+     * unlink all but the first element of each group of consecutive equal elements
+     */
+    void unique() { unique(equal_to()); }
+    template<typename BinaryPredicate>
+    void unique(BinaryPredicate pred) {
+        if (sz <= 1) return;
+        chain_detail::unique(&head, value_of(), pred, [this](hook *dup) { erase(dup); });
+    }
+    /**
+     * unlink every element equal to value (operator== of T) / for which pred holds
+     * return the number of unlinked elements
+     */
+    size_t remove(const T &value) {
+        return remove_if([&value](const T &x) { return x == value; });
+    }
+    template<typename Predicate>
+    size_t remove_if(Predicate pred) {
+        return chain_detail::remove_if(&head, value_of(), pred, [this](hook *cur) { erase(cur); });
+    }
+};
+
+}
+
+#undef SJTU_INTRUSIVE_CHECK
+
+#endif //SJTU_INTRUSIVE_LIST_HPP
@@ -3,44 +3,212 @@
 
 #include "exceptions.hpp"
 #include "algorithm.hpp"
+#include "chain.hpp"
+#include "pool.hpp"
+#include "stats.hpp"
 
 #include <climits>
 #include <cstddef>
+#include <initializer_list>
+#include <iosfwd>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * define SJTU_LIST_UNROLLED to make sjtu::list the chunked unrolled_list of unrolled_list.hpp,
+ * SJTU_LIST_INDEXED to make it the indexed_list of indexed_list.hpp,
+ * or SJTU_LIST_COMPACT to make it the compact_list of compact_list.hpp,
+ * e.g. to run code written against sjtu::list on them unchanged.
+ */
+#if defined(SJTU_LIST_UNROLLED)
+#include "unrolled_list.hpp"
+
+namespace sjtu {
+template<typename T>
+using list = unrolled_list<T>;
+}
+#elif defined(SJTU_LIST_INDEXED)
+#include "indexed_list.hpp"
+
+namespace sjtu {
+template<typename T>
+using list = indexed_list<T>;
+}
+#elif defined(SJTU_LIST_COMPACT)
+#include "compact_list.hpp"
+
+namespace sjtu {
+template<typename T>
+using list = compact_list<T>;
+}
+#else
+
+/**
+ * iterator checking policy.
+ * by default an iterator remembers its list and misuse throws invalid_iterator.
+ * define SJTU_LIST_UNCHECKED before including this header to drop the checks:
+ * iterators shrink to a single node pointer and misuse is undefined, as with std::list.
+ */
+#ifdef SJTU_LIST_UNCHECKED
+#define SJTU_LIST_CHECK(cond) ((void)0)
+#else
+#define SJTU_LIST_CHECK(cond) do { if (cond) throw invalid_iterator(__func__); } while (0)
+#endif
+
+/**
+ * instrumentation policy.
+ * define SJTU_LIST_STATS to have every list count what it does into its stats() (see stats.hpp);
+ * iterators then remember their list even when unchecked, to count their steps.
+ * SJTU_LIST_COUNT(expr) evaluates expr, SJTU_LIST_TIME(op) times the rest of the enclosing block.
+ */
+#ifdef SJTU_LIST_STATS
+#define SJTU_LIST_COUNT(expr) ((void)(expr))
+#define SJTU_LIST_TIME(op) list_stats::scope stats_scope(counters, list_stats::op)
+#else
+#define SJTU_LIST_COUNT(expr) ((void)0)
+#define SJTU_LIST_TIME(op) ((void)0)
+#endif
+/**
+ * reversal policy.
+ * define SJTU_LIST_LAZY_REVERSE to make reverse() O(1): the list keeps an orientation bit,
+ * read by the iterators, the ends and the operations on single nodes, and the chain is
+ * relinked into its logical order only by the operations that walk it in order (see settle());
+ * iterators then remember their list even when unchecked, to read the bit.
+ * SJTU_LIST_FWD(p) / SJTU_LIST_BWD(p) step an iterator's node by the orientation of its list.
+ */
+#ifdef SJTU_LIST_LAZY_REVERSE
+#define SJTU_LIST_FWD(p) (owner->fwd(p))
+#define SJTU_LIST_BWD(p) (owner->bwd(p))
+#else
+#define SJTU_LIST_FWD(p) ((p)->next)
+#define SJTU_LIST_BWD(p) ((p)->prev)
+#endif
+#if !defined(SJTU_LIST_UNCHECKED) || defined(SJTU_LIST_STATS) || defined(SJTU_LIST_LAZY_REVERSE)
+#define SJTU_LIST_OWNED
+#endif
 
 namespace sjtu {
+template<typename T>
+class concurrent_queue;
+template<typename T>
+class list_io;
+
 /**
  * a data container like std::list
  * allocate random memory addresses for data and they are doubly-linked in a list.
+ * no member is virtual, so a list carries no vtable pointer and every call can be inlined;
+ * a derived class must not be destroyed through a pointer to list.
  */
 template<typename T>
 class list {
+    // hands its nodes to a list and takes them from one without copying
+    friend class concurrent_queue<T>;
+    // builds the node chain of load() straight from the bytes read
+    friend class list_io<T>;
 protected:
+    /**
+     * the element lives inside the node in raw aligned storage,
+     * so one allocation serves both links and value.
+     * the sentinel head is a node whose storage is never constructed.
+     * next comes first so that a chain of nodes is also a free list of arena_type.
+     */
     class node {
     public:
-        node *prev, *next;
-        T *val;
-        node(): prev(nullptr), next(nullptr), val(nullptr) {}
-        explicit node(const T &v): prev(nullptr), next(nullptr), val(new T(v)) {}
-        ~node(){ if (val) { delete val; val = nullptr; } }
+        node *next, *prev;
+        node(): next(nullptr), prev(nullptr) {}
+        T *val() { return reinterpret_cast<T *>(storage); }
+        const T *val() const { return reinterpret_cast<const T *>(storage); }
+    private:
+        alignas(T) unsigned char storage[sizeof(T)];
     };
 
+public:
+    /**
+     * a slab of list nodes that several lists may share.
+     * nodes can only be merged between lists drawing from the same arena.
+     */
+    typedef node_pool<sizeof(node), alignof(node)> arena_type;
+
 protected:
     /**
      * add data members for linked list as protected members
      */
     node *head = nullptr;
     size_t sz = 0;
+    arena_type *pool = nullptr; // nullptr: nodes come from the global heap
+#ifdef SJTU_LIST_STATS
+    mutable list_stats counters; // mutable: const iterators count their steps too
+#endif
+#ifdef SJTU_LIST_LAZY_REVERSE
+    bool flipped = false; // the logical order runs from head through prev
+
+    node *fwd(node *p) const { return flipped ? p->prev : p->next; }
+    node *bwd(node *p) const { return flipped ? p->next : p->prev; }
+    /**
+     * relink a reversed chain into its logical order, for the operations that walk the
+     * links directly; every operation on more than one node calls it first
+     */
+    void settle() {
+        if (!flipped) return;
+        flipped = false;
+        chain_detail::reverse(head);
+    }
+#else
+    static node *fwd(node *p) { return p->next; }
+    static node *bwd(node *p) { return p->prev; }
+    static void settle() {}
+#endif
+
+    /**
+     * allocate / release a node without touching its value
+     */
+    node *get_node() {
+        SJTU_LIST_COUNT(++counters.allocations);
+        return pool ? new (pool->allocate()) node() : new node();
+    }
+    void put_node(node *cur) {
+        SJTU_LIST_COUNT(++counters.frees);
+        if (pool) pool->deallocate(cur);
+        else delete cur;
+    }
+    /**
+     * allocate a detached node whose value is constructed from args
+     */
+    template<typename... Args>
+    node *new_node(Args &&... args) {
+        node *cur = get_node();
+        try {
+            new (cur->val()) T(std::forward<Args>(args)...);
+        } catch (...) {
+            put_node(cur);
+            throw;
+        }
+        return cur;
+    }
+    /**
+     * destroy the value held by cur and release the node
+     */
+    void delete_node(node *cur) {
+        cur->val()->~T();
+        put_node(cur);
+    }
 
     /**
      * insert node cur before node pos
      * return the inserted node cur
      */
     node *insert(node *pos, node *cur) {
+#ifdef SJTU_LIST_LAZY_REVERSE
+        // logically before pos is physically before the node after it
+        if (flipped) pos = pos->next;
+#endif
         cur->prev = pos->prev;
         cur->next = pos;
         pos->prev->next = cur;
         pos->prev = cur;
         ++sz;
+        SJTU_LIST_COUNT(counters.grown(sz));
         return cur;
     }
     /**
@@ -54,54 +222,269 @@ protected:
         --sz;
         return pos;
     }
+    /**
+     * insert the chain of n nodes from first to last (linked through next) before node pos
+     * the chain primitives take the links as they are: the list must be settled
+     */
+    void insert(node *pos, node *first, node *last, size_t n) {
+        first->prev = pos->prev;
+        last->next = pos;
+        pos->prev->next = first;
+        pos->prev = last;
+        sz += n;
+        SJTU_LIST_COUNT(counters.grown(sz));
+    }
+    /**
+     * remove the n nodes from first to last from list, they stay linked to each other
+     */
+    void erase(node *first, node *last, size_t n) {
+        first->prev->next = last->next;
+        last->next->prev = first->prev;
+        first->prev = last->next = nullptr;
+        sz -= n;
+    }
+    /**
+     * insert the chain of n nodes from first to last, as erased from other, logically before pos.
+     * O(1) when both lists run the same way; otherwise the chain is turned around first, O(n)
+     */
+    void splice_chain(node *pos, const list &other, node *first, node *last, size_t n) {
+#ifdef SJTU_LIST_LAZY_REVERSE
+        if (flipped != other.flipped) {
+            for (node *p = first; p; p = p->prev) std::swap(p->next, p->prev);
+            std::swap(first, last);
+        }
+        // logically before pos is physically after it
+        if (flipped) pos = pos->next;
+#else
+        (void)other;
+#endif
+        insert(pos, first, last, n);
+    }
+
+    /**
+     * the default ordering, operator< of T
+     */
+    struct less {
+        bool operator()(const T &a, const T &b) const { return a < b; }
+    };
+    /**
+     * the default equivalence, operator== of T
+     */
+    struct equal_to {
+        bool operator()(const T &a, const T &b) const { return a == b; }
+    };
+    /**
+     * cmp, counting its calls into the stats when they are kept
+     */
+#ifdef SJTU_LIST_STATS
+    template<typename F>
+    list_stats::counted<F> counted(F &cmp) const { return list_stats::counted<F>{cmp, counters.comparisons}; }
+#else
+    template<typename F>
+    static F &counted(F &cmp) { return cmp; }
+#endif
+    /**
+     * a chain of nodes from first to last, linked in both directions
+     */
+    typedef chain_detail::run<node> run;
+    /**
+     * the element of a node, for the shared chain algorithms
+     */
+    struct value_of {
+        T &operator()(node *p) const { return *(p->val()); }
+    };
+    /**
+     * an element of the range given to merge_all()
+     */
+    static list &as_list(list &l) { return l; }
+    static list &as_list(list *l) { return *l; }
+    /**
+     * release every node of a detached chain ending with nullptr
+     */
+    void release_chain(node *cur) {
+        while (cur) {
+            node *nxt = cur->next;
+            delete_node(cur);
+            cur = nxt;
+        }
+    }
+    /**
+     * append a node to a detached chain
+     */
+    static void chain_push(run &c, node *cur) {
+        if (c.first) {
+            c.last->next = cur;
+            cur->prev = c.last;
+        } else {
+            c.first = cur;
+        }
+        c.last = cur;
+    }
+    /**
+     * build a detached chain holding copies of [first, last) in one pass, n receives its length
+     * if a copy throws, the nodes built so far are released
+     */
+    template<typename InputIt>
+    run build_chain(InputIt first, InputIt last, size_t &n) {
+        run c;
+        n = 0;
+        try {
+            for (; first != last; ++first, ++n) chain_push(c, new_node(*first));
+        } catch (...) {
+            release_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+    /**
+     * build a detached chain of n copies of value
+     */
+    run build_chain(size_t n, const T &value) {
+        run c;
+        try {
+            for (size_t i = 0; i < n; ++i) chain_push(c, new_node(value));
+        } catch (...) {
+            release_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+    /**
+     * link a detached chain of n nodes before pos with one relink
+     * return the first linked node, or pos if the chain is empty
+     */
+    node *link_chain(node *pos, run c, size_t n) {
+        if (!n) return pos;
+        insert(pos, c.first, c.last, n);
+        return c.first;
+    }
+    /**
+     * release the nodes from cur to the back of the list
+     */
+    void erase_tail(node *cur) {
+        if (cur == head) return;
+        node *last = head->prev;
+        size_t n = 0;
+        for (node *p = cur; p != head; p = p->next) ++n;
+        erase(cur, last, n);
+        release_chain(cur);
+    }
+    /**
+     * allocate the sentinel of an empty list
+     */
+    void init() {
+        head = get_node();
+        head->next = head->prev = head;
+        sz = 0;
+    }
+    /**
+     * fill an empty list from a detached chain; used by constructors, so
+     * the sentinel is released again if building the chain throws
+     */
+    template<typename... Args>
+    void init_from(Args &&... args) {
+        init();
+        try {
+            size_t n;
+            run c = make_chain(n, std::forward<Args>(args)...);
+            link_chain(head, c, n);
+        } catch (...) {
+            put_node(head);
+            head = nullptr;
+            throw;
+        }
+    }
+    template<typename InputIt>
+    run make_chain(size_t &n, InputIt first, InputIt last) { return build_chain(first, last, n); }
+    run make_chain(size_t &n, size_t count, const T &value) { n = count; return build_chain(count, value); }
+    /**
+     * read-only walk over the values of a node chain, so that
+     * copying between lists skips the checked iterators
+     */
+    struct value_walker {
+        const list *l;
+        node *p;
+        const T & operator*() const { return *(p->val()); }
+        value_walker & operator++() { p = l->fwd(p); return *this; }
+        bool operator!=(const value_walker &rhs) const { return p != rhs.p; }
+    };
+    /**
+     * assign [first, last) over the existing elements, reusing their nodes,
+     * then append the rest of the range or release the extra nodes
+     */
+    template<typename InputIt>
+    void assign_range(InputIt first, InputIt last) {
+        if (!head) init();
+        settle();
+        node *cur = head->next;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; cur != head && first != last; cur = cur->next, ++first) *(cur->val()) = *first;
+        }
+        erase_tail(cur);
+        size_t n;
+        run c = build_chain(first, last, n);
+        link_chain(head, c, n);
+    }
+    /**
+     * InputIt is accepted as an iterator only if it is not an integer,
+     * so that list(5, 3) still means five threes
+     */
+    template<typename InputIt>
+    using if_iterator = typename std::enable_if<!std::is_integral<InputIt>::value>::type;
 
 public:
     class const_iterator;
     class iterator {
     private:
+#ifdef SJTU_LIST_OWNED
         list *owner = nullptr;
+#endif
         node *ptr = nullptr;
         friend class const_iterator;
         friend class list;
     public:
         iterator() = default;
+#ifdef SJTU_LIST_OWNED
         iterator(list *o, node *p) : owner(o), ptr(p) {}
+#else
+        iterator(list *, node *p) : ptr(p) {}
+#endif
         /**
          * iter++
          */
         iterator operator++(int) {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
             iterator tmp = *this;
-            ptr = ptr->next;
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_FWD(ptr);
             return tmp;
         }
         /**
          * ++iter
          */
         iterator & operator++() {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
-            ptr = ptr->next;
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_FWD(ptr);
             return *this;
         }
         /**
          * iter--
          */
         iterator operator--(int) {
-            if (!owner || !ptr) throw invalid_iterator();
-            if (owner->sz == 0) throw invalid_iterator();
-            if (ptr->prev == owner->head) throw invalid_iterator();
+            SJTU_LIST_CHECK(!owner || !ptr || SJTU_LIST_BWD(ptr) == owner->head);
             iterator tmp = *this;
-            ptr = ptr->prev;
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_BWD(ptr);
             return tmp;
         }
         /**
          * --iter
          */
         iterator & operator--() {
-            if (!owner || !ptr) throw invalid_iterator();
-            if (owner->sz == 0) throw invalid_iterator();
-            if (ptr->prev == owner->head) throw invalid_iterator();
-            ptr = ptr->prev;
+            SJTU_LIST_CHECK(!owner || !ptr || SJTU_LIST_BWD(ptr) == owner->head);
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_BWD(ptr);
             return *this;
         }
         /**
@@ -109,21 +492,25 @@ public:
          * remember to throw if iterator is invalid
          */
         T & operator *() const {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
-            return *(ptr->val);
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
+            return *(ptr->val());
         }
         /**
          * TODO it->field
          * remember to throw if iterator is invalid
          */
         T * operator ->() const {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
-            return ptr->val;
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
+            return ptr->val();
         }
         /**
          * a operator to check whether two iterators are same (pointing to the same memory).
          */
+#ifdef SJTU_LIST_OWNED
         bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+#else
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr; }
+#endif
         bool operator==(const const_iterator &rhs) const { return rhs == *this; }
         /**
          * some other operator for iterator.
@@ -138,50 +525,62 @@ public:
      */
     class const_iterator {
     private:
+#ifdef SJTU_LIST_OWNED
         const list *owner = nullptr;
+#endif
         node *ptr = nullptr;
         friend class iterator;
         friend class list;
     public:
         const_iterator() = default;
+#ifdef SJTU_LIST_OWNED
         const_iterator(const list *o, node *p) : owner(o), ptr(p) {}
         const_iterator(const iterator &it) : owner(it.owner), ptr(it.ptr) {}
+#else
+        const_iterator(const list *, node *p) : ptr(p) {}
+        const_iterator(const iterator &it) : ptr(it.ptr) {}
+#endif
         const_iterator operator++(int) {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
             const_iterator tmp = *this;
-            ptr = ptr->next;
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_FWD(ptr);
             return tmp;
         }
         const_iterator & operator++() {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
-            ptr = ptr->next;
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_FWD(ptr);
             return *this;
         }
         const_iterator operator--(int) {
-            if (!owner || !ptr) throw invalid_iterator();
-            if (owner->sz == 0) throw invalid_iterator();
-            if (ptr->prev == owner->head) throw invalid_iterator();
+            SJTU_LIST_CHECK(!owner || !ptr || SJTU_LIST_BWD(ptr) == owner->head);
             const_iterator tmp = *this;
-            ptr = ptr->prev;
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_BWD(ptr);
             return tmp;
         }
         const_iterator & operator--() {
-            if (!owner || !ptr) throw invalid_iterator();
-            if (owner->sz == 0) throw invalid_iterator();
-            if (ptr->prev == owner->head) throw invalid_iterator();
-            ptr = ptr->prev;
+            SJTU_LIST_CHECK(!owner || !ptr || SJTU_LIST_BWD(ptr) == owner->head);
+            SJTU_LIST_COUNT(++owner->counters.steps);
+            ptr = SJTU_LIST_BWD(ptr);
             return *this;
         }
         const T & operator *() const {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
-            return *(ptr->val);
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
+            return *(ptr->val());
         }
         const T * operator ->() const {
-            if (!owner || !ptr || ptr == owner->head) throw invalid_iterator();
-            return ptr->val;
+            SJTU_LIST_CHECK(!owner || !ptr || ptr == owner->head);
+            return ptr->val();
         }
+#ifdef SJTU_LIST_OWNED
         bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
         bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr; }
+#else
+        bool operator==(const const_iterator &rhs) const { return ptr == rhs.ptr; }
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr; }
+#endif
         bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
         bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
     };
@@ -189,50 +588,114 @@ public:
      * TODO Constructs
      * Atleast two: default constructor, copy constructor
      */
-    list() {
-        head = new node();
-        head->next = head->prev = head;
-        sz = 0;
+    list() { init(); }
+    /**
+     * a list whose nodes (sentinel included) are drawn from arena.
+     * the arena must outlive the list.
+     */
+    explicit list(arena_type &arena) : pool(&arena) { init(); }
+    /**
+     * the copy shares the arena of other
+     * the node chain is built in one pass and linked at once
+     */
+    list(const list &other) : pool(other.pool) {
+        SJTU_LIST_TIME(copy);
+        init_from(value_walker{&other, other.fwd(other.head)}, value_walker{&other, other.head});
     }
-    list(const list &other) {
-        head = new node();
-        head->next = head->prev = head;
-        sz = 0;
-        for (auto it = other.cbegin(); it != other.cend(); ++it) push_back(*it);
+    /**
+     * n copies of value
+     */
+    list(size_t n, const T &value) { init_from(n, value); }
+    /**
+     * copies of the elements in [first, last)
+     */
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    list(InputIt first, InputIt last) { init_from(first, last); }
+    list(std::initializer_list<T> values) { init_from(values.begin(), values.end()); }
+    /**
+     * steal the sentinel (and so every node) of other, no element is touched.
+     * other gets a fresh sentinel and stays a valid empty list; the move allocates nothing
+     * else, and std::terminate is called should that one allocation fail.
+     */
+    list(list &&other) noexcept : head(other.head), sz(other.sz), pool(other.pool) {
+        other.init();
+#ifdef SJTU_LIST_LAZY_REVERSE
+        std::swap(flipped, other.flipped);
+#endif
+        SJTU_LIST_COUNT(counters.grown(sz));
     }
     /**
      * TODO Destructor
      */
-    virtual ~list() {
+    ~list() {
         clear();
-        if (head) { delete head; head = nullptr; }
+        if (head) { put_node(head); head = nullptr; }
     }
     /**
      * TODO Assignment operator
      */
     list &operator=(const list &other) {
         if (this == &other) return *this;
-        clear();
-        for (auto it = other.cbegin(); it != other.cend(); ++it) push_back(*it);
+        SJTU_LIST_TIME(copy);
+        assign_range(value_walker{&other, other.fwd(other.head)}, value_walker{&other, other.head});
         return *this;
     }
+    /**
+     * exchange sentinels with other, which takes over the old elements of *this
+     */
+    list &operator=(list &&other) noexcept {
+        if (this == &other) return *this;
+        std::swap(head, other.head);
+        std::swap(sz, other.sz);
+        std::swap(pool, other.pool);
+#ifdef SJTU_LIST_LAZY_REVERSE
+        std::swap(flipped, other.flipped);
+#endif
+        SJTU_LIST_COUNT(counters.grown(sz));
+        return *this;
+    }
+    list &operator=(std::initializer_list<T> values) {
+        SJTU_LIST_TIME(assign);
+        assign_range(values.begin(), values.end());
+        return *this;
+    }
+    /**
+     * replace the contents, existing nodes are reused by assigning over their values
+     */
+    void assign(size_t n, const T &value) {
+        SJTU_LIST_TIME(assign);
+        if (!head) init();
+        settle();
+        node *cur = head->next;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; cur != head && n; cur = cur->next, --n) *(cur->val()) = value;
+        }
+        erase_tail(cur);
+        link_chain(head, build_chain(n, value), n);
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    void assign(InputIt first, InputIt last) {
+        SJTU_LIST_TIME(assign);
+        assign_range(first, last);
+    }
+    void assign(std::initializer_list<T> values) { assign(values.begin(), values.end()); }
     /**
      * access the first / last element
      * throw container_is_empty when the container is empty.
      */
     const T & front() const {
-        if (sz == 0) throw container_is_empty();
-        return *(head->next->val);
+        if (sz == 0) throw container_is_empty(__func__);
+        return *(fwd(head)->val());
     }
     const T & back() const {
-        if (sz == 0) throw container_is_empty();
-        return *(head->prev->val);
+        if (sz == 0) throw container_is_empty(__func__);
+        return *(bwd(head)->val());
     }
     /**
      * returns an iterator to the beginning.
      */
-    iterator begin() { return iterator(this, head->next); }
-    const_iterator cbegin() const { return const_iterator(this, head->next); }
+    iterator begin() { return iterator(this, fwd(head)); }
+    const_iterator cbegin() const { return const_iterator(this, fwd(head)); }
     /**
      * returns an iterator to the end.
      */
@@ -241,33 +704,99 @@ public:
     /**
      * checks whether the container is empty.
      */
-    virtual bool empty() const { return sz == 0; }
+    bool empty() const { return sz == 0; }
     /**
      * returns the number of elements
      */
-    virtual size_t size() const { return sz; }
+    size_t size() const { return sz; }
+    /**
+     * the arena the nodes are drawn from, nullptr for the global heap
+     */
+    arena_type *arena() const { return pool; }
+    /**
+     * a snapshot of what this list has done, all zero unless SJTU_LIST_STATS is defined
+     */
+#ifdef SJTU_LIST_STATS
+    const list_stats &stats() const { return counters; }
+    void reset_stats() {
+        counters = list_stats();
+        counters.grown(sz);
+    }
+#else
+    const list_stats &stats() const {
+        static const list_stats none;
+        return none;
+    }
+    void reset_stats() {}
+#endif
 
     /**
      * clears the contents
      */
-    virtual void clear() {
+    void clear() {
+        SJTU_LIST_TIME(clear);
+        if (std::is_trivially_destructible<T>::value && pool && sz) {
+            // nothing to destroy: the chain is handed back to the arena as is
+            SJTU_LIST_COUNT(counters.frees += sz);
+            pool->deallocate_chain(head->next, head->prev);
+            head->next = head->prev = head;
+            sz = 0;
+            settle();
+            return;
+        }
         node *cur = head ? head->next : nullptr;
         while (cur && cur != head) {
             node *nxt = cur->next;
-            delete cur;
+            delete_node(cur);
             cur = nxt;
         }
         if (head) head->next = head->prev = head;
         sz = 0;
+        settle(); // an empty chain reads the same either way
     }
     /**
      * insert value before pos (pos may be the end() iterator)
      * return an iterator pointing to the inserted value
      * throw if the iterator is invalid
      */
-    virtual iterator insert(iterator pos, const T &value) {
-        if (pos.owner != this || pos.ptr == nullptr) throw invalid_iterator();
-        node *cur = new node(value);
+    iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+    iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+    /**
+     * insert n copies of value before pos
+     * the nodes are built off the list and linked with a single relink
+     * return an iterator to the first inserted element, or pos if n is 0
+     * throw if the iterator is invalid
+     */
+    iterator insert(iterator pos, size_t n, const T &value) {
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_LIST_TIME(insert);
+        settle();
+        return iterator(this, link_chain(pos.ptr, build_chain(n, value), n));
+    }
+    /**
+     * insert copies of [first, last) before pos, same as above
+     */
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    iterator insert(iterator pos, InputIt first, InputIt last) {
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_LIST_TIME(insert);
+        size_t n;
+        run c = build_chain(first, last, n);
+        settle();
+        return iterator(this, link_chain(pos.ptr, c, n));
+    }
+    iterator insert(iterator pos, std::initializer_list<T> values) {
+        return insert(pos, values.begin(), values.end());
+    }
+    /**
+     * construct a value in place from args before pos
+     * return an iterator pointing to it
+     * throw if the iterator is invalid
+     */
+    template<typename... Args>
+    iterator emplace(iterator pos, Args &&... args) {
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr);
+        node *cur = new_node(std::forward<Args>(args)...);
         insert(pos.ptr, cur);
         return iterator(this, cur);
     }
@@ -276,65 +805,203 @@ public:
      * returns an iterator pointing to the following element, if pos pointing to the last element, end() will be returned.
      * throw if the container is empty, the iterator is invalid
      */
-    virtual iterator erase(iterator pos) {
-        if (sz == 0) throw container_is_empty();
-        if (pos.owner != this || pos.ptr == nullptr || pos.ptr == head) throw invalid_iterator();
-        node *nxt = pos.ptr->next;
+    iterator erase(iterator pos) {
+        if (sz == 0) throw container_is_empty(__func__);
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr || pos.ptr == head);
+        node *nxt = fwd(pos.ptr);
         node *rm = erase(pos.ptr);
-        delete rm;
+        delete_node(rm);
         return iterator(this, nxt);
     }
     /**
      * adds an element to the end
      */
     void push_back(const T &value) { insert(iterator(this, head), value); }
+    void push_back(T &&value) { insert(iterator(this, head), std::move(value)); }
+    template<typename... Args>
+    T & emplace_back(Args &&... args) { return *emplace(iterator(this, head), std::forward<Args>(args)...); }
     /**
      * removes the last element
      * throw when the container is empty.
      */
     void pop_back() {
-        if (sz == 0) throw container_is_empty();
-        erase(iterator(this, head->prev));
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, bwd(head)));
     }
     /**
      * inserts an element to the beginning.
      */
-    void push_front(const T &value) { insert(iterator(this, head->next), value); }
+    void push_front(const T &value) { insert(iterator(this, fwd(head)), value); }
+    void push_front(T &&value) { insert(iterator(this, fwd(head)), std::move(value)); }
+    template<typename... Args>
+    T & emplace_front(Args &&... args) { return *emplace(iterator(this, fwd(head)), std::forward<Args>(args)...); }
     /**
      * removes the first element.
      * throw when the container is empty.
      */
     void pop_front() {
-        if (sz == 0) throw container_is_empty();
-        erase(iterator(this, head->next));
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, fwd(head)));
+    }
+    /**
+     * pop_front(), pop_back() and erase() for callers that would rather not catch:
+     * the error comes back as a code and nothing is thrown.
+     * errc::container_is_empty for an empty list, errc::invalid_iterator for end() or,
+     * when iterators are checked, an iterator of another list; errc::ok once the element is gone.
+     * the overloads taking value move the element into it first; if that throws,
+     * the exception propagates and the element stays.
+     */
+    errc try_pop_front() noexcept {
+        if (sz == 0) return errc::container_is_empty;
+        delete_node(erase(fwd(head)));
+        return errc::ok;
+    }
+    errc try_pop_front(T &value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+        if (sz == 0) return errc::container_is_empty;
+        value = std::move(*(fwd(head)->val()));
+        delete_node(erase(fwd(head)));
+        return errc::ok;
+    }
+    errc try_pop_back() noexcept {
+        if (sz == 0) return errc::container_is_empty;
+        delete_node(erase(bwd(head)));
+        return errc::ok;
+    }
+    errc try_pop_back(T &value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+        if (sz == 0) return errc::container_is_empty;
+        value = std::move(*(bwd(head)->val()));
+        delete_node(erase(bwd(head)));
+        return errc::ok;
+    }
+    /**
+     * next receives the iterator following the erased element, it is unchanged on error
+     */
+    errc try_erase(iterator pos, iterator &next) noexcept {
+        if (sz == 0) return errc::container_is_empty;
+#ifndef SJTU_LIST_UNCHECKED
+        if (pos.owner != this) return errc::invalid_iterator;
+#endif
+        if (!pos.ptr || pos.ptr == head) return errc::invalid_iterator;
+        next = iterator(this, fwd(pos.ptr));
+        delete_node(erase(pos.ptr));
+        return errc::ok;
+    }
+    errc try_erase(iterator pos) noexcept {
+        iterator next;
+        return try_erase(pos, next);
+    }
+    /**
+     * move all elements of other before pos, other becomes empty
+     * no elements are copied or moved, O(1); with SJTU_LIST_LAZY_REVERSE, O(other.size())
+     * when only one of the two lists is reversed, to relink the moved nodes into order
+     * throw invalid_iterator if pos does not belong to *this,
+     * runtime_error if the two lists draw from different arenas
+     */
+    void splice(iterator pos, list &other) {
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr);
+        if (this == &other || other.sz == 0) return;
+        if (pool != other.pool) throw runtime_error(__func__);
+        SJTU_LIST_TIME(splice);
+        node *first = other.head->next, *last = other.head->prev;
+        size_t n = other.sz;
+        other.erase(first, last, n);
+        splice_chain(pos.ptr, other, first, last, n);
+    }
+    /**
+     * move the element at it from other before pos, other may be *this
+     * no elements are copied or moved, O(1)
+     */
+    void splice(iterator pos, list &other, iterator it) {
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_LIST_CHECK(it.owner != &other || it.ptr == nullptr || it.ptr == other.head);
+        if (pool != other.pool) throw runtime_error(__func__);
+        if (pos.ptr == it.ptr || pos.ptr == other.fwd(it.ptr)) return;
+        SJTU_LIST_TIME(splice);
+        insert(pos.ptr, other.erase(it.ptr));
+    }
+    /**
+     * move the elements in [first, last) from other before pos, other may be *this
+     * (then pos shall not be inside the range)
+     * no elements are copied or moved, relinking is O(1),
+     * counting the moved elements is O(distance) unless other is *this; with
+     * SJTU_LIST_LAZY_REVERSE, relinking is O(distance) too when only one of the two lists
+     * is reversed
+     */
+    void splice(iterator pos, list &other, iterator first, iterator last) {
+        SJTU_LIST_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_LIST_CHECK(first.owner != &other || last.owner != &other || first.ptr == nullptr || last.ptr == nullptr);
+        if (pool != other.pool) throw runtime_error(__func__);
+        if (first.ptr == last.ptr || pos.ptr == first.ptr || pos.ptr == last.ptr) return;
+        SJTU_LIST_TIME(splice);
+        // the range runs from first to the node before last in the logical order
+        node *from = first.ptr, *to = other.bwd(last.ptr);
+        size_t n = 0;
+        if (this != &other) {
+            for (node *cur = first.ptr; cur != last.ptr; cur = other.fwd(cur)) {
+                SJTU_LIST_CHECK(cur == other.head);
+                ++n;
+            }
+        }
+#ifdef SJTU_LIST_LAZY_REVERSE
+        if (other.flipped) std::swap(from, to);
+#endif
+        other.erase(from, to, n);
+        splice_chain(pos.ptr, other, from, to, n);
     }
     /**
      * sort the values in ascending order with operator< of T
      */
-    void sort() {
+    void sort() { sort(less()); }
+    /**
+     * sort the values in ascending order with cmp(a, b) meaning a goes before b
+     * stable bottom-up merge sort: nodes are relinked, no element is copied,
+     * O(n log n) comparisons and O(1) extra memory.
+     * if cmp throws, every element is kept but their order is unspecified.
+     */
+    template<typename Compare>
+    void sort(Compare cmp) {
         if (sz <= 1) return;
+        SJTU_LIST_TIME(sort);
+        auto &&compare = counted(cmp);
+        settle();
+        chain_detail::sort(head, value_of(), compare);
+    }
+    /**
+     * sort() for very long lists, on the threads of policy (see sjtu::parallel_stable_sort).
+     * the nodes are gathered into an array, the array is sorted in parallel and the list
+     * is relinked from it in one pass, at the cost of O(n) extra memory.
+     * stable, like sort(), and no element is copied or moved.
+     * if cmp throws, the list is left as it was.
+     */
+    void parallel_sort(parallel_policy policy = parallel_policy()) { parallel_sort(less(), policy); }
+    template<typename Compare>
+    void parallel_sort(Compare cmp, parallel_policy policy = parallel_policy()) {
+        if (sz <= 1) return;
+        SJTU_LIST_TIME(parallel_sort);
         node **a = new node*[sz];
         size_t idx = 0;
-        for (node *cur = head->next; cur != head; cur = cur->next) a[idx++] = cur;
-        int *L = new int[sz], *R = new int[sz];
-        int top = 0; L[0] = 0; R[0] = (int)sz - 1;
-        while (top >= 0) {
-            int l = L[top], r = R[top];
-            --top;
-            int i = l, j = r;
-            node *pivot = a[(l + r) >> 1];
-            while (i <= j) {
-                while (*(a[i]->val) < *(pivot->val)) ++i;
-                while (*(pivot->val) < *(a[j]->val)) --j;
-                if (i <= j) { node *t = a[i]; a[i] = a[j]; a[j] = t; ++i; --j; }
-            }
-            if (l < j) { ++top; L[top] = l; R[top] = j; }
-            if (i < r) { ++top; L[top] = i; R[top] = r; }
+        for (node *cur = fwd(head); cur != head; cur = fwd(cur)) a[idx++] = cur;
+        try {
+            sjtu::parallel_stable_sort(a, a + sz, [&cmp](const node *x, const node *y) {
+                return cmp(*x->val(), *y->val());
+            }, policy);
+        } catch (...) {
+            delete [] a;
+            throw;
         }
-        head->next = a[0]; a[0]->prev = head;
-        for (size_t k = 1; k < sz; ++k) { a[k-1]->next = a[k]; a[k]->prev = a[k-1]; }
-        a[sz-1]->next = head; head->prev = a[sz-1];
-        delete [] L; delete [] R; delete [] a;
+        node *prev = head;
+        for (size_t k = 0; k < sz; ++k) {
+            prev->next = a[k];
+            a[k]->prev = prev;
+            prev = a[k];
+        }
+        prev->next = head;
+        head->prev = prev;
+        delete [] a;
+        // relinked from the array in logical order
+#ifdef SJTU_LIST_LAZY_REVERSE
+        flipped = false;
+#endif
     }
     /**
      * merge two sorted lists into one (both in ascending order)
@@ -343,66 +1010,159 @@ public:
      * for equivalent elements in the two lists, the elements from *this shall always precede the elements from other
      * the order of equivalent elements of *this and other does not change.
      * no elements are copied or moved
+     * throw runtime_error if the two lists draw from different arenas
+     */
+    void merge(list &other) { merge(other, less()); }
+    /**
+     * same as merge(other), both lists being sorted by cmp
      */
-    void merge(list &other) {
+    template<typename Compare>
+    void merge(list &other, Compare cmp) {
         if (this == &other || other.sz == 0) return;
-        node *a = head->next, *b = other.head->next;
-        node *tail = head;
-        // detach current chain
-        head->next = head->prev = head;
-        size_t new_sz = sz + other.sz;
-        while (a != nullptr && b != nullptr && a != head && b != other.head) {
-            if (*(b->val) < *(a->val)) {
-                node *nb = b->next;
-                // splice b
-                b->prev = tail; tail->next = b; tail = b; b = nb;
-            } else {
-                node *na = a->next;
-                a->prev = tail; tail->next = a; tail = a; a = na;
-            }
-        }
-        while (a != head) { node *na = a->next; a->prev = tail; tail->next = a; tail = a; a = na; }
-        while (b != other.head) { node *nb = b->next; b->prev = tail; tail->next = b; tail = b; b = nb; }
-        tail->next = head; head->prev = tail;
-        // other becomes empty
-        other.head->next = other.head->prev = other.head;
+        if (pool != other.pool) throw runtime_error(__func__);
+        SJTU_LIST_TIME(merge);
+        auto &&compare = counted(cmp);
+        // the nodes change hands before they are relinked, so a throwing cmp loses none
+        sz += other.sz;
         other.sz = 0;
-        sz = new_sz;
+        SJTU_LIST_COUNT(counters.grown(sz));
+        settle();
+        other.settle();
+        chain_detail::merge_into(head, other.head, value_of(), compare);
+    }
+    /**
+     * merge every list of [first, last) into *this in one pass, all of them sorted:
+     * a tournament tree over the fronts takes O(n log k) comparisons for k lists,
+     * where merging them one after the other takes O(n k).
+     * the range holds lists (list &, list * or std::reference_wrapper<list>);
+     * they become empty, and *this is skipped if it is among them.
+     * equivalent elements keep the order of their lists: *this first, then the range in order.
+     * no elements are copied or moved
+     * throw runtime_error if a list draws from another arena, before anything is merged
+     * if cmp throws, every element is in *this, in unspecified order.
+     */
+    template<typename ForwardIt>
+    void merge_all(ForwardIt first, ForwardIt last) { merge_all(first, last, less()); }
+    template<typename ForwardIt, typename Compare>
+    void merge_all(ForwardIt first, ForwardIt last, Compare cmp) {
+        size_t k = 1;
+        for (ForwardIt it = first; it != last; ++it) {
+            list &l = as_list(*it);
+            if (&l == this || l.sz == 0) continue;
+            if (pool != l.pool) throw runtime_error(__func__);
+            ++k;
+        }
+        if (k == 1) return;
+        SJTU_LIST_TIME(merge);
+        auto &&compare = counted(cmp);
+        chain_detail::tournament<node> t(k);
+        settle();
+        t.add(head);
+        // a list met twice is empty the second time
+        for (ForwardIt it = first; it != last; ++it) {
+            list &l = as_list(*it);
+            if (&l == this || l.sz == 0) continue;
+            sz += l.sz;
+            l.sz = 0;
+            l.settle();
+            t.add(l.head);
+        }
+        SJTU_LIST_COUNT(counters.grown(sz));
+        t.merge_into(head, value_of(), compare);
     }
     /**
      * reverse the order of the elements
      * no elements are copied or moved
+     * O(1) with SJTU_LIST_LAZY_REVERSE, which only flips the orientation
      */
     void reverse() {
         if (sz <= 1) return;
-        node *cur = head;
-        do {
-            node *tmp = cur->next;
-            cur->next = cur->prev;
-            cur->prev = tmp;
-            cur = tmp;
-        } while (cur != head);
+        SJTU_LIST_TIME(reverse);
+#ifdef SJTU_LIST_LAZY_REVERSE
+        flipped = !flipped;
+#else
+        chain_detail::reverse(head);
+#endif
     }
     /**
      * remove all consecutive duplicate elements from the container
      * only the first element in each group of equal elements is left
      * use operator== of T to compare the elements.
      */
-    void unique() {
+    void unique() { unique(equal_to()); }
+    /**
+     * same as unique(), an element is removed when pred(first of its group, element) holds
+     */
+    template<typename BinaryPredicate>
+    void unique(BinaryPredicate pred) {
         if (sz <= 1) return;
-        node *cur = head->next;
-        while (cur != head && cur->next != head) {
-            if (*(cur->val) == *(cur->next->val)) {
-                node *dup = cur->next;
-                erase(dup);
-                delete dup;
-            } else {
-                cur = cur->next;
-            }
+        SJTU_LIST_TIME(unique);
+        auto &&same = counted(pred);
+        settle();
+        chain_detail::unique(head, value_of(), same, [this](node *dup) {
+            erase(dup);
+            delete_node(dup);
+        });
+    }
+    /**
+     * remove every element equal to value (operator== of T) in one pass
+     * value may refer to an element of the list itself
+     * return the number of removed elements
+     */
+    size_t remove(const T &value) {
+        SJTU_LIST_TIME(remove);
+        node *self = nullptr;
+        size_t cnt = 0;
+        for (node *cur = head->next, *nxt; cur != head; cur = nxt) {
+            nxt = cur->next;
+            if (!(*(cur->val()) == value)) continue;
+            if (cur->val() == &value) { self = cur; continue; }
+            erase(cur);
+            delete_node(cur);
+            ++cnt;
+        }
+        if (self) {
+            erase(self);
+            delete_node(self);
+            ++cnt;
         }
+        return cnt;
     }
+    /**
+     * remove every element for which pred holds in one pass
+     * return the number of removed elements
+     */
+    template<typename Predicate>
+    size_t remove_if(Predicate pred) {
+        SJTU_LIST_TIME(remove);
+        return chain_detail::remove_if(head, value_of(), pred, [this](node *cur) {
+            erase(cur);
+            delete_node(cur);
+        });
+    }
+    /**
+     * write the elements to os / replace them by those read from is, in the binary
+     * format of serialize.hpp, which must be included to use these.
+     * a trivially copyable T is dumped as its bytes and load_file() maps the file
+     * and copies its element array into a node chain in one pass.
+     * throw runtime_error if the stream fails or holds no list of T;
+     * a failed load leaves the list as it was
+     */
+    void save(std::ostream &os) const { list_io<T>::save(*this, os); }
+    void load(std::istream &is) { list_io<T>::load(*this, is); }
+    void save_file(const char *path) const { list_io<T>::save_file(*this, path); }
+    void load_file(const char *path) { list_io<T>::load_file(*this, path); }
 };
 
 }
 
+#undef SJTU_LIST_CHECK
+#undef SJTU_LIST_COUNT
+#undef SJTU_LIST_TIME
+#undef SJTU_LIST_OWNED
+#undef SJTU_LIST_FWD
+#undef SJTU_LIST_BWD
+
+#endif //SJTU_LIST_UNROLLED, SJTU_LIST_INDEXED, SJTU_LIST_COMPACT
+
 #endif //SJTU_LIST_HPP
@@ -0,0 +1,92 @@
+#ifndef SJTU_POOL_HPP
+#define SJTU_POOL_HPP
+
+#include <cstddef>
+
+namespace sjtu {
+/**
+ * a slab allocator handing out blocks of one fixed size.
+ * blocks are carved from chunks whose size doubles up to a cap; freed
+ * blocks go onto an intrusive free list and are reused before a new
+ * chunk is taken. memory goes back to the system a whole chunk at a time,
+ * when release() is called or the pool is destroyed.
+ * a pool may be shared by several containers but is not thread-safe.
+ */
+template<size_t BlockSize, size_t Align = alignof(void *)>
+class node_pool {
+private:
+    /**
+     * a free block stores the link to the next free block in its first word
+     */
+    union block {
+        block *next;
+        alignas(Align) unsigned char bytes[BlockSize];
+    };
+    static const size_t MAX_CHUNK = 1 << 16;
+
+    block *free_list = nullptr;
+    block *chunks = nullptr; // the first block of every chunk links the chunks
+    block *cursor = nullptr, *limit = nullptr; // untouched tail of the newest chunk
+    size_t next_chunk;
+    size_t chunk_cnt = 0;
+
+    void grow() {
+        block *c = new block[next_chunk];
+        c->next = chunks;
+        chunks = c;
+        cursor = c + 1;
+        limit = c + next_chunk;
+        if (next_chunk < MAX_CHUNK) next_chunk <<= 1;
+        ++chunk_cnt;
+    }
+
+public:
+    /**
+     * first_chunk is the number of blocks in the first chunk
+     */
+    explicit node_pool(size_t first_chunk = 64) : next_chunk(first_chunk < 2 ? 2 : first_chunk) {}
+    node_pool(const node_pool &) = delete;
+    node_pool &operator=(const node_pool &) = delete;
+    ~node_pool() { release(); }
+
+    void *allocate() {
+        if (free_list) {
+            block *b = free_list;
+            free_list = b->next;
+            return b;
+        }
+        if (cursor == limit) grow();
+        return cursor++;
+    }
+    void deallocate(void *p) {
+        block *b = static_cast<block *>(p);
+        b->next = free_list;
+        free_list = b;
+    }
+    /**
+     * give back a whole chain of blocks in O(1).
+     * the blocks must already be linked from first to last through their first word.
+     */
+    void deallocate_chain(void *first, void *last) {
+        static_cast<block *>(last)->next = free_list;
+        free_list = static_cast<block *>(first);
+    }
+    /**
+     * return every chunk to the system at once.
+     * no block handed out by this pool may be used afterwards.
+     */
+    void release() {
+        while (chunks) {
+            block *nxt = chunks->next;
+            delete [] chunks;
+            chunks = nxt;
+        }
+        free_list = cursor = limit = nullptr;
+        chunk_cnt = 0;
+    }
+    size_t chunk_count() const { return chunk_cnt; }
+};
+
+}
+
+#endif //SJTU_POOL_HPP
@@ -0,0 +1,235 @@
+#ifndef SJTU_SERIALIZE_HPP
+#define SJTU_SERIALIZE_HPP
+
+#include "list.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(SJTU_LIST_UNROLLED) || defined(SJTU_LIST_INDEXED) || defined(SJTU_LIST_COMPACT)
+#error "the binary format builds the node chain of sjtu::list, which SJTU_LIST_UNROLLED, SJTU_LIST_INDEXED and SJTU_LIST_COMPACT replace"
+#endif
+
+/**
+ * load_file() maps the file where POSIX mmap is available and reads it through a stream elsewhere
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SJTU_LIST_MMAP
+#endif
+
+namespace sjtu {
+/**
+ * the binary form of a list, the same for a stream and a file:
+ * this header, then the count elements.
+ * a trivially copyable T that has no codec is written as its bytes, one contiguous array
+ * right behind the header, which load_file() copies into a node chain in one pass.
+ * any other T provides the codec by argument-dependent lookup:
+ *     void save_binary(std::ostream &, const T &);
+ *     void load_binary(std::istream &, T &);  // into a default-constructed T, failing the stream on bad input
+ * and every element is written by save_binary, one after the other.
+ * the format is that of the machine that wrote it: a file from a machine
+ * of another byte order, or a T of another size, is refused.
+ */
+struct list_file_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t element_size; // sizeof(T) for raw elements, 0 for elements written by save_binary
+    uint32_t byte_order; // list_file_byte_order as the writer stored it
+    uint64_t count;
+    uint64_t reserved;
+};
+static_assert(sizeof(list_file_header) == 32, "list_file_header must have no padding");
+static constexpr char list_file_magic[4] = {'S', 'J', 'T', 'L'};
+static constexpr uint32_t list_file_version = 1;
+static constexpr uint32_t list_file_byte_order = 0x01020304;
+
+namespace serial_detail {
+
+template<typename T, typename = void>
+struct has_codec : std::false_type {};
+template<typename T>
+struct has_codec<T, std::void_t<
+        decltype(save_binary(std::declval<std::ostream &>(), std::declval<const T &>())),
+        decltype(load_binary(std::declval<std::istream &>(), std::declval<T &>()))>> : std::true_type {};
+
+}
+
+/**
+ * list::save(), load(), save_file() and load_file(): the friend of list that
+ * builds the node chain straight from the bytes read
+ */
+template<typename T>
+class list_io {
+    typedef typename list<T>::node node;
+    typedef typename list<T>::run run;
+
+    static constexpr bool raw = !serial_detail::has_codec<T>::value;
+    static_assert(!raw || std::is_trivially_copyable<T>::value,
+                  "a T that is not trivially copyable needs save_binary and load_binary");
+    // elements moved between a stream and the chain at once
+    static constexpr size_t chunk = sizeof(T) >= 65536 ? 1 : 65536 / sizeof(T);
+
+    static list_file_header header(size_t count) {
+        list_file_header h;
+        memcpy(h.magic, list_file_magic, sizeof(h.magic));
+        h.version = list_file_version;
+        h.element_size = raw ? sizeof(T) : 0;
+        h.byte_order = list_file_byte_order;
+        h.count = count;
+        h.reserved = 0;
+        return h;
+    }
+    /**
+     * throw runtime_error unless h describes a list of T written by this format
+     */
+    static void check(const list_file_header &h) {
+        if (memcmp(h.magic, list_file_magic, sizeof(h.magic)) != 0 || h.version != list_file_version ||
+            h.element_size != (raw ? sizeof(T) : 0) || h.byte_order != list_file_byte_order)
+            throw runtime_error(__func__);
+    }
+    /**
+     * append nodes holding the n raw elements at bytes to the detached chain c,
+     * each a copy of the bytes: no element is parsed or constructed
+     */
+    static void push_raw(list<T> &l, run &c, const char *bytes, size_t n) {
+        for (size_t i = 0; i < n; ++i, bytes += sizeof(T)) {
+            node *cur = l.get_node();
+            memcpy(static_cast<void *>(cur->val()), bytes, sizeof(T));
+            list<T>::chain_push(c, cur);
+        }
+    }
+    /**
+     * replace the elements of l by the detached chain of n nodes, which cannot throw
+     */
+    static void replace(list<T> &l, run c, size_t n) {
+        l.clear();
+        l.link_chain(l.head, c, n);
+    }
+
+public:
+    static void save(const list<T> &l, std::ostream &os) {
+        list_file_header h = header(l.sz);
+        os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        if constexpr (raw) {
+            std::vector<char> buf(std::min(l.sz, chunk) * sizeof(T));
+            size_t k = 0;
+            for (node *cur = l.fwd(l.head); cur != l.head; cur = l.fwd(cur)) {
+                memcpy(buf.data() + k * sizeof(T), static_cast<const void *>(cur->val()), sizeof(T));
+                if (++k == chunk) os.write(buf.data(), k * sizeof(T)), k = 0;
+            }
+            if (k) os.write(buf.data(), k * sizeof(T));
+        } else {
+            for (node *cur = l.fwd(l.head); cur != l.head; cur = l.fwd(cur)) save_binary(os, *(cur->val()));
+        }
+        if (!os) throw runtime_error(__func__);
+    }
+    static void load(list<T> &l, std::istream &is) {
+        list_file_header h;
+        if (!is.read(reinterpret_cast<char *>(&h), sizeof(h))) throw runtime_error(__func__);
+        check(h);
+        if (!l.head) l.init();
+        run c;
+        size_t n = 0;
+        try {
+            if constexpr (raw) {
+                std::vector<char> buf((size_t)std::min<uint64_t>(h.count, chunk) * sizeof(T));
+                while (n < h.count) {
+                    size_t k = (size_t)std::min<uint64_t>(h.count - n, chunk);
+                    if (!is.read(buf.data(), k * sizeof(T))) throw runtime_error(__func__);
+                    push_raw(l, c, buf.data(), k);
+                    n += k;
+                }
+            } else {
+                for (; n < h.count; ++n) {
+                    list<T>::chain_push(c, l.new_node());
+                    load_binary(is, *(c.last->val()));
+                    if (!is) throw runtime_error(__func__);
+                }
+            }
+        } catch (...) {
+            l.release_chain(c.first);
+            throw;
+        }
+        replace(l, c, n);
+    }
+    static void save_file(const list<T> &l, const char *path) {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os) throw runtime_error(__func__);
+        save(l, os);
+        os.close();
+        if (!os) throw runtime_error(__func__);
+    }
+    static void load_file(list<T> &l, const char *path) {
+#ifdef SJTU_LIST_MMAP
+        if constexpr (raw) {
+            load_mapped(l, path);
+            return;
+        }
+#endif
+        std::ifstream is(path, std::ios::binary);
+        if (!is) throw runtime_error(__func__);
+        load(l, is);
+    }
+
+private:
+#ifdef SJTU_LIST_MMAP
+    /**
+     * a read-only private mapping of a whole file, released with the object
+     */
+    struct mapping {
+        int fd = -1;
+        void *addr = MAP_FAILED;
+        size_t size = 0;
+        ~mapping() {
+            if (addr != MAP_FAILED) munmap(addr, size);
+            if (fd >= 0) ::close(fd);
+        }
+    };
+    /**
+     * map the file and copy its element array into a node chain in one sequential pass
+     */
+    static void load_mapped(list<T> &l, const char *path) {
+        mapping m;
+        struct stat st;
+        m.fd = ::open(path, O_RDONLY);
+        if (m.fd < 0 || fstat(m.fd, &st) != 0 || (size_t)st.st_size < sizeof(list_file_header))
+            throw runtime_error(__func__);
+        m.size = (size_t)st.st_size;
+        m.addr = mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, m.fd, 0);
+        if (m.addr == MAP_FAILED) throw runtime_error(__func__);
+        madvise(m.addr, m.size, MADV_SEQUENTIAL);
+        const char *bytes = static_cast<const char *>(m.addr);
+        list_file_header h;
+        memcpy(&h, bytes, sizeof(h));
+        check(h);
+        if (h.count > (m.size - sizeof(h)) / sizeof(T)) throw runtime_error(__func__);
+        if (!l.head) l.init();
+        run c;
+        try {
+            push_raw(l, c, bytes + sizeof(h), (size_t)h.count);
+        } catch (...) {
+            l.release_chain(c.first);
+            throw;
+        }
+        replace(l, c, (size_t)h.count);
+    }
+#endif
+};
+
+}
+
+#undef SJTU_LIST_MMAP
+
+#endif //SJTU_SERIALIZE_HPP
@@ -0,0 +1,88 @@
+#ifndef SJTU_STATS_HPP
+#define SJTU_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+namespace sjtu {
+/**
+ * what a list has done since it was built or its stats were reset.
+ * a list only counts when SJTU_LIST_STATS is defined; otherwise it keeps no counters,
+ * its stats() are all zero and every hook compiles to nothing.
+ */
+struct list_stats {
+#ifdef SJTU_LIST_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    /**
+     * the bulk operations that are timed
+     */
+    enum operation {
+        copy, assign, clear, insert, splice, sort, parallel_sort, merge, reverse, unique, remove,
+        operation_count
+    };
+    static const char *name(operation op) {
+        static const char *const names[operation_count] = {
+            "copy", "assign", "clear", "insert", "splice", "sort", "parallel_sort", "merge",
+            "reverse", "unique", "remove"
+        };
+        return names[op];
+    }
+
+    size_t allocations = 0, frees = 0; // nodes, the sentinel included
+    size_t peak_size = 0;
+    size_t steps = 0; // ++ and -- on iterators, internal walks not included
+    size_t comparisons = 0; // calls of the comparator or predicate of sort, merge and unique (not parallel_sort)
+    size_t calls[operation_count] = {};
+    double ms[operation_count] = {}; // wall time spent in each operation
+
+    /**
+     * called, if set, after every timed operation of any list with that list's stats,
+     * e.g. to log the lists that are hot; it must not throw
+     */
+    static inline void (*observer)(const list_stats &, operation, double ms) = nullptr;
+
+    void grown(size_t size) {
+        if (size > peak_size) peak_size = size;
+    }
+
+    /**
+     * times one operation from its construction to its destruction
+     */
+    class scope {
+        list_stats &stats;
+        operation op;
+        std::chrono::steady_clock::time_point begin;
+    public:
+        scope(list_stats &stats, operation op) : stats(stats), op(op), begin(std::chrono::steady_clock::now()) {}
+        scope(const scope &) = delete;
+        scope &operator=(const scope &) = delete;
+        ~scope() {
+            double spent = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            ++stats.calls[op];
+            stats.ms[op] += spent;
+            if (observer) observer(stats, op, spent);
+        }
+    };
+
+    /**
+     * a comparator or predicate that counts its calls into comparisons
+     */
+    template<typename F>
+    struct counted {
+        F &f;
+        size_t &count;
+        template<typename... Args>
+        decltype(auto) operator()(Args &&... args) {
+            ++count;
+            return f(std::forward<Args>(args)...);
+        }
+    };
+};
+
+}
+
+#endif //SJTU_STATS_HPP
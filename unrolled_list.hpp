@@ -0,0 +1,1044 @@
+#ifndef SJTU_UNROLLED_LIST_HPP
+#define SJTU_UNROLLED_LIST_HPP
+
+#include "exceptions.hpp"
+#include "algorithm.hpp"
+#include "pool.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * same iterator checking policy as list.hpp: define SJTU_LIST_UNCHECKED to drop the checks
+ */
+#ifdef SJTU_LIST_UNCHECKED
+#define SJTU_UNROLLED_CHECK(cond) ((void)0)
+#else
+#define SJTU_UNROLLED_CHECK(cond) do { if (cond) throw invalid_iterator(__func__); } while (0)
+#endif
+
+namespace sjtu {
+/**
+ * a data container with the interface of sjtu::list whose nodes are chunks of up to
+ * ChunkSize elements stored side by side, so a traversal misses the cache once per chunk
+ * rather than once per element. The elements of a chunk fill a window of its slots with
+ * free slots on either side: values are added at both ends of a window without moving
+ * anything, a value inserted inside a window pushes the elements before it towards the
+ * front, into a chunk of their own when there is no room there, and a chunk is merged with
+ * a neighbour once the two hold no more than half a chunk. No chunk is ever empty.
+ *
+ * iterator stability: an iterator names a chunk and a slot in it.
+ * - end() stays valid whatever is done to the list.
+ * - insert and emplace never move the element at pos or any element behind it;
+ *   they may move the elements before pos in the chunk of pos.
+ * - push_back, push_front and the emplace_ forms never move an element.
+ * - erase moves the elements on the shorter side of pos in its chunk, and when that chunk
+ *   is merged with a neighbour, the elements of one of the two: iterators to the elements of
+ *   any other chunk stay valid.
+ * - splice moves the elements before pos in its chunk and before first and last in theirs.
+ * - sort, parallel_sort, merge, reverse, unique, remove and remove_if may move any element.
+ * an element is moved with its move constructor; T must be move constructible, and the list
+ * is only exception safe if that constructor does not throw.
+ */
+template<typename T, size_t ChunkSize = (sizeof(T) < 64 ? 512 / sizeof(T) : 8)>
+class unrolled_list {
+    static_assert(ChunkSize >= 2, "a chunk must hold at least two elements");
+protected:
+    /**
+     * the links and the window [lo, hi) of used slots of a chunk.
+     * the sentinel head is a bare link inside the list with an empty window at 0,
+     * so that stepping onto it gives the end() position.
+     * next comes first so that a chain of chunks is also a free list of arena_type.
+     */
+    struct link {
+        link *next, *prev;
+        size_t lo, hi;
+        link(): next(this), prev(this), lo(0), hi(0) {}
+    };
+    class chunk : public link {
+    public:
+        // user-provided, so that new chunk() leaves the storage uninitialized instead of zeroing it
+        chunk() {}
+        T *val(size_t i) { return reinterpret_cast<T *>(storage) + i; }
+        const T *val(size_t i) const { return reinterpret_cast<const T *>(storage) + i; }
+        size_t count() const { return this->hi - this->lo; }
+    private:
+        alignas(T) unsigned char storage[ChunkSize * sizeof(T)];
+    };
+
+public:
+    /**
+     * a slab of chunks that several lists may share.
+     * elements can only be spliced or merged between lists drawing from the same arena.
+     */
+    typedef node_pool<sizeof(chunk), alignof(chunk)> arena_type;
+
+protected:
+    // an insertion inside a window shifts at most this many elements in place
+    static constexpr size_t shift_limit = ChunkSize / 8;
+
+    link head;
+    size_t sz = 0;
+    arena_type *pool = nullptr; // nullptr: chunks come from the global heap
+
+    static chunk *as_chunk(link *l) { return static_cast<chunk *>(l); }
+    static const chunk *as_chunk(const link *l) { return static_cast<const chunk *>(l); }
+
+    /**
+     * allocate / release a chunk without touching its elements
+     */
+    chunk *get_chunk() { return pool ? new (pool->allocate()) chunk() : new chunk(); }
+    void put_chunk(chunk *c) {
+        if (pool) pool->deallocate(c);
+        else delete c;
+    }
+    static void link_before(link *pos, link *c) {
+        c->prev = pos->prev;
+        c->next = pos;
+        pos->prev->next = c;
+        pos->prev = c;
+    }
+    /**
+     * unlink a chunk whose elements are gone and release it
+     */
+    void drop(chunk *c) {
+        c->prev->next = c->next;
+        c->next->prev = c->prev;
+        put_chunk(c);
+    }
+    /**
+     * destroy the elements of a chunk, which stays linked
+     */
+    static void destroy(chunk *c) {
+        for (size_t k = c->lo; k < c->hi; ++k) c->val(k)->~T();
+        c->lo = c->hi = 0;
+    }
+    /**
+     * move the element at from to the raw slot to, leaving from raw
+     */
+    static void relocate(T *from, T *to) {
+        new (to) T(std::move(*from));
+        from->~T();
+    }
+    /**
+     * move the elements [lo, s) of l into a new chunk linked before l, so that l starts at
+     * slot s; the moved elements keep their distance from lo in the new chunk.
+     * return l
+     */
+    link *cut(link *l, size_t s) {
+        if (s == l->lo) return l;
+        chunk *c = as_chunk(l), *n = get_chunk();
+        for (size_t k = c->lo; k < s; ++k) relocate(c->val(k), n->val(k - c->lo));
+        n->hi = s - c->lo;
+        c->lo = s;
+        link_before(c, n);
+        return l;
+    }
+    /**
+     * where the element that sat at slot i of l is after cut(l, s)
+     */
+    static void follow_cut(link *&p, size_t &i, link *l, size_t lo, size_t s) {
+        if (p == l && i < s) p = l->prev, i -= lo;
+    }
+    /**
+     * move every element of b to the back of a and release b
+     */
+    void absorb(chunk *a, chunk *b) {
+        if (a->hi + b->count() > ChunkSize) {
+            for (size_t k = a->lo; k < a->hi; ++k) relocate(a->val(k), a->val(k - a->lo));
+            a->hi -= a->lo;
+            a->lo = 0;
+        }
+        for (size_t k = b->lo; k < b->hi; ++k) relocate(b->val(k), a->val(a->hi++));
+        b->lo = b->hi = 0;
+        drop(b);
+    }
+    /**
+     * after an erasure from c, release c if it is empty or merge it with a neighbour if the
+     * two fit in half a chunk; k is the offset of the element that followed the erased one
+     * from the front of c. return that element's position in l and i.
+     */
+    void rebalance(chunk *c, size_t k, link *&l, size_t &i) {
+        if (c->count() == 0) {
+            l = c->next, i = l->lo;
+            drop(c);
+            return;
+        }
+        if (c->next != &head && c->count() + as_chunk(c->next)->count() <= ChunkSize / 2) {
+            absorb(c, as_chunk(c->next));
+        } else if (c->prev != &head && as_chunk(c->prev)->count() + c->count() <= ChunkSize / 2) {
+            chunk *p = as_chunk(c->prev);
+            k += p->count();
+            absorb(p, c);
+            c = p;
+        }
+        if (k == c->count()) l = c->next, i = l->lo;
+        else l = c, i = c->lo + k;
+    }
+    /**
+     * merge neighbouring chunks as long as they fit in one, after a pass that removed elements
+     */
+    void coalesce() {
+        for (link *l = head.next; l != &head && l->next != &head; ) {
+            if (as_chunk(l)->count() + as_chunk(l->next)->count() <= ChunkSize) absorb(as_chunk(l), as_chunk(l->next));
+            else l = l->next;
+        }
+    }
+
+    /**
+     * the default ordering, operator< of T
+     */
+    struct less {
+        bool operator()(const T &a, const T &b) const { return a < b; }
+    };
+    /**
+     * the default equivalence, operator== of T
+     */
+    struct equal_to {
+        bool operator()(const T &a, const T &b) const { return a == b; }
+    };
+    /**
+     * a detached chain of chunks filled from slot 0, all full but the last
+     */
+    struct run {
+        chunk *first = nullptr, *last = nullptr;
+    };
+    /**
+     * the next free slot at the back of a detached chain; the caller counts it in once it is constructed
+     */
+    T *chain_slot(run &c) {
+        if (!c.last || c.last->hi == ChunkSize) {
+            chunk *n = get_chunk();
+            if (c.first) {
+                c.last->next = n;
+                n->prev = c.last;
+            } else {
+                c.first = n;
+            }
+            c.last = n;
+        }
+        return c.last->val(c.last->hi);
+    }
+    /**
+     * destroy the elements of a detached chain and release its chunks
+     */
+    void release_chain(run c) {
+        for (chunk *cur = c.first; cur; ) {
+            chunk *nxt = cur == c.last ? nullptr : as_chunk(cur->next);
+            destroy(cur);
+            put_chunk(cur);
+            cur = nxt;
+        }
+    }
+    /**
+     * build a detached chain holding copies of [first, last) in one pass, n receives its length
+     * if a copy throws, the chain built so far is released
+     */
+    template<typename InputIt>
+    run build_chain(InputIt first, InputIt last, size_t &n) {
+        run c;
+        n = 0;
+        try {
+            for (; first != last; ++first, ++n) {
+                new (chain_slot(c)) T(*first);
+                ++c.last->hi;
+            }
+        } catch (...) {
+            release_chain(c);
+            throw;
+        }
+        return c;
+    }
+    /**
+     * build a detached chain of n copies of value
+     */
+    run build_chain(size_t n, const T &value) {
+        run c;
+        try {
+            for (size_t i = 0; i < n; ++i) {
+                new (chain_slot(c)) T(value);
+                ++c.last->hi;
+            }
+        } catch (...) {
+            release_chain(c);
+            throw;
+        }
+        return c;
+    }
+    /**
+     * link a detached chain of n elements before slot s of l, cutting l there
+     * return the chunk of the first linked element, or l if the chain is empty
+     */
+    link *link_chain(link *l, size_t s, run c, size_t n) {
+        if (!n) return l;
+        link *pos = cut(l, s);
+        c.first->prev = pos->prev;
+        c.last->next = pos;
+        pos->prev->next = c.first;
+        pos->prev = c.last;
+        sz += n;
+        return c.first;
+    }
+    /**
+     * destroy the elements from slot s of l to the back of the list
+     */
+    void erase_tail(link *l, size_t s) {
+        if (l == &head) return;
+        chunk *c = as_chunk(l);
+        for (size_t k = s; k < c->hi; ++k) c->val(k)->~T();
+        sz -= c->hi - s;
+        c->hi = s;
+        link *cur = c->next;
+        if (c->count() == 0) drop(c);
+        while (cur != &head) {
+            c = as_chunk(cur);
+            cur = cur->next;
+            sz -= c->count();
+            destroy(c);
+            drop(c);
+        }
+    }
+    /**
+     * hand the chunks of from over to to, whose own chunks are forgotten
+     */
+    static void move_chain(link &to, link &from) {
+        if (from.next == &from) {
+            to.next = to.prev = &to;
+            return;
+        }
+        to.next = from.next, to.prev = from.prev;
+        to.next->prev = to.prev->next = &to;
+        from.next = from.prev = &from;
+    }
+    /**
+     * fill an empty list from a detached chain
+     */
+    template<typename... Args>
+    void init_from(Args &&... args) {
+        size_t n;
+        run c = make_chain(n, std::forward<Args>(args)...);
+        link_chain(&head, 0, c, n);
+    }
+    template<typename InputIt>
+    run make_chain(size_t &n, InputIt first, InputIt last) { return build_chain(first, last, n); }
+    run make_chain(size_t &n, size_t count, const T &value) { n = count; return build_chain(count, value); }
+    /**
+     * read-only walk over the values of a list, so that copying between lists skips the checked iterators
+     */
+    struct value_walker {
+        const link *l;
+        size_t i;
+        explicit value_walker(const link *l) : l(l), i(l->lo) {}
+        const T & operator*() const { return *as_chunk(l)->val(i); }
+        value_walker & operator++() {
+            if (++i == l->hi) l = l->next, i = l->lo;
+            return *this;
+        }
+        bool operator!=(const value_walker &rhs) const { return l != rhs.l || i != rhs.i; }
+    };
+    /**
+     * assign [first, last) over the existing elements in place,
+     * then append the rest of the range or destroy the extra elements
+     */
+    template<typename InputIt>
+    void assign_range(InputIt first, InputIt last) {
+        link *l = head.next;
+        size_t i = l->lo;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; l != &head && first != last; ++first) {
+                *as_chunk(l)->val(i) = *first;
+                if (++i == l->hi) l = l->next, i = l->lo;
+            }
+        }
+        erase_tail(l, i);
+        size_t n;
+        run c = build_chain(first, last, n);
+        link_chain(&head, 0, c, n);
+    }
+    /**
+     * InputIt is accepted as an iterator only if it is not an integer,
+     * so that unrolled_list(5, 3) still means five threes
+     */
+    template<typename InputIt>
+    using if_iterator = typename std::enable_if<!std::is_integral<InputIt>::value>::type;
+
+    /**
+     * remove, in one pass over every chunk, the elements x for which drop_if(kept, x) holds,
+     * kept being the last element kept so far or nullptr; kept elements slide to the front of their window.
+     * return the number of removed elements. if drop_if throws, the elements not tested yet are all kept.
+     */
+    template<typename Drop>
+    size_t sweep(Drop drop_if) {
+        size_t removed = 0;
+        const T *kept = nullptr;
+        for (link *l = head.next; l != &head; ) {
+            chunk *c = as_chunk(l);
+            size_t w = c->lo, r = c->lo;
+            try {
+                for (; r < c->hi; ++r) {
+                    if (drop_if(kept, *c->val(r))) {
+                        c->val(r)->~T();
+                        ++removed;
+                        continue;
+                    }
+                    if (w != r) relocate(c->val(r), c->val(w));
+                    kept = c->val(w++);
+                }
+            } catch (...) {
+                for (; r < c->hi; ++r, ++w)
+                    if (w != r) relocate(c->val(r), c->val(w));
+                c->hi = w;
+                sz -= removed;
+                if (c->count() == 0) drop(c);
+                coalesce();
+                throw;
+            }
+            c->hi = w;
+            l = l->next;
+            if (c->count() == 0) drop(c);
+        }
+        sz -= removed;
+        coalesce();
+        return removed;
+    }
+    /**
+     * move the elements, in the order of the pointers in a, into fresh full chunks that replace the current ones
+     */
+    void rebuild(T **a) {
+        run c;
+        size_t chunks = (sz + ChunkSize - 1) / ChunkSize;
+        try {
+            for (size_t k = 0; k < chunks; ++k) {
+                chain_slot(c);
+                c.last->hi = ChunkSize;
+            }
+        } catch (...) {
+            for (chunk *cur = c.first; cur; cur = cur == c.last ? nullptr : as_chunk(cur->next)) cur->hi = 0;
+            release_chain(c);
+            throw;
+        }
+        chunk *out = c.first;
+        for (size_t k = 0; k < sz; ++k) {
+            if (k && k % ChunkSize == 0) out = as_chunk(out->next);
+            relocate(a[k], out->val(k % ChunkSize));
+        }
+        out->hi = sz - (chunks - 1) * ChunkSize;
+        for (link *cur = head.next; cur != &head; ) {
+            link *nxt = cur->next;
+            put_chunk(as_chunk(cur));
+            cur = nxt;
+        }
+        head.next = head.prev = &head;
+        size_t n = sz;
+        sz = 0;
+        link_chain(&head, 0, c, n);
+    }
+    /**
+     * stable sort: the addresses of the elements are sorted with policy, then the elements
+     * are moved into place in one pass. if cmp throws, the list is left as it was.
+     */
+    template<typename Compare>
+    void sort_by_address(Compare &cmp, const parallel_policy &policy) {
+        if (sz <= 1) return;
+        T **a = new T*[sz];
+        size_t idx = 0;
+        for (link *l = head.next; l != &head; l = l->next)
+            for (size_t k = l->lo; k < l->hi; ++k) a[idx++] = as_chunk(l)->val(k);
+        try {
+            sjtu::parallel_stable_sort(a, a + sz, [&cmp](const T *x, const T *y) { return cmp(*x, *y); }, policy);
+            rebuild(a);
+        } catch (...) {
+            delete [] a;
+            throw;
+        }
+        delete [] a;
+    }
+
+public:
+    class const_iterator;
+    class iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        unrolled_list *owner = nullptr;
+#endif
+        link *ptr = nullptr;
+        size_t idx = 0;
+        friend class const_iterator;
+        friend class unrolled_list;
+    public:
+        iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        iterator(unrolled_list *o, link *p, size_t i) : owner(o), ptr(p), idx(i) {}
+#else
+        iterator(unrolled_list *, link *p, size_t i) : ptr(p), idx(i) {}
+#endif
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        iterator & operator++() {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || ptr == &owner->head);
+            if (++idx == ptr->hi) ptr = ptr->next, idx = ptr->lo;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        iterator & operator--() {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || (idx == ptr->lo && ptr->prev == &owner->head));
+            if (idx == ptr->lo) ptr = ptr->prev, idx = ptr->hi;
+            --idx;
+            return *this;
+        }
+        /**
+         * throw invalid_iterator for end() or an iterator of no list
+         */
+        T & operator *() const {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || ptr == &owner->head);
+            return *as_chunk(ptr)->val(idx);
+        }
+        T * operator ->() const {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || ptr == &owner->head);
+            return as_chunk(ptr)->val(idx);
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr && idx == rhs.idx; }
+#else
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr && idx == rhs.idx; }
+#endif
+        bool operator==(const const_iterator &rhs) const { return rhs == *this; }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator &rhs) const { return !(rhs == *this); }
+    };
+    /**
+     * has same function as iterator, just for a const object.
+     */
+    class const_iterator {
+    private:
+#ifndef SJTU_LIST_UNCHECKED
+        const unrolled_list *owner = nullptr;
+#endif
+        const link *ptr = nullptr;
+        size_t idx = 0;
+        friend class iterator;
+        friend class unrolled_list;
+    public:
+        const_iterator() = default;
+#ifndef SJTU_LIST_UNCHECKED
+        const_iterator(const unrolled_list *o, const link *p, size_t i) : owner(o), ptr(p), idx(i) {}
+        const_iterator(const iterator &it) : owner(it.owner), ptr(it.ptr), idx(it.idx) {}
+#else
+        const_iterator(const unrolled_list *, const link *p, size_t i) : ptr(p), idx(i) {}
+        const_iterator(const iterator &it) : ptr(it.ptr), idx(it.idx) {}
+#endif
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        const_iterator & operator++() {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || ptr == &owner->head);
+            if (++idx == ptr->hi) ptr = ptr->next, idx = ptr->lo;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+        const_iterator & operator--() {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || (idx == ptr->lo && ptr->prev == &owner->head));
+            if (idx == ptr->lo) ptr = ptr->prev, idx = ptr->hi;
+            --idx;
+            return *this;
+        }
+        const T & operator *() const {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || ptr == &owner->head);
+            return *as_chunk(ptr)->val(idx);
+        }
+        const T * operator ->() const {
+            SJTU_UNROLLED_CHECK(!owner || !ptr || ptr == &owner->head);
+            return as_chunk(ptr)->val(idx);
+        }
+#ifndef SJTU_LIST_UNCHECKED
+        bool operator==(const const_iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr && idx == rhs.idx; }
+        bool operator==(const iterator &rhs) const { return owner == rhs.owner && ptr == rhs.ptr && idx == rhs.idx; }
+#else
+        bool operator==(const const_iterator &rhs) const { return ptr == rhs.ptr && idx == rhs.idx; }
+        bool operator==(const iterator &rhs) const { return ptr == rhs.ptr && idx == rhs.idx; }
+#endif
+        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+    };
+
+    unrolled_list() {}
+    /**
+     * a list whose chunks are drawn from arena.
+     * the arena must outlive the list.
+     */
+    explicit unrolled_list(arena_type &arena) : pool(&arena) {}
+    /**
+     * the copy shares the arena of other, its chunks are filled up
+     */
+    unrolled_list(const unrolled_list &other) : pool(other.pool) {
+        init_from(value_walker(other.head.next), value_walker(&other.head));
+    }
+    /**
+     * n copies of value
+     */
+    unrolled_list(size_t n, const T &value) { init_from(n, value); }
+    /**
+     * copies of the elements in [first, last)
+     */
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    unrolled_list(InputIt first, InputIt last) { init_from(first, last); }
+    unrolled_list(std::initializer_list<T> values) { init_from(values.begin(), values.end()); }
+    /**
+     * take over the chunks of other, no element is touched; other is left empty
+     */
+    unrolled_list(unrolled_list &&other) noexcept : sz(other.sz), pool(other.pool) {
+        move_chain(head, other.head);
+        other.sz = 0;
+    }
+    ~unrolled_list() { clear(); }
+    unrolled_list &operator=(const unrolled_list &other) {
+        if (this == &other) return *this;
+        assign_range(value_walker(other.head.next), value_walker(&other.head));
+        return *this;
+    }
+    /**
+     * exchange chunks with other, which takes over the old elements of *this
+     */
+    unrolled_list &operator=(unrolled_list &&other) noexcept {
+        if (this == &other) return *this;
+        link mine;
+        move_chain(mine, head);
+        move_chain(head, other.head);
+        move_chain(other.head, mine);
+        std::swap(sz, other.sz);
+        std::swap(pool, other.pool);
+        return *this;
+    }
+    unrolled_list &operator=(std::initializer_list<T> values) {
+        assign_range(values.begin(), values.end());
+        return *this;
+    }
+    /**
+     * replace the contents, existing elements are assigned over
+     */
+    void assign(size_t n, const T &value) {
+        link *l = head.next;
+        size_t i = l->lo;
+        if constexpr (std::is_copy_assignable<T>::value) {
+            for (; l != &head && n; --n) {
+                *as_chunk(l)->val(i) = value;
+                if (++i == l->hi) l = l->next, i = l->lo;
+            }
+        }
+        erase_tail(l, i);
+        link_chain(&head, 0, build_chain(n, value), n);
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    void assign(InputIt first, InputIt last) { assign_range(first, last); }
+    void assign(std::initializer_list<T> values) { assign_range(values.begin(), values.end()); }
+    /**
+     * access the first / last element
+     * throw container_is_empty when the container is empty.
+     */
+    const T & front() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return *as_chunk(head.next)->val(head.next->lo);
+    }
+    const T & back() const {
+        if (sz == 0) throw container_is_empty(__func__);
+        return *as_chunk(head.prev)->val(head.prev->hi - 1);
+    }
+    iterator begin() { return iterator(this, head.next, head.next->lo); }
+    const_iterator cbegin() const { return const_iterator(this, head.next, head.next->lo); }
+    iterator end() { return iterator(this, &head, 0); }
+    const_iterator cend() const { return const_iterator(this, &head, 0); }
+    bool empty() const { return sz == 0; }
+    size_t size() const { return sz; }
+    /**
+     * the arena the chunks are drawn from, nullptr for the global heap
+     */
+    arena_type *arena() const { return pool; }
+
+    void clear() { erase_tail(head.next, head.next->lo); }
+    /**
+     * insert value before pos (pos may be the end() iterator)
+     * return an iterator pointing to the inserted value
+     * throw if the iterator is invalid
+     */
+    iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+    iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+    /**
+     * insert n copies of value before pos
+     * the copies are built into chunks of their own, which are linked in at once
+     * return an iterator to the first inserted element, or pos if n is 0
+     */
+    iterator insert(iterator pos, size_t n, const T &value) {
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        run c = build_chain(n, value);
+        if (!n) return pos;
+        return iterator(this, link_chain(pos.ptr, pos.idx, c, n), 0);
+    }
+    template<typename InputIt, typename = if_iterator<InputIt>>
+    iterator insert(iterator pos, InputIt first, InputIt last) {
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        size_t n;
+        run c = build_chain(first, last, n);
+        if (!n) return pos;
+        return iterator(this, link_chain(pos.ptr, pos.idx, c, n), 0);
+    }
+    iterator insert(iterator pos, std::initializer_list<T> values) {
+        return insert(pos, values.begin(), values.end());
+    }
+    /**
+     * construct a value from args before pos, return an iterator pointing to it.
+     * at the front of a window the value is built in a free slot next to it: behind the
+     * previous chunk, in front of this one, or in a new chunk; inside a window a few elements
+     * before pos are shifted one slot to the front, the value being built aside first since
+     * args may refer to one of them, while more are moved behind the previous chunk or into
+     * a new one, after the value has been built behind where they will go.
+     * throw if the iterator is invalid
+     */
+    template<typename... Args>
+    iterator emplace(iterator pos, Args &&... args) {
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        link *l = pos.ptr;
+        size_t s = pos.idx;
+        if (s == l->lo) {
+            link *p = l->prev;
+            if (p != &head && p->hi < ChunkSize) {
+                new (as_chunk(p)->val(p->hi)) T(std::forward<Args>(args)...);
+                ++sz;
+                return iterator(this, p, p->hi++);
+            }
+            if (l != &head && l->lo > 0) {
+                new (as_chunk(l)->val(l->lo - 1)) T(std::forward<Args>(args)...);
+                ++sz;
+                return iterator(this, l, --l->lo);
+            }
+            // a chunk opened at the front of the list grows towards the front
+            chunk *n = get_chunk();
+            size_t at = p == &head && l != &head ? ChunkSize - 1 : 0;
+            try {
+                new (n->val(at)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                put_chunk(n);
+                throw;
+            }
+            n->lo = at, n->hi = at + 1;
+            link_before(l, n);
+            ++sz;
+            return iterator(this, n, at);
+        }
+        chunk *c = as_chunk(l);
+        size_t m = s - c->lo;
+        if (c->lo > 0 && m <= shift_limit) {
+            T value(std::forward<Args>(args)...);
+            for (size_t k = c->lo; k < s; ++k) relocate(c->val(k), c->val(k - 1));
+            --c->lo;
+            new (c->val(s - 1)) T(std::move(value));
+            ++sz;
+            return iterator(this, c, s - 1);
+        }
+        // a long prefix goes behind the previous chunk if it fits, so that the next insertions
+        // around pos find the front of the window close by
+        link *p = c->prev;
+        chunk *n = p != &head && p->hi + m < ChunkSize ? as_chunk(p) : get_chunk();
+        size_t at = n->hi;
+        try {
+            new (n->val(at + m)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            if (n != p) put_chunk(n);
+            throw;
+        }
+        for (size_t k = 0; k < m; ++k) relocate(c->val(c->lo + k), n->val(at + k));
+        n->hi = at + m + 1;
+        c->lo = s;
+        if (n != p) link_before(c, n);
+        ++sz;
+        return iterator(this, n, at + m);
+    }
+    /**
+     * remove the element at pos (the end() iterator is invalid)
+     * returns an iterator pointing to the following element, if pos pointing to the last element, end() will be returned.
+     * throw if the container is empty, the iterator is invalid
+     */
+    iterator erase(iterator pos) {
+        if (sz == 0) throw container_is_empty(__func__);
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr || pos.ptr == &head);
+        chunk *c = as_chunk(pos.ptr);
+        size_t s = pos.idx, k = s - c->lo;
+        c->val(s)->~T();
+        if (k < c->hi - 1 - s) {
+            for (size_t j = s; j > c->lo; --j) relocate(c->val(j - 1), c->val(j));
+            ++c->lo;
+        } else {
+            for (size_t j = s + 1; j < c->hi; ++j) relocate(c->val(j), c->val(j - 1));
+            --c->hi;
+        }
+        --sz;
+        link *l;
+        size_t i;
+        rebalance(c, k, l, i);
+        return iterator(this, l, i);
+    }
+    void push_back(const T &value) { emplace(end(), value); }
+    void push_back(T &&value) { emplace(end(), std::move(value)); }
+    template<typename... Args>
+    T & emplace_back(Args &&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+    /**
+     * removes the last element
+     * throw when the container is empty.
+     */
+    void pop_back() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(iterator(this, head.prev, head.prev->hi - 1));
+    }
+    void push_front(const T &value) { emplace(begin(), value); }
+    void push_front(T &&value) { emplace(begin(), std::move(value)); }
+    template<typename... Args>
+    T & emplace_front(Args &&... args) { return *emplace(begin(), std::forward<Args>(args)...); }
+    /**
+     * removes the first element.
+     * throw when the container is empty.
+     */
+    void pop_front() {
+        if (sz == 0) throw container_is_empty(__func__);
+        erase(begin());
+    }
+    /**
+     * move all elements of other before pos, other becomes empty
+     * the chunk of pos is cut in two and the chunks of other are linked in whole
+     * throw invalid_iterator if pos does not belong to *this,
+     * runtime_error if the two lists draw from different arenas
+     */
+    void splice(iterator pos, unrolled_list &other) {
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        if (this == &other || other.sz == 0) return;
+        if (pool != other.pool) throw runtime_error(__func__);
+        link *at = cut(pos.ptr, pos.idx);
+        link *first = other.head.next, *last = other.head.prev;
+        first->prev = at->prev;
+        last->next = at;
+        at->prev->next = first;
+        at->prev = last;
+        sz += other.sz;
+        other.head.next = other.head.prev = &other.head;
+        other.sz = 0;
+    }
+    /**
+     * move the element at it from other before pos, other may be *this
+     * the element itself is moved out of its slot
+     */
+    void splice(iterator pos, unrolled_list &other, iterator it) {
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_UNROLLED_CHECK(it.owner != &other || it.ptr == nullptr || it.ptr == &other.head);
+        if (pool != other.pool) throw runtime_error(__func__);
+        iterator after = it;
+        if (pos == it || pos == ++after) return;
+        if (pos.ptr == it.ptr) {
+            // both in one chunk: rotate the slots between them
+            chunk *c = as_chunk(it.ptr);
+            T value(std::move(*c->val(it.idx)));
+            c->val(it.idx)->~T();
+            size_t to = pos.idx > it.idx ? pos.idx - 1 : pos.idx;
+            for (size_t k = it.idx; k < to; ++k) relocate(c->val(k + 1), c->val(k));
+            for (size_t k = it.idx; k > to; --k) relocate(c->val(k - 1), c->val(k));
+            new (c->val(to)) T(std::move(value));
+            return;
+        }
+        // emplace moves no element outside the chunk of pos, so it stays valid
+        emplace(pos, std::move(*it));
+        other.erase(it);
+    }
+    /**
+     * move the elements in [first, last) from other before pos, other may be *this
+     * (then pos shall not be inside the range)
+     * the chunks are cut at last, first and pos and the whole chunks in between are relinked:
+     * O(ChunkSize) element moves and, unless other is *this, O(distance / ChunkSize) to count them
+     */
+    void splice(iterator pos, unrolled_list &other, iterator first, iterator last) {
+        SJTU_UNROLLED_CHECK(pos.owner != this || pos.ptr == nullptr);
+        SJTU_UNROLLED_CHECK(first.owner != &other || last.owner != &other || first.ptr == nullptr || last.ptr == nullptr);
+        if (pool != other.pool) throw runtime_error(__func__);
+        if (first == last || pos == first || pos == last) return;
+        if (this != &other) {
+            for (const link *cur = first.ptr; cur != last.ptr; cur = cur->next) SJTU_UNROLLED_CHECK(cur == &other.head);
+            SJTU_UNROLLED_CHECK(first.ptr == last.ptr && first.idx > last.idx);
+        }
+        size_t lo = last.ptr->lo;
+        link *end = other.cut(last.ptr, last.idx);
+        follow_cut(first.ptr, first.idx, end, lo, last.idx);
+        follow_cut(pos.ptr, pos.idx, end, lo, last.idx);
+        lo = first.ptr->lo;
+        link *begin = other.cut(first.ptr, first.idx);
+        follow_cut(pos.ptr, pos.idx, begin, lo, first.idx);
+        // pos may lie in the chunk of last, so the range ends at tail rather than before end from now on
+        link *tail = end->prev, *at = cut(pos.ptr, pos.idx);
+        size_t n = 0;
+        if (this != &other)
+            for (link *cur = begin; cur != tail->next; cur = cur->next) n += as_chunk(cur)->count();
+        begin->prev->next = tail->next;
+        tail->next->prev = begin->prev;
+        other.sz -= n;
+        begin->prev = at->prev;
+        tail->next = at;
+        at->prev->next = begin;
+        at->prev = tail;
+        sz += n;
+    }
+    /**
+     * sort the values in ascending order with operator< of T
+     */
+    void sort() { sort(less()); }
+    /**
+     * sort the values in ascending order with cmp(a, b) meaning a goes before b
+     * stable: the addresses of the elements are merge sorted, then every element is moved once
+     * into fresh full chunks, at the cost of O(n) extra memory.
+     * if cmp throws, the list is left as it was.
+     */
+    template<typename Compare>
+    void sort(Compare cmp) { sort_by_address(cmp, parallel_policy(1)); }
+    /**
+     * sort() with the addresses sorted on the threads of policy (see sjtu::parallel_stable_sort)
+     */
+    void parallel_sort(parallel_policy policy = parallel_policy()) { parallel_sort(less(), policy); }
+    template<typename Compare>
+    void parallel_sort(Compare cmp, parallel_policy policy = parallel_policy()) { sort_by_address(cmp, policy); }
+    /**
+     * merge two sorted lists into one (both in ascending order)
+     * compare with operator< of T
+     * container other becomes empty after the operation
+     * for equivalent elements in the two lists, the elements from *this shall always precede the elements from other
+     * the order of equivalent elements of *this and other does not change.
+     * throw runtime_error if the two lists draw from different arenas
+     */
+    void merge(unrolled_list &other) { merge(other, less()); }
+    /**
+     * same as merge(other), both lists being sorted by cmp.
+     * every element is moved once into fresh full chunks; if cmp throws, the rest of *this
+     * and then the rest of other are moved unmerged, and other is still left empty.
+     */
+    template<typename Compare>
+    void merge(unrolled_list &other, Compare cmp) {
+        if (this == &other || other.sz == 0) return;
+        if (pool != other.pool) throw runtime_error(__func__);
+        T **a = new T*[sz + other.sz];
+        link *x = head.next, *y = other.head.next;
+        size_t i = x->lo, j = y->lo, idx = 0;
+        auto take = [&a, &idx](link *&l, size_t &k) {
+            a[idx++] = as_chunk(l)->val(k);
+            if (++k == l->hi) l = l->next, k = l->lo;
+        };
+        try {
+            while (x != &head && y != &other.head) {
+                if (cmp(*as_chunk(y)->val(j), *as_chunk(x)->val(i))) take(y, j);
+                else take(x, i);
+            }
+        } catch (...) {
+            while (x != &head) take(x, i);
+            while (y != &other.head) take(y, j);
+            merge_rebuild(other, a);
+            throw;
+        }
+        while (x != &head) take(x, i);
+        while (y != &other.head) take(y, j);
+        merge_rebuild(other, a);
+    }
+protected:
+    /**
+     * link the chunks of other behind those of *this, other becomes empty,
+     * then move every element into place in the order of a
+     */
+    void merge_rebuild(unrolled_list &other, T **a) {
+        link *first = other.head.next, *last = other.head.prev;
+        first->prev = head.prev;
+        last->next = &head;
+        head.prev->next = first;
+        head.prev = last;
+        sz += other.sz;
+        other.head.next = other.head.prev = &other.head;
+        other.sz = 0;
+        try {
+            rebuild(a);
+        } catch (...) {
+            delete [] a;
+            throw;
+        }
+        delete [] a;
+    }
+public:
+    /**
+     * reverse the order of the elements: the chunks are relinked backwards
+     * and the elements inside each window are swapped end for end
+     */
+    void reverse() {
+        if (sz <= 1) return;
+        link *cur = &head;
+        do {
+            link *tmp = cur->next;
+            cur->next = cur->prev;
+            cur->prev = tmp;
+            if (cur != &head) {
+                chunk *c = as_chunk(cur);
+                using std::swap;
+                for (size_t i = c->lo, j = c->hi - 1; i < j; ++i, --j) swap(*c->val(i), *c->val(j));
+            }
+            cur = tmp;
+        } while (cur != &head);
+    }
+    /**
+     * remove all consecutive duplicate elements from the container
+     * only the first element in each group of equal elements is left
+     * use operator== of T to compare the elements.
+     */
+    void unique() { unique(equal_to()); }
+    /**
+     * same as unique(), an element is removed when pred(first of its group, element) holds
+     */
+    template<typename BinaryPredicate>
+    void unique(BinaryPredicate pred) {
+        if (sz <= 1) return;
+        sweep([&pred](const T *kept, const T &x) { return kept && pred(*kept, x); });
+    }
+    /**
+     * remove every element equal to value (operator== of T) in one pass
+     * value may refer to an element of the list itself, it is then compared against a copy
+     * return the number of removed elements
+     */
+    size_t remove(const T &value) {
+        std::less<const T *> before;
+        for (const link *l = head.next; l != &head; l = l->next) {
+            if (!before(&value, as_chunk(l)->val(l->lo)) && before(&value, as_chunk(l)->val(l->hi))) {
+                T copy(value);
+                return remove(copy);
+            }
+        }
+        return sweep([&value](const T *, const T &x) { return x == value; });
+    }
+    /**
+     * remove every element for which pred holds in one pass
+     * return the number of removed elements
+     */
+    template<typename Predicate>
+    size_t remove_if(Predicate pred) {
+        return sweep([&pred](const T *, const T &x) { return pred(x); });
+    }
+};
+
+}
+
+#undef SJTU_UNROLLED_CHECK
+
+#endif //SJTU_UNROLLED_LIST_HPP
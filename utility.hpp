@@ -1,27 +1,73 @@
 #ifndef SJTU_UTILITY_HPP
 #define SJTU_UTILITY_HPP
 
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace sjtu {
 
+    /**
+     * copy, move and assignment stay defaulted, so pair<T1, T2> is trivially copyable
+     * whenever T1 and T2 are, and arrays of such pairs can be copied with memcpy.
+     * every other constructor forwards its arguments: nothing is copied that could be moved.
+     */
     template<class T1, class T2>
     class pair {
+        template<class Tuple1, class Tuple2, std::size_t... I1, std::size_t... I2>
+        pair(Tuple1 &args1, Tuple2 &args2, std::index_sequence<I1...>, std::index_sequence<I2...>)
+            : first(std::forward<std::tuple_element_t<I1, Tuple1>>(std::get<I1>(args1))...),
+              second(std::forward<std::tuple_element_t<I2, Tuple2>>(std::get<I2>(args2))...) {}
     public:
         T1 first;
         T2 second;
         constexpr pair() : first(), second() {}
         pair(const pair &other) = default;
         pair(pair &&other) = default;
+        pair &operator=(const pair &other) = default;
+        pair &operator=(pair &&other) = default;
         pair(const T1 &x, const T2 &y) : first(x), second(y) {}
-        template<class U1, class U2>
-        pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+        template<class U1, class U2, class = typename std::enable_if<
+            std::is_constructible<T1, U1 &&>::value && std::is_constructible<T2, U2 &&>::value>::type>
+        pair(U1 &&x, U2 &&y) : first(std::forward<U1>(x)), second(std::forward<U2>(y)) {}
         template<class U1, class U2>
         pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
         template<class U1, class U2>
-        pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+        pair(pair<U1, U2> &&other) : first(std::move(other.first)), second(std::move(other.second)) {}
+        /**
+         * build first from the elements of args1 and second from those of args2, in place
+         */
+        template<class... Args1, class... Args2>
+        pair(std::piecewise_construct_t, std::tuple<Args1...> args1, std::tuple<Args2...> args2)
+            : pair(args1, args2, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
+
+        template<class U1, class U2>
+        pair &operator=(const pair<U1, U2> &other) {
+            first = other.first;
+            second = other.second;
+            return *this;
+        }
+        template<class U1, class U2>
+        pair &operator=(pair<U1, U2> &&other) {
+            first = std::move(other.first);
+            second = std::move(other.second);
+            return *this;
+        }
+
+        void swap(pair &other) noexcept(noexcept(std::swap(std::declval<T1 &>(), std::declval<T1 &>()))
+                                        && noexcept(std::swap(std::declval<T2 &>(), std::declval<T2 &>()))) {
+            using std::swap;
+            swap(first, other.first);
+            swap(second, other.second);
+        }
     };
 
+    template<class T1, class T2>
+    void swap(pair<T1, T2> &x, pair<T1, T2> &y) noexcept(noexcept(x.swap(y))) {
+        x.swap(y);
+    }
+
 }
 
 #endif